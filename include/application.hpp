@@ -2,11 +2,19 @@
 #define _APPLICATION_HPP_
 
 #include "cosmac_vip.hpp"
+#include "audio_stream.hpp"
 #include "renderer.hpp"
 #include "gui.hpp"
+#include "capture.hpp"
+#include "wave_writer.hpp"
+#include "frame_timer.hpp"
+#include "trace.hpp"
+#include "settings.hpp"
 #include <fmt/core.h>
 #include <memory>
+#include <array>
 #include <map>
+#include <string>
 #include <SDL.h>
 
 namespace VIPR_Emulator
@@ -47,6 +55,17 @@ namespace VIPR_Emulator
 		uint16_t modifiers;
 	};
 
+	struct LaunchArguments // Which settings were given on the command line; only those stop the application from starting when they can't be used, while ones from the settings file fall back to the menus
+	{
+		bool rom_file;
+		bool ram_file;
+		bool autostart;
+	};
+
+	bool ParseLaunchArguments(int argc, char *argv[], Settings &LaunchSettings, LaunchArguments &Arguments); // Overrides whatever LaunchSettings already holds (e.g. from the settings file)
+
+	constexpr uint16_t debugger_memory_lines = 8; // Rows of 16 bytes shown by the debugger's memory view
+
 	class Application;
 
 	using KeyCallback = void (*)(Application *, SDL_Scancode, uint16_t);
@@ -54,7 +73,7 @@ namespace VIPR_Emulator
 	class Application
 	{
 		public:
-			Application();
+			Application(const Settings &LaunchSettings, const LaunchArguments &Arguments, SettingsStore &Store); // Changes made in the menus are saved to Store, which must outlive the application
 			~Application();
 			void RunMainLoop();
 
@@ -96,11 +115,18 @@ namespace VIPR_Emulator
 			friend void machine_memory_transfer_start_address_input_complete(GUI::Value &obj, void *userdata);
 			friend void machine_memory_transfer_size_input_complete(GUI::Value &obj, void *userdata);
 
+			friend void machine_debugger_left(GUI::Menu &obj, void *userdata);
+			friend void machine_debugger_right(GUI::Menu &obj, void *userdata);
+			friend void machine_debugger_activate(GUI::Menu &obj, void *userdata);
+			friend void machine_debugger_memory_address_input_complete(GUI::Value &obj, void *userdata);
+
 			friend void emulator_options_up(GUI::Menu &obj, void *userdata);
 			friend void emulator_options_down(GUI::Menu &obj, void *userdata);
 			friend void emulator_options_left(GUI::Menu &obj, void *userdata);
 			friend void emulator_options_right(GUI::Menu &obj, void *userdata);
 			friend void emulator_options_activate(GUI::Menu &obj, void *userdata);
+
+			friend void application_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata);
 		private:
 			Window MainWindow;
 			Renderer MainRenderer;
@@ -110,17 +136,47 @@ namespace VIPR_Emulator
 			std::map<HexKey, SDL_Scancode> Hex_KeyMap;
 			std::map<HexKey, SDL_Scancode> Hex_KeyMap_2;
 			std::multimap<char, ScancodeModData> Printable_KeyMap;
+			VideoRecorder Recorder;
+			WaveWriter AudioDump;
+			std::unique_ptr<InstructionTrace> CPUTrace; // Only allocated while instructions are being traced
+			AudioStream OutputStream;
+			AudioEngine SoundEngine;
 			COSMAC_VIP System;
-			GUI::Menu MainMenu, MachineOptionsMenu, ExpansionBoardOptionsMenu, MachineMemoryTransferMenu, EmulatorOptionsMenu;
+			SettingsStore &Store;
+			Debugger Debug;
+			GUI::Menu MainMenu, MachineOptionsMenu, ExpansionBoardOptionsMenu, MachineMemoryTransferMenu, MachineDebuggerMenu, EmulatorOptionsMenu;
 			GUI::Menu *CurrentMenu;
+			GUI::MenuCache MenuRenderCache;
 			GUI::ElementData *InputFocus;
+			FrameTimer DisplayTimer;
+			bool audio_stats_overlay;
+			bool speed_overlay;
+			uint32_t overlay_refresh_ticks;
+			uint64_t overlay_machine_cycles;
+			bool audio_devices_listed; // Devices are only listed once they're needed, as listing them can be slow
+			std::chrono::steady_clock::time_point overlay_tp;
+			std::string overlay_text;
 			bool exit;
 			bool fail;
 			int retcode;
 			const VersionData version = { 0, 2 };
 
 			void SetOperationMode(OperationMode mode);
+			void SetupAudio();
+			void RefreshAudioDevices(bool output_device_removed);
+			void ToggleCapture();
+			void ToggleAudioDump();
+			void ToggleInstructionTrace();
+			void ToggleAudioStatsOverlay();
+			void ToggleSpeedOverlay();
+			void UpdateOverlay();
+			void DumpAudioStats();
+			void WriteTrace();
+			void ShowDebugger();
+			void RefreshDebuggerMenu();
 			void ConstructMenus();
+			bool ApplySettings(const Settings &LaunchSettings, const LaunchArguments &Arguments);
+			void AdjustRAM(uint8_t ram_kb); // Resizes the machine's RAM, reporting a RAM file that had to be detached in the Memory Transfer menu
 	};
 
 	consteval uint32_t GetDefaultWindowFlags()
@@ -133,6 +189,8 @@ namespace VIPR_Emulator
 		return flags;
 	}
 
+	void application_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata);
+
 	void menu_key_down(Application *app, SDL_Scancode scancode, uint16_t modifiers);
 	void menu_key_up(Application *app, SDL_Scancode scancode, uint16_t modifiers);
 
@@ -171,6 +229,13 @@ namespace VIPR_Emulator
 	void machine_memory_transfer_start_address_input_complete(GUI::Value &obj, void *userdata);
 	void machine_memory_transfer_size_input_complete(GUI::Value &obj, void *userdata);
 
+	void machine_debugger_up(GUI::Menu &obj, void *userdata);
+	void machine_debugger_down(GUI::Menu &obj, void *userdata);
+	void machine_debugger_left(GUI::Menu &obj, void *userdata);
+	void machine_debugger_right(GUI::Menu &obj, void *userdata);
+	void machine_debugger_activate(GUI::Menu &obj, void *userdata);
+	void machine_debugger_memory_address_input_complete(GUI::Value &obj, void *userdata);
+
 	void emulator_options_up(GUI::Menu &obj, void *userdata);
 	void emulator_options_down(GUI::Menu &obj, void *userdata);
 	void emulator_options_left(GUI::Menu &obj, void *userdata);
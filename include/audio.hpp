@@ -2,11 +2,41 @@
 #define _AUDIO_HPP_
 
 #include <cstdint>
+#include <cstddef>
 #include <array>
 
 namespace VIPR_Emulator
 {
 	using AudioFrame = std::array<int, 4096>;
+
+	using AudioOutputCallback = void (*)(const int *samples, size_t sample_count, int sample_rate, void *userdata);
+
+	constexpr int audio_sample_rate = 48000;
+	constexpr uint16_t audio_latency_min = 2; // In milliseconds
+	constexpr uint16_t audio_latency_max = 250;
+	constexpr uint16_t audio_latency_default = 40;
+
+	inline int32_t GetAudioAmplitude(uint8_t volume) // Square wave amplitude in 16-bit sample units for a 0-100 volume
+	{
+		return (static_cast<int32_t>(volume) * 13107) / 100;
+	}
+
+	enum class AudioEventType : uint8_t
+	{
+		Tone, // Value is the Q line state
+		DivideRate, // Value is the CDP1863's divide rate latch
+		Volume, // Value is the volume from 0-100
+		Level, // Value is a 4-bit amplitude latch
+		Octave // Value is a VP-550 octave latch
+	};
+
+	struct AudioEvent
+	{
+		uint64_t machine_cycle;
+		AudioEventType type;
+		uint8_t value;
+		uint8_t channel; // Only used by sources with more than one voice
+	};
 }
 
 #endif
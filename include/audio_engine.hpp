@@ -0,0 +1,53 @@
+#ifndef _AUDIO_ENGINE_HPP_
+#define _AUDIO_ENGINE_HPP_
+
+#include "audio.hpp"
+#include "blep_synth.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace VIPR_Emulator
+{
+	class AudioSource // A sound generator that adds its level changes for each frame onto the engine's mixer bus
+	{
+		public:
+			virtual ~AudioSource() = default;
+			virtual void Render(BandLimitedSynth &synth, uint64_t frame_start_cycle, uint64_t frame_end_cycle) = 0; // Cycles are machine cycles
+			virtual void Silence(BandLimitedSynth &synth) = 0; // Returns the source's level to zero at the start of the next frame before it's detached
+			virtual void SetVolume(uint8_t volume, uint64_t machine_cycle) = 0; // The source's own volume from 0-100, mixed in before the main volume
+	};
+
+	class AudioEngine // Sums every attached source on one band-limited bus and hands the result to a single audio tap; the engine owns no device, so any number of them can run side by side
+	{
+		public:
+			AudioEngine();
+			~AudioEngine();
+
+			void SetClockFrequency(uint32_t clock_frequency);
+			void AttachSource(AudioSource *source);
+			void DetachSource(AudioSource *source);
+			void Render(uint64_t machine_cycle_count);
+
+			inline void SetVolume(uint8_t volume) // Main volume, applied after mixing
+			{
+				gain = (static_cast<int32_t>(volume) * 65536) / 100;
+			}
+
+			inline void SetAudioOutput(AudioOutputCallback audio_output_func, void *audio_output_userdata) // Called on the emulation thread with every block of mixed samples, e.g. to feed an output device or a file
+			{
+				this->audio_output_func = audio_output_func;
+				this->audio_output_userdata = audio_output_userdata;
+			}
+		private:
+			BandLimitedSynth Mixer;
+			std::vector<AudioSource *> Sources;
+			uint64_t rendered_machine_cycle;
+			bool clock_synced;
+			int32_t gain;
+			AudioFrame sample_buffer;
+			AudioOutputCallback audio_output_func;
+			void *audio_output_userdata;
+	};
+}
+
+#endif
@@ -0,0 +1,108 @@
+#ifndef _AUDIO_STREAM_HPP_
+#define _AUDIO_STREAM_HPP_
+
+#include "audio.hpp"
+#include "spsc_queue.hpp"
+#include <cstdint>
+#include <string>
+#include <array>
+#include <atomic>
+#include <SDL.h>
+
+namespace VIPR_Emulator
+{
+	struct AudioStats // A snapshot of the output stream, safe to take from the main thread while the device plays
+	{
+		static constexpr size_t histogram_buckets = 16; // Bucket 0 counts times under 1 us, bucket n times from 2^(n-1) us up to 2^n us, and the last bucket everything longer
+
+		using Histogram = std::array<uint64_t, histogram_buckets>;
+
+		double queued_ms; // Samples waiting in the ring
+		double target_ms; // What the ring refills to after an underrun
+		double device_ms; // One device buffer
+		double resample_ratio; // Samples the device consumed per sample the emulation produced since the previous snapshot, so 1.0 means the two clocks agree
+		uint64_t underruns;
+		uint64_t overruns;
+		uint64_t callbacks;
+		Histogram callback_duration; // Time spent inside the callback
+		Histogram callback_interval; // Time between the starts of consecutive callbacks
+
+		static uint64_t GetPercentile(const Histogram &histogram, double fraction); // Upper bound of the bucket holding the percentile, in microseconds
+	};
+
+	std::string FormatAudioStats(const AudioStats &stats); // JSON
+
+	class AudioStream // Output device in SDL's pull model; the emulation thread writes samples into a lock-free ring that the audio callback drains
+	{
+		public:
+			static constexpr size_t fade_samples = 240; // 5 ms
+
+			AudioStream();
+			~AudioStream();
+
+			bool Open(const std::string &output_audio_device, uint16_t latency); // Switches devices in place if one is already open, keeping whatever is still queued in the ring
+			void Close();
+			size_t Write(const int *samples, size_t sample_count);
+
+			inline void Pause(bool toggle)
+			{
+				pause = toggle;
+			}
+
+			inline bool IsOpen() const
+			{
+				return device != 0;
+			}
+
+			inline SDL_AudioDeviceID GetDeviceID() const
+			{
+				return device;
+			}
+
+			inline uint64_t GetUnderruns() const
+			{
+				return underruns;
+			}
+
+			inline uint64_t GetOverruns() const
+			{
+				return overruns;
+			}
+
+			inline double GetQueuedMilliseconds() const
+			{
+				return SampleRing.Size() / (audio_sample_rate / 1000.0);
+			}
+
+			AudioStats GetStats(); // Not const, since the resample ratio is measured from the previous call
+
+			static void AudioCallback(void *userdata, Uint8 *stream, int len);
+		private:
+			SDL_AudioDeviceID device;
+			SDL_AudioSpec spec;
+			std::atomic<bool> pause;
+			std::atomic<bool> fade_out_request;
+			std::atomic<bool> fade_out_complete;
+			bool buffering; // Only touched by the audio callback
+			size_t fade_in_position; // Only touched by the audio callback
+			size_t fade_out_position; // Only touched by the audio callback
+			size_t target_fill;
+			size_t max_fill;
+			std::atomic<uint64_t> underruns;
+			std::atomic<uint64_t> overruns;
+			std::atomic<uint64_t> samples_written; // Offered to Write, including anything dropped
+			std::atomic<uint64_t> samples_requested; // Asked for by the device while not paused
+			std::atomic<uint64_t> callbacks;
+			std::array<std::atomic<uint64_t>, AudioStats::histogram_buckets> callback_duration;
+			std::array<std::atomic<uint64_t>, AudioStats::histogram_buckets> callback_interval;
+			Uint64 last_callback_counter; // Only touched by the audio callback
+			uint64_t last_samples_written; // Only touched by GetStats
+			uint64_t last_samples_requested; // Only touched by GetStats
+			SPSCRingBuffer<int, 65536> SampleRing;
+
+			void CloseDevice();
+			static void AddToHistogram(std::array<std::atomic<uint64_t>, AudioStats::histogram_buckets> &histogram, Uint64 counter_ticks);
+	};
+}
+
+#endif
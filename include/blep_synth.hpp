@@ -0,0 +1,66 @@
+#ifndef _BLEP_SYNTH_HPP_
+#define _BLEP_SYNTH_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <vector>
+
+namespace VIPR_Emulator
+{
+	class BandLimitedSynth // Band-limited step (BLEP) synthesis; level changes are added as windowed-sinc impulses and integrated into samples, all in integer math so output is bit-reproducible
+	{
+		public:
+			static constexpr size_t kernel_phases = 32;
+			static constexpr size_t kernel_width = 16;
+
+			BandLimitedSynth(uint32_t clock_frequency, uint32_t sample_rate);
+			~BandLimitedSynth();
+
+			void AddDelta(uint32_t clock_time, int32_t delta); // Clock time is relative to the start of the current frame
+			void EndFrame(uint32_t clocks);
+			size_t ReadSamples(int *output, size_t sample_count, int32_t gain = 65536); // Gain is in 1/65536ths
+			void Clear();
+
+			inline size_t GetSamplesAvailable() const
+			{
+				return samples_available;
+			}
+		private:
+			uint64_t clock_frequency;
+			uint64_t sample_rate;
+			uint64_t frame_remainder; // Position of the frame start within the current sample, in 1/clock_frequency units
+			size_t samples_available;
+			int64_t integrator;
+			std::vector<int64_t> delta_buffer;
+	};
+
+	class SquareWaveOscillator // Free-running square wave whose gate and amplitude changes are fed into a BandLimitedSynth
+	{
+		public:
+			SquareWaveOscillator(uint64_t half_period, int32_t amplitude);
+			~SquareWaveOscillator();
+
+			void Run(BandLimitedSynth &synth, uint64_t time); // Times are in 1/65536ths of a clock, relative to the start of the current frame
+			void SetGate(BandLimitedSynth &synth, uint64_t time, bool gate);
+			void SetAmplitude(BandLimitedSynth &synth, uint64_t time, int32_t amplitude);
+			void SetHalfPeriod(BandLimitedSynth &synth, uint64_t time, uint64_t half_period);
+			void EndFrame(uint64_t frame_time);
+
+			inline int32_t GetLevel() const
+			{
+				return level;
+			}
+		private:
+			uint64_t half_period;
+			uint64_t next_toggle;
+			bool high;
+			bool gate;
+			int32_t amplitude;
+			int32_t level;
+
+			void UpdateLevel(BandLimitedSynth &synth, uint64_t time);
+	};
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef _CAPTURE_HPP_
+#define _CAPTURE_HPP_
+
+#include "video_frame.hpp"
+#include "spsc_queue.hpp"
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <vector>
+#include <string>
+#include <thread>
+#include <fstream>
+
+namespace VIPR_Emulator
+{
+	/*
+	VIPR Capture File (.vcap), all values are little endian
+
+	Header:
+		char magic[8] = "VIPRCAP1"
+		uint32_t frame_rate_numerator (CPU clock frequency in Hz)
+		uint32_t frame_rate_denominator (Clocks per frame)
+		uint16_t width, height (In pixels)
+
+	Chunks:
+		uint8_t type
+		uint32_t payload_size
+		uint8_t payload[payload_size]
+
+	Frame Chunk ('F'):
+		uint64_t frame_number
+		uint8_t pixel_data[1024] (1bpp, 8 bytes per line)
+		uint16_t color_delta_count (0xFFFF = Full color data follows)
+		(uint16_t offset, uint8_t color)[color_delta_count] or uint8_t color_data[1024]
+
+	Audio Chunk ('A'):
+		uint32_t sample_rate
+		uint32_t sample_count
+		int16_t samples[sample_count] (Mono)
+	*/
+
+	constexpr std::array<char, 8> capture_magic = { 'V', 'I', 'P', 'R', 'C', 'A', 'P', '1' };
+	constexpr uint8_t capture_chunk_frame = 'F';
+	constexpr uint8_t capture_chunk_audio = 'A';
+	constexpr uint16_t capture_full_color_data = 0xFFFF;
+
+	struct CaptureAudioBlock
+	{
+		std::array<int16_t, 4096> samples;
+		uint32_t sample_count;
+		uint32_t sample_rate;
+	};
+
+	class VideoRecorder // Frames and audio are queued by the emulation thread, then encoded and written by a background thread
+	{
+		public:
+			VideoRecorder();
+			~VideoRecorder();
+
+			bool Start(const std::string &capture_file, uint32_t frame_rate_numerator, uint32_t frame_rate_denominator);
+			void Stop();
+
+			void SubmitFrame(const VideoFrame &frame);
+			void SubmitAudio(const int *samples, size_t sample_count, int sample_rate);
+
+			inline void SetBlockWhenFull(bool toggle) // Only for offline runs (e.g. headless mode), where waiting on the writer is preferable to dropping frames
+			{
+				block_when_full = toggle;
+			}
+
+			inline bool IsRecording() const
+			{
+				return recording;
+			}
+
+			inline uint64_t GetDroppedFrames() const
+			{
+				return dropped_frames;
+			}
+
+			inline uint64_t GetDroppedAudioBlocks() const
+			{
+				return dropped_audio_blocks;
+			}
+
+			static void WriterProcessor(VideoRecorder *recorder);
+		private:
+			std::atomic<bool> recording;
+			std::atomic<bool> processing;
+			bool block_when_full;
+			std::atomic<uint64_t> dropped_frames;
+			std::atomic<uint64_t> dropped_audio_blocks;
+			std::ofstream capture_output;
+			std::array<uint8_t, (64 * 128) / 8> previous_color_data;
+			bool color_data_valid;
+			std::vector<uint8_t> chunk_buffer;
+			SPSCQueue<VideoFrame, 64> FrameQueue;
+			SPSCQueue<CaptureAudioBlock, 64> AudioQueue;
+			std::thread WriterThread;
+
+			bool WritePendingData();
+			void WriteFrame(const VideoFrame &frame);
+			void WriteAudio(const CaptureAudioBlock &block);
+	};
+
+	void VideoRecorder_frame_output(const VideoFrame &frame, void *userdata);
+	void VideoRecorder_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata);
+}
+
+#endif
@@ -1,6 +1,9 @@
 #ifndef _CDP1802_HPP_
 #define _CDP1802_HPP_
 
+#include "cpu_profiler.hpp"
+#include "instruction_trace.hpp"
+#include "debugger.hpp"
 #include <cstdint>
 #include <chrono>
 #include <array>
@@ -18,6 +21,7 @@ namespace VIPR_Emulator
 
 	using QOutputCallback = void (*)(uint8_t Q, void *userdata);
 	using SyncCallback = void (*)(void *userdata);
+	using SyncSkipCallback = uint32_t (*)(uint32_t machine_cycles, uint32_t cycles_per_step, void *userdata); // Skips as many whole steps of machine cycles as can pass without a sync doing anything, up to machine_cycles, and returns how many were skipped
 
 	enum class DMAType
 	{
@@ -38,6 +42,18 @@ namespace VIPR_Emulator
 		DMACallback func;
 	};
 
+	struct CPURegisters
+	{
+		std::array<uint16_t, 16> R;
+		uint8_t D;
+		uint8_t DF;
+		uint8_t P;
+		uint8_t X;
+		uint8_t T;
+		uint8_t IE;
+		uint8_t Q;
+	};
+
 	class CDP1802
 	{
 		public:
@@ -55,7 +71,7 @@ namespace VIPR_Emulator
 				DMA,
 				Interrupt
 			};
-			CDP1802(double cycle_frequency, MemoryReadCallback memory_read_func, MemoryWriteCallback memory_write_func, InputCallback in_func, OutputCallback out_func, QOutputCallback qout_func, SyncCallback sync_func, void *userdata);
+			CDP1802(double cycle_frequency, MemoryReadCallback memory_read_func, MemoryWriteCallback memory_write_func, InputCallback in_func, OutputCallback out_func, QOutputCallback qout_func, SyncCallback sync_func, SyncSkipCallback sync_skip_func, void *userdata);
 			~CDP1802();
 			void Initialize();
 
@@ -72,6 +88,59 @@ namespace VIPR_Emulator
 			void SetControlMode(ControlMode mode, std::chrono::high_resolution_clock::time_point current_tp);
 			ControlMode GetControlMode() const;
 
+			inline uint64_t GetMachineCycleCount() const
+			{
+				return machine_cycle_count;
+			}
+
+			inline uint8_t GetQ() const
+			{
+				return Q;
+			}
+
+			inline void SetProfiler(CPUProfiler *Profiler) // Runs the instrumented build of the core while set; without a profiler or trace the core has no instrumentation code at all
+			{
+				this->Profiler = Profiler;
+			}
+
+			inline void SetInstructionTrace(InstructionTrace *Trace) // Also runs the instrumented build of the core while set
+			{
+				this->Trace = Trace;
+			}
+
+			inline void SetDebugger(Debugger *Debug) // Runs the instrumented build of the core while the debugger has breakpoints or a pending stop
+			{
+				this->Debug = Debug;
+			}
+
+			inline void SetMemoryCallbacks(MemoryReadCallback memory_read_func, MemoryWriteCallback memory_write_func)
+			{
+				this->memory_read_func = memory_read_func;
+				this->memory_write_func = memory_write_func;
+			}
+
+			inline CycleState GetCycleState() const
+			{
+				return CurrentCycleState;
+			}
+
+			inline CPURegisters GetRegisters() const
+			{
+				return CPURegisters { R, D, DF, P, X, T, IE, Q };
+			}
+
+			inline void SetRegisters(const CPURegisters &Registers) // For debuggers; only call between instructions
+			{
+				R = Registers.R;
+				D = Registers.D;
+				DF = Registers.DF & 0x1;
+				P = Registers.P & 0xF;
+				X = Registers.X & 0xF;
+				T = Registers.T;
+				IE = Registers.IE & 0x1;
+				SetQ(Registers.Q & 0x1);
+			}
+
 			inline bool *GetEFPtr(uint8_t index)
 			{
 				return (index < EF.size()) ? &EF[index] : nullptr;
@@ -104,12 +173,14 @@ namespace VIPR_Emulator
 			}
 			
 			void operator()(std::chrono::high_resolution_clock::time_point current_tp);
+			void RunClocks(uint32_t clocks); // Runs a fixed number of clock pulses regardless of host time (used for headless runs).
 		private:
 			ControlMode CurrentControlMode;
 			CycleState CurrentCycleState;
 			DMARequest CurrentDMAInRequest, CurrentDMAOutRequest;
 			double cycle_frequency;
 			uint32_t current_clock;
+			uint64_t machine_cycle_count;
 			uint32_t execute_cycles_left;
 			bool initialization;
 			bool idle;
@@ -141,6 +212,60 @@ namespace VIPR_Emulator
 			OutputCallback out_func;
 			QOutputCallback qout_func;
 			SyncCallback sync_func;
+			SyncSkipCallback sync_skip_func;
+			CPUProfiler *Profiler;
+			InstructionTrace *Trace;
+			Debugger *Debug;
+
+			template <bool instrumented>
+			void Clock();
+
+			template <bool instrumented>
+			void RunClocksInternal(uint32_t clocks);
+
+			uint32_t SkipIdleCycles(uint32_t machine_cycles); // Only called at the start of a machine cycle
+
+			inline bool IsShortBranchTaken(uint8_t N) const // For 0x30-0x3F, other than SKP
+			{
+				switch (N)
+				{
+					case 0x0:
+					{
+						return true;
+					}
+					case 0x1:
+					case 0x9:
+					{
+						return (Q == 1) == (N == 0x1);
+					}
+					case 0x2:
+					case 0xA:
+					{
+						return (D == 0) == (N == 0x2);
+					}
+					case 0x3:
+					case 0xB:
+					{
+						return (DF == 1) == (N == 0x3);
+					}
+					default:
+					{
+						return EF[N & 0x3] == (N < 0x8);
+					}
+				}
+			}
+
+			inline void SetQ(uint8_t value) // Q is only reported when it changes, so listeners can treat each call as an edge
+			{
+				if (Q != value)
+				{
+					Q = value;
+					if (qout_func != nullptr && userdata != nullptr)
+					{
+						qout_func(Q, userdata);
+					}
+				}
+			}
 	};
 }
 
@@ -2,8 +2,10 @@
 #define _CDP1861_HPP_
 
 #include "cdp1802.hpp"
-#include "renderer.hpp"
+#include "display_output.hpp"
+#include "trace.hpp"
 #include <cstdint>
+#include <algorithm>
 #include <array>
 #include <chrono>
 #include <cstring>
@@ -21,7 +23,7 @@ namespace VIPR_Emulator
 			CDP1861(CDP1802 *CPU, uint8_t EFX, VideoOutputCallback video_output_func, void *video_output_userdata);
 			~CDP1861();
 
-			inline void AttachDisplayRenderer(Renderer *DisplayRenderer)
+			inline void AttachDisplayRenderer(DisplayOutput *DisplayRenderer)
 			{
 				this->DisplayRenderer = DisplayRenderer;
 			}
@@ -83,6 +85,7 @@ namespace VIPR_Emulator
 				}
 				if (line_counter == 192 && machine_cycle_counter == 0 && DisplayRenderer != nullptr)
 				{
+					VIPR_TRACE_ZONE("CDP1861::Sync"); // Only the end of frame work; a zone on every machine cycle would cost more than the sync itself
 					DisplayRenderer->Render();
 				}
 				++machine_cycle_counter;
@@ -97,6 +100,44 @@ namespace VIPR_Emulator
 				}
 			}
 
+			inline uint32_t GetQuietCycles(uint32_t machine_cycles) const // How many of the next syncs (up to machine_cycles) would only count, so SkipCycles can pass over them
+			{
+				uint32_t quiet_cycles = 0;
+				uint16_t line = line_counter;
+				uint8_t machine_cycle = machine_cycle_counter;
+				while (quiet_cycles < machine_cycles) // Only the first and third machine cycle of a line can do anything
+				{
+					if (machine_cycle == 0)
+					{
+						bool flag = (line >= 60 && line <= 63) || (line >= 188 && line <= 191);
+						if ((display && (line == 62 || (EFX != nullptr && *EFX != flag))) || (line == 192 && DisplayRenderer != nullptr))
+						{
+							break;
+						}
+					}
+					else if (machine_cycle == 2 && display && line >= 64 && line <= 191)
+					{
+						break;
+					}
+					uint8_t next_machine_cycle = (machine_cycle < 2) ? 2 : 14;
+					quiet_cycles += next_machine_cycle - machine_cycle;
+					machine_cycle = next_machine_cycle;
+					if (machine_cycle == 14)
+					{
+						machine_cycle = 0;
+						line = (line + 1) % 262;
+					}
+				}
+				return std::min(quiet_cycles, machine_cycles);
+			}
+
+			inline void SkipCycles(uint32_t machine_cycles)
+			{
+				uint32_t cycles = machine_cycle_counter + machine_cycles;
+				machine_cycle_counter = cycles % 14;
+				line_counter = (line_counter + (cycles / 14)) % 262;
+			}
+
 			friend void CDP1861_DMA_out(uint8_t *data, void *userdata);
 		private:
 			CDP1802 *CPU;
@@ -109,7 +150,7 @@ namespace VIPR_Emulator
 			uint8_t machine_cycle_counter;
 			void *video_output_userdata;
 			VideoOutputCallback video_output_func;
-			Renderer *DisplayRenderer;
+			DisplayOutput *DisplayRenderer;
 	};
 }
 
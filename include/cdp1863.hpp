@@ -18,7 +18,7 @@ namespace VIPR_Emulator
 
 			inline void SetDivideRate(uint8_t value)
 			{
-				divide_rate = static_cast<double>(value) + 1.0;
+				divide_rate = static_cast<uint16_t>(value) + 1;
 			}
 
 			inline void Reset()
@@ -26,15 +26,35 @@ namespace VIPR_Emulator
 				SetDivideRate(53);
 			}
 
+			inline void SetInputClock(double input_frequency, InputClockType input_clock) // Used by boards that switch the CDP1863 between its two clock inputs
+			{
+				this->input_frequency = input_frequency;
+				this->input_clock = input_clock;
+			}
+
+			inline double GetInputFrequency() const
+			{
+				return input_frequency;
+			}
+
 			inline double GetOutputFrequency() const
 			{
-				double fixed_predivide = (input_clock == InputClockType::Clock1) ? 4.0 : 8.0;
-				return input_frequency / (fixed_predivide * 2.0) / divide_rate;
+				return input_frequency / (static_cast<double>(GetFixedPredivide()) * 2.0) / static_cast<double>(divide_rate);
+			}
+
+			inline uint32_t GetOutputHalfPeriod() const // In input clock cycles
+			{
+				return GetFixedPredivide() * divide_rate;
 			}
 		private:
 			InputClockType input_clock;
 			double input_frequency;
-			double divide_rate;
+			uint16_t divide_rate;
+
+			inline uint32_t GetFixedPredivide() const
+			{
+				return (input_clock == InputClockType::Clock1) ? 4 : 8;
+			}
 	};
 }
 
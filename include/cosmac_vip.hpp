@@ -3,14 +3,19 @@
 
 #include "cdp1802.hpp"
 #include "cdp1861.hpp"
+#include "audio_engine.hpp"
 #include "tone.hpp"
 #include "vp590.hpp"
 #include "vp595.hpp"
-#include "renderer.hpp"
+#include "vp550.hpp"
+#include "display_output.hpp"
+#include "video_frame.hpp"
+#include "mapped_file.hpp"
 #include <cstdint>
 #include <memory>
 #include <array>
 #include <vector>
+#include <span>
 #include <string>
 #include <chrono>
 #include <fmt/core.h>
@@ -28,7 +33,16 @@ namespace VIPR_Emulator
 	{
 		VP585_ExpansionKeypadInterface = 0, // Enables using two keypads; turns off VP590
 		VP590_ColorBoard = 1, // Adds color support and enables using two keypads; turns off VP585
-		VP595_SimpleSoundBoard = 2 // Adds support for a variable tone generator; replaces the base tone generator
+		VP595_SimpleSoundBoard = 2, // Adds support for a variable tone generator; takes over Q from the base tone generator
+		VP550_SuperSoundBoard = 3, // Adds two memory mapped tone generators gated by Q; takes over Q from the base tone generator and turns off VP551
+		VP551_SuperSoundBoard = 4 // Adds four memory mapped tone generators gated by Q; takes over Q from the base tone generator and turns off VP550
+	};
+
+	enum class SoundSourceType : uint8_t
+	{
+		ToneGenerator = 0,
+		VP595_SimpleSoundBoard = 1,
+		VP550_SuperSoundBoard = 2 // Also the VP-551
 	};
 
 	struct MemoryMapData
@@ -42,7 +56,12 @@ namespace VIPR_Emulator
 		void *custom_memory_write_userdata;
 	};
 
+	uint8_t VIP_memory_read(uint16_t address, void *userdata);
+	void VIP_memory_write(uint16_t address, uint8_t data, void *userdata);
 	void VIP_video_output(uint8_t value, uint8_t line, size_t address, void *userdata);
+	void VIP_color_video_output(uint8_t value, uint8_t line, size_t address, uint8_t background_color, uint8_t dot_color, void *userdata);
+	uint8_t VIP_debug_memory_read(uint16_t address, void *userdata);
+	void VIP_debug_memory_write(uint16_t address, uint8_t data, void *userdata);
 
 	class COSMAC_VIP
 	{
@@ -50,10 +69,114 @@ namespace VIPR_Emulator
 			COSMAC_VIP();
 			~COSMAC_VIP();
 			void SetRunSwitch(bool run);
+			bool AttachRAMFile(const std::string &ram_file); // RAM lives in the file from then on, so it persists across runs; a new or empty file starts out with the current RAM
+			void DetachRAMFile(); // Keeps the current contents in ordinary RAM
 
 			inline void RunMachine(std::chrono::high_resolution_clock::time_point current_tp)
 			{
 				CPU(current_tp);
+				RenderAudio();
+			}
+
+			inline void RunMachineClocks(uint32_t clocks)
+			{
+				CPU.RunClocks(clocks);
+				RenderAudio();
+			}
+
+			inline uint64_t GetMachineCycleCount() const
+			{
+				return CPU.GetMachineCycleCount();
+			}
+
+			inline void SetFrameOutput(FrameOutputCallback frame_output_func, void *frame_output_userdata)
+			{
+				this->frame_output_func = frame_output_func;
+				this->frame_output_userdata = frame_output_userdata;
+			}
+
+			inline const VideoFrame &GetLastFrame() const
+			{
+				return last_frame;
+			}
+
+			inline void AttachAudioEngine(AudioEngine *SoundEngine)
+			{
+				if (this->SoundEngine != nullptr)
+				{
+					this->SoundEngine->DetachSource(tone_generator.get());
+					if (simple_sound_board != nullptr)
+					{
+						this->SoundEngine->DetachSource(simple_sound_board.get());
+					}
+					if (super_sound_board != nullptr)
+					{
+						this->SoundEngine->DetachSource(super_sound_board.get());
+					}
+				}
+				this->SoundEngine = SoundEngine;
+				if (this->SoundEngine != nullptr)
+				{
+					this->SoundEngine->SetClockFrequency(static_cast<uint32_t>(CPU.GetCycleFrequency()));
+					this->SoundEngine->AttachSource(tone_generator.get());
+					if (simple_sound_board != nullptr)
+					{
+						this->SoundEngine->AttachSource(simple_sound_board.get());
+					}
+					if (super_sound_board != nullptr)
+					{
+						this->SoundEngine->AttachSource(super_sound_board.get());
+					}
+				}
+			}
+
+			inline void SetProfiler(CPUProfiler *Profiler)
+			{
+				CPU.SetProfiler(Profiler);
+			}
+
+			inline void SetInstructionTrace(InstructionTrace *Trace)
+			{
+				CPU.SetInstructionTrace(Trace);
+			}
+
+			inline void AttachDebugger(Debugger *Debug) // Call again after changing breakpoints; reads and writes only go through the checked bus while memory breakpoints exist
+			{
+				this->Debug = Debug;
+				CPU.SetDebugger(Debug);
+				if (Debug != nullptr && Debug->HasMemoryBreakpoints())
+				{
+					CPU.SetMemoryCallbacks(VIP_debug_memory_read, VIP_debug_memory_write);
+				}
+				else
+				{
+					CPU.SetMemoryCallbacks(VIP_memory_read, VIP_memory_write);
+				}
+			}
+
+			inline CPURegisters GetCPURegisters() const
+			{
+				return CPU.GetRegisters();
+			}
+
+			inline void SetCPURegisters(const CPURegisters &Registers)
+			{
+				CPU.SetRegisters(Registers);
+			}
+
+			inline uint8_t PeekMemory(uint16_t address) // Reads have no side effects, so this is what the CPU would see
+			{
+				return VIP_memory_read(address, this);
+			}
+
+			inline void PokeMemory(uint16_t address, uint8_t data) // Goes through the memory map like a CPU write, so ROM stays read-only and boards see the write
+			{
+				VIP_memory_write(address, data, this);
+			}
+
+			inline double GetClockFrequency() const
+			{
+				return CPU.GetCycleFrequency();
 			}
 
 			inline void InstallExpansionBoard(ExpansionBoardType board)
@@ -67,15 +190,40 @@ namespace VIPR_Emulator
 						case ExpansionBoardType::VP590_ColorBoard:
 						{
 							VDC = nullptr;
-							color_board = std::make_unique<VP590>(&CPU);
+							color_board = std::make_unique<VP590>(&CPU, VIP_color_video_output, this);
 							color_board->AttachDisplayRenderer(DisplayRenderer);
 							MemoryMap.push_back(MemoryMapData { 0xC000, 0xDFFF, nullptr, 0x1FFF, 0x02, VP590_memory_write, color_board.get() });
 							break;
 						}
 						case ExpansionBoardType::VP595_SimpleSoundBoard:
 						{
-							tone_generator = nullptr;
-							simple_sound_board = std::make_unique<VP595>(CPU.GetCycleFrequency() / 8.0); // Uses the Simple Sound Board's oscillator frequency instead of the CPU's.
+							simple_sound_board = std::make_unique<VP595>(static_cast<uint32_t>(CPU.GetCycleFrequency()));
+							simple_sound_board->GenerateTone(CPU.GetQ() != 0, CPU.GetMachineCycleCount()); // Q is only reported on changes, so pick up its current state
+							simple_sound_board->SetVolume(source_volume[static_cast<uint8_t>(SoundSourceType::VP595_SimpleSoundBoard)], CPU.GetMachineCycleCount());
+							tone_generator->GenerateTone(false, CPU.GetMachineCycleCount()); // The board takes over Q from the base tone generator
+							if (SoundEngine != nullptr)
+							{
+								SoundEngine->AttachSource(simple_sound_board.get());
+							}
+							break;
+						}
+						case ExpansionBoardType::VP550_SuperSoundBoard:
+						case ExpansionBoardType::VP551_SuperSoundBoard:
+						{
+							UninstallExpansionBoard((board == ExpansionBoardType::VP550_SuperSoundBoard) ? ExpansionBoardType::VP551_SuperSoundBoard : ExpansionBoardType::VP550_SuperSoundBoard); // Both boards decode the same addresses
+							super_sound_board = std::make_unique<VP550>(&CPU, (board == ExpansionBoardType::VP550_SuperSoundBoard) ? 2 : 4);
+							super_sound_board->GenerateTone(CPU.GetQ() != 0, CPU.GetMachineCycleCount());
+							super_sound_board->SetVolume(source_volume[static_cast<uint8_t>(SoundSourceType::VP550_SuperSoundBoard)], CPU.GetMachineCycleCount());
+							tone_generator->GenerateTone(false, CPU.GetMachineCycleCount());
+							MemoryMap.push_back(MemoryMapData { 0x8000, 0xFFFF, nullptr, 0x8000, 0x02, VP550_memory_write, super_sound_board.get() });
+							if (SoundEngine != nullptr)
+							{
+								SoundEngine->AttachSource(super_sound_board.get());
+							}
+							break;
+						}
+						default:
+						{
 							break;
 						}
 					}
@@ -92,7 +240,7 @@ namespace VIPR_Emulator
 					{
 						case ExpansionBoardType::VP590_ColorBoard:
 						{
-							MemoryMap.pop_back();
+							RemoveMemoryMap(color_board.get());
 							color_board = nullptr;
 							VDC = std::make_unique<CDP1861>(&CPU, 0, VIP_video_output, this);
 							VDC->AttachDisplayRenderer(DisplayRenderer);
@@ -100,29 +248,83 @@ namespace VIPR_Emulator
 						}
 						case ExpansionBoardType::VP595_SimpleSoundBoard:
 						{
+							if (SoundEngine != nullptr)
+							{
+								SoundEngine->DetachSource(simple_sound_board.get());
+							}
 							simple_sound_board = nullptr;
-							tone_generator = std::make_unique<ToneGenerator>();
+							if (super_sound_board == nullptr)
+							{
+								tone_generator->GenerateTone(CPU.GetQ() != 0, CPU.GetMachineCycleCount()); // Q is only reported on changes, so pick up its current state
+							}
+							break;
+						}
+						case ExpansionBoardType::VP550_SuperSoundBoard:
+						case ExpansionBoardType::VP551_SuperSoundBoard:
+						{
+							RemoveMemoryMap(super_sound_board.get());
+							if (SoundEngine != nullptr)
+							{
+								SoundEngine->DetachSource(super_sound_board.get());
+							}
+							super_sound_board = nullptr;
+							if (simple_sound_board == nullptr)
+							{
+								tone_generator->GenerateTone(CPU.GetQ() != 0, CPU.GetMachineCycleCount());
+							}
+							break;
+						}
+						default:
+						{
 							break;
 						}
 					}
 				}
 			}
 
-			inline void SetupDisplay(Renderer *DisplayRenderer)
+			inline void SetSourceVolume(SoundSourceType source, uint8_t volume) // Kept for boards installed later, since each install makes a new board
 			{
-				this->DisplayRenderer = DisplayRenderer;
-				VDC->AttachDisplayRenderer(this->DisplayRenderer);
+				source_volume[static_cast<uint8_t>(source)] = volume;
+				AudioSource *Source = nullptr;
+				switch (source)
+				{
+					case SoundSourceType::ToneGenerator:
+					{
+						Source = tone_generator.get();
+						break;
+					}
+					case SoundSourceType::VP595_SimpleSoundBoard:
+					{
+						Source = simple_sound_board.get();
+						break;
+					}
+					case SoundSourceType::VP550_SuperSoundBoard:
+					{
+						Source = super_sound_board.get();
+						break;
+					}
+				}
+				if (Source != nullptr)
+				{
+					Source->SetVolume(volume, CPU.GetMachineCycleCount());
+				}
 			}
 
-			inline void SetupAudio(std::string output_audio_device)
+			inline uint8_t GetSourceVolume(SoundSourceType source) const
 			{
-				if (tone_generator != nullptr)
+				return source_volume[static_cast<uint8_t>(source)];
+			}
+
+			inline void SetupDisplay(DisplayOutput *DisplayRenderer) // Can be switched at any time, e.g. to put a timer in front of the display
+			{
+				this->DisplayRenderer = DisplayRenderer;
+				if (color_board != nullptr)
 				{
-					tone_generator->SetupToneGenerator(output_audio_device);
+					color_board->AttachDisplayRenderer(this->DisplayRenderer);
 				}
-				else if (simple_sound_board != nullptr)
+				else
 				{
-					simple_sound_board->SetupVP595(output_audio_device);
+					VDC->AttachDisplayRenderer(this->DisplayRenderer);
 				}
 			}
 
@@ -143,7 +345,10 @@ namespace VIPR_Emulator
 
 			inline void Reset()
 			{
-				memset(RAM.data(), 0, RAM.size());
+				if (!RAMImage.IsOpen()) // File backed RAM is meant to survive power cycles
+				{
+					memset(RAMData.data(), 0, RAMData.size());
+				}
 				SetRunSwitch(false);
 				CPU.Initialize();
 				if (color_board != nullptr)
@@ -154,39 +359,48 @@ namespace VIPR_Emulator
 
 			inline void InstallROM(std::vector<uint8_t> &&ROM)
 			{
-				this->ROM = ROM;
-				MemoryMap[0].memory = this->ROM.data();
-				MemoryMap[0].size = this->ROM.size();
-				MemoryMap[1].memory = this->ROM.data();
-				MemoryMap[1].size = this->ROM.size();
+				ROMImage.Close();
+				this->ROM = std::move(ROM);
+				ROMData = this->ROM;
+				MapROM();
+			}
+
+			inline void InstallROM(MappedFile &&ROMImage) // The mapping is used in place, so nothing is copied
+			{
+				this->ROMImage = std::move(ROMImage);
+				ROM.clear();
+				ROM.shrink_to_fit();
+				ROMData = std::span<uint8_t>(this->ROMImage.GetData(), this->ROMImage.GetSize());
+				MapROM();
 			}
 
 			inline size_t GetRAM() const
 			{
-				return RAM.size();
+				return RAMData.size();
 			}
 
 			inline uint8_t *GetRAMData()
 			{
-				return RAM.data();
+				return RAMData.data();
 			}
 
-			inline void AdjustRAM(uint8_t RAM_KB)
+			inline bool HasRAMFile() const
 			{
-				RAM.resize(RAM_KB << 10);
-				memset(RAM.data(), 0, RAM.size());
+				return RAMImage.IsOpen();
 			}
 
-			inline void AdjustVolume(uint8_t volume)
+			inline bool AdjustRAM(uint8_t RAM_KB) // Fails if an attached RAM file can't be resized, which detaches it and leaves cleared RAM of the new size
 			{
-				if (tone_generator != nullptr)
-				{
-					tone_generator->SetVolume(volume);
-				}
-				else if (simple_sound_board != nullptr)
+				bool had_ram_file = RAMImage.IsOpen();
+				if (had_ram_file && RAMImage.Resize(RAM_KB << 10)) // A file keeps its contents, only growing or shrinking
 				{
-					simple_sound_board->SetVolume(volume);
+					UpdateRAMData(std::span<uint8_t>(RAMImage.GetData(), RAMImage.GetSize()));
+					return true;
 				}
+				RAM.resize(RAM_KB << 10);
+				memset(RAM.data(), 0, RAM.size());
+				UpdateRAMData(RAM);
+				return !had_ram_file;
 			}
 
 			inline void ResetAddressInhibitLatch()
@@ -194,8 +408,8 @@ namespace VIPR_Emulator
 				if (address_inhibit_latch)
 				{
 					address_inhibit_latch = false;
-					MemoryMap[0].memory = RAM.data();
-					MemoryMap[0].size = RAM.size();
+					MemoryMap[0].memory = RAMData.data();
+					MemoryMap[0].size = RAMData.size();
 					MemoryMap[0].access |= 0x02;
 				}
 			}
@@ -217,31 +431,65 @@ namespace VIPR_Emulator
 				}
 			}
 
-			inline void PauseAudio(bool toggle)
-			{
-				if (tone_generator != nullptr)
-				{
-					tone_generator->Pause(toggle);
-				}
-				else if (simple_sound_board != nullptr)
-				{
-					simple_sound_board->Pause(toggle);
-				}
-			}
-
 			friend uint8_t VIP_memory_read(uint16_t address, void *userdata);
 			friend void VIP_memory_write(uint16_t address, uint8_t data, void *userdata);
+			friend uint8_t VIP_debug_memory_read(uint16_t address, void *userdata);
+			friend void VIP_debug_memory_write(uint16_t address, uint8_t data, void *userdata);
 			friend uint8_t VIP_input(uint8_t N, void *userdata);
 			friend void VIP_output(uint8_t N, uint8_t data, void *userdata);
 			friend void VIP_q_output(uint8_t Q, void *userdata);
 			friend void VIP_sync(void *userdata);
+			friend uint32_t VIP_sync_skip(uint32_t machine_cycles, uint32_t cycles_per_step, void *userdata);
 			friend void VIP_video_output(uint8_t value, uint8_t line, size_t address, void *userdata);
+			friend void VIP_color_video_output(uint8_t value, uint8_t line, size_t address, uint8_t background_color, uint8_t dot_color, void *userdata);
 		private:
+			inline void MapROM()
+			{
+				MemoryMap[0].memory = ROMData.data();
+				MemoryMap[0].size = ROMData.size();
+				MemoryMap[1].memory = ROMData.data();
+				MemoryMap[1].size = ROMData.size();
+			}
+
+			inline void UpdateRAMData(std::span<uint8_t> RAMData) // RAM may move when it's resized or attached to a file, and the CPU may already be addressing it
+			{
+				this->RAMData = RAMData;
+				if (!address_inhibit_latch)
+				{
+					MemoryMap[0].memory = RAMData.data();
+					MemoryMap[0].size = RAMData.size();
+				}
+			}
+
+			inline size_t GetKeypadCount() const // The second keypad needs the VP-585 or VP-590
+			{
+				return (ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP585_ExpansionKeypadInterface)] || ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP590_ColorBoard)]) ? 2 : 1;
+			}
+
+			inline bool GetHexKeyPressSignal(size_t keypad) const
+			{
+				return (current_hex_key[keypad] == hex_key_latch && hex_key_pressed[keypad]);
+			}
+
+			inline void RemoveMemoryMap(void *custom_memory_write_userdata) // Boards may be removed in any order, so their mappings are found by owner rather than position
+			{
+				std::erase_if(MemoryMap, [custom_memory_write_userdata](const MemoryMapData &CurrentMemoryMap) { return CurrentMemoryMap.custom_memory_write_userdata == custom_memory_write_userdata; });
+			}
+
+			inline void RenderAudio() // Audio is generated on the emulation thread from elapsed machine cycles, then pulled by the audio device
+			{
+				if (SoundEngine != nullptr)
+				{
+					SoundEngine->Render(CPU.GetMachineCycleCount());
+				}
+			}
+
 			CDP1802 CPU;
 			std::unique_ptr<CDP1861> VDC;
 			std::unique_ptr<ToneGenerator> tone_generator;
 			std::unique_ptr<VP590> color_board;
 			std::unique_ptr<VP595> simple_sound_board;
+			std::unique_ptr<VP550> super_sound_board;
 			bool run;
 			bool address_inhibit_latch;
 			uint8_t hex_key_latch; // 4-bit
@@ -251,17 +499,27 @@ namespace VIPR_Emulator
 			bool fail;
 			std::vector<uint8_t> RAM;
 			std::vector<uint8_t> ROM;
+			MappedFile RAMImage;
+			MappedFile ROMImage;
+			std::span<uint8_t> RAMData; // Whichever of RAM or RAMImage currently holds the machine's RAM
+			std::span<uint8_t> ROMData; // Likewise for ROM or ROMImage
 			std::vector<MemoryMapData> MemoryMap;
-			std::array<bool, 3> ExpansionBoard;
-			Renderer *DisplayRenderer;
+			std::array<bool, 5> ExpansionBoard;
+			std::array<uint8_t, 3> source_volume; // 0-100, by SoundSourceType
+			DisplayOutput *DisplayRenderer;
+			AudioEngine *SoundEngine;
+			Debugger *Debug;
+			VideoFrame current_frame;
+			VideoFrame last_frame;
+			FrameOutputCallback frame_output_func;
+			void *frame_output_userdata;
 	};
 
-	uint8_t VIP_memory_read(uint16_t address, void *userdata);
-	void VIP_memory_write(uint16_t address, uint8_t data, void *userdata);
 	uint8_t VIP_input(uint8_t N, void *userdata);
 	void VIP_output(uint8_t N, uint8_t data, void *userdata);
 	void VIP_q_output(uint8_t Q, void *userdata);
 	void VIP_sync(void *userdata);
+	uint32_t VIP_sync_skip(uint32_t machine_cycles, uint32_t cycles_per_step, void *userdata);
 }
 
 #endif
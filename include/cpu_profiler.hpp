@@ -0,0 +1,87 @@
+#ifndef _CPU_PROFILER_HPP_
+#define _CPU_PROFILER_HPP_
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+#include <unordered_map>
+
+namespace VIPR_Emulator
+{
+	struct ExecutionStats
+	{
+		uint64_t executions;
+		uint64_t cycles; // Machine cycles, including the fetch
+		uint8_t opcode; // For addresses, the last opcode fetched there
+	};
+
+	std::string GetMnemonic(uint8_t opcode);
+
+	class CPUProfiler // Counts executions and machine cycles per opcode, per address and per routine; only called by a CDP1802 running its instrumented core
+	{
+		public:
+			CPUProfiler();
+			~CPUProfiler();
+			void Reset();
+
+			inline void CountFetch(uint8_t P, uint16_t address, uint8_t opcode)
+			{
+				if (P != current_P)
+				{
+					SwitchProgramCounter(P, address);
+				}
+				current_opcode = opcode;
+				current_address = address;
+				++Opcodes[opcode].executions;
+				++Addresses[address].executions;
+				Addresses[address].opcode = opcode;
+				CountExecuteCycle();
+			}
+
+			inline void CountExecuteCycle()
+			{
+				++Opcodes[current_opcode].cycles;
+				++Addresses[current_address].cycles;
+				++Routines[current_routine].cycles;
+				++instruction_cycles;
+			}
+
+			inline void CountDMACycle()
+			{
+				++dma_cycles;
+			}
+
+			inline void CountInterruptCycle()
+			{
+				++interrupt_cycles;
+			}
+
+			std::string FormatReport(size_t hot_spot_count) const; // Opcodes and the hottest addresses, sorted by machine cycles
+			std::string FormatFoldedStacks() const; // One 'routine;routine;... cycles' line per call path, for flame graph tools
+		private:
+			struct RoutineNode // A routine is code run under one P register, entered at the address P pointed to when it was switched to
+			{
+				uint32_t parent;
+				uint8_t P;
+				uint16_t entry_address;
+				uint64_t cycles;
+			};
+
+			std::array<ExecutionStats, 256> Opcodes;
+			std::vector<ExecutionStats> Addresses;
+			std::vector<RoutineNode> Routines; // The first node is the root, which has no routine of its own
+			std::unordered_map<uint64_t, uint32_t> RoutineChildren; // Keyed by parent node, P and entry address
+			uint32_t current_routine;
+			uint8_t current_P;
+			uint8_t current_opcode;
+			uint16_t current_address;
+			uint64_t instruction_cycles;
+			uint64_t dma_cycles;
+			uint64_t interrupt_cycles;
+
+			void SwitchProgramCounter(uint8_t P, uint16_t address);
+	};
+}
+
+#endif
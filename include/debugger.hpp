@@ -0,0 +1,145 @@
+#ifndef _DEBUGGER_HPP_
+#define _DEBUGGER_HPP_
+
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+
+namespace VIPR_Emulator
+{
+	enum class BreakpointType : uint8_t // Flags, as kept per address
+	{
+		Execute = 0x01,
+		Read = 0x02,
+		Write = 0x04,
+		Watch = 0x08, // Stops on writes that change the value
+		ColorWatch = 0x10 // Same as Watch, but on a VP-590 color RAM location (0x00-0xFF) instead of an address
+	};
+
+	enum class StopReason
+	{
+		None, Pause, Step, Execute, Read, Write, Watch, ColorWatch
+	};
+
+	struct Breakpoint
+	{
+		BreakpointType type;
+		uint16_t address;
+	};
+
+	std::string GetBreakpointTypeName(BreakpointType type);
+
+	class Debugger // Only consulted by a CDP1802 running its instrumented core, which it's switched to while breakpoints are set or a stop is pending
+	{
+		public:
+			static constexpr uint8_t memory_breakpoint_flags = static_cast<uint8_t>(BreakpointType::Read) | static_cast<uint8_t>(BreakpointType::Write) | static_cast<uint8_t>(BreakpointType::Watch);
+
+			Debugger();
+			~Debugger();
+
+			bool AddBreakpoint(BreakpointType type, uint16_t address);
+			bool RemoveBreakpoint(BreakpointType type, uint16_t address);
+			void ClearBreakpoints();
+
+			inline const std::vector<Breakpoint> &GetBreakpoints() const
+			{
+				return Breakpoints;
+			}
+
+			inline bool HasMemoryBreakpoints() const // Whether reads and writes need to be checked at all
+			{
+				return memory_breakpoint_count > 0 || color_watch_count > 0;
+			}
+
+			inline bool HasColorWatches() const
+			{
+				return color_watch_count > 0;
+			}
+
+			inline bool IsActive() const
+			{
+				return !Breakpoints.empty() || pause_request || step_request || stopped;
+			}
+
+			inline bool CheckAddress(uint16_t address, uint8_t flags) const // The page summary keeps the check to one load for pages without breakpoints
+			{
+				return (PageFlags[address >> 8] & flags) && (AddressFlags[address] & flags);
+			}
+
+			inline bool CheckColorWatch(uint8_t location) const
+			{
+				return ColorWatches[location];
+			}
+
+			inline bool CheckFetch(uint16_t address) // Called before each fetch; returns true to stop before it
+			{
+				if (resume_fetch)
+				{
+					resume_fetch = false; // Let the instruction that was stopped on run
+					return false;
+				}
+				if (pause_request || step_request)
+				{
+					Stop(pause_request ? StopReason::Pause : StopReason::Step, address);
+					return true;
+				}
+				if (CheckAddress(address, static_cast<uint8_t>(BreakpointType::Execute)))
+				{
+					Stop(StopReason::Execute, address);
+					return true;
+				}
+				return false;
+			}
+
+			inline void Stop(StopReason reason, uint16_t address)
+			{
+				if (!stopped) // The first reason wins when an instruction trips several breakpoints
+				{
+					stopped = true;
+					stop_reason = reason;
+					stop_address = address;
+				}
+				pause_request = false;
+				step_request = false;
+			}
+
+			inline bool IsStopped() const
+			{
+				return stopped;
+			}
+
+			inline StopReason GetStopReason() const
+			{
+				return stop_reason;
+			}
+
+			inline uint16_t GetStopAddress() const
+			{
+				return stop_address;
+			}
+
+			void Pause(); // Stops before the next instruction
+			void Step(); // Runs to the start of the next instruction, or to the next instruction boundary if the CPU wasn't stopped on one
+			void Continue();
+			std::string FormatStopReason() const;
+		private:
+			std::array<uint8_t, 0x10000> AddressFlags;
+			std::array<uint8_t, 0x100> PageFlags; // Every flag set on any address in the page
+			std::array<bool, 0x100> ColorWatches;
+			std::vector<Breakpoint> Breakpoints;
+			size_t memory_breakpoint_count;
+			size_t color_watch_count;
+			bool pause_request;
+			bool step_request;
+			bool resume_fetch;
+			bool stopped;
+			StopReason stop_reason;
+			uint16_t stop_address;
+
+			void UpdatePageFlags(uint8_t page);
+			void Resume();
+	};
+}
+
+#endif
@@ -0,0 +1,18 @@
+#ifndef _DISPLAY_OUTPUT_HPP_
+#define _DISPLAY_OUTPUT_HPP_
+
+#include <cstdint>
+
+namespace VIPR_Emulator
+{
+	class DisplayOutput // Where a machine's video chips draw; the renderers implement it for the window, and a machine without one runs without drawing anything
+	{
+		public:
+			virtual ~DisplayOutput() = default;
+			virtual void Render() = 0; // Called once per completed frame
+			virtual void ClearDisplay() = 0;
+			virtual void DrawByte(uint8_t data, uint8_t line, uint8_t offset, uint8_t background_color, uint8_t dot_color) = 0;
+	};
+}
+
+#endif
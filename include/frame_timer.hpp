@@ -0,0 +1,66 @@
+#ifndef _FRAME_TIMER_HPP_
+#define _FRAME_TIMER_HPP_
+
+#include "display_output.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <chrono>
+
+namespace VIPR_Emulator
+{
+	struct FrameTimingStats // Percentiles are over the most recent frames, in milliseconds
+	{
+		uint64_t frames;
+		uint64_t late_frames; // Frames that took over 1.5 times the nominal frame time to arrive
+		double interval_p50;
+		double interval_p95;
+		double interval_p99;
+		double render_p50; // Time spent in the display's Render, including presenting
+		double render_p99;
+	};
+
+	class FrameTimer : public DisplayOutput // Passes everything through to another display, timing each frame on the way; only put in front of a display while its timings are wanted
+	{
+		public:
+			static constexpr size_t frame_history = 128;
+
+			FrameTimer();
+			~FrameTimer() override;
+			void Reset();
+			FrameTimingStats GetStats() const;
+
+			inline void SetDisplay(DisplayOutput *Display)
+			{
+				this->Display = Display;
+			}
+
+			inline void SetNominalFrameTime(double frame_ms)
+			{
+				late_frame_ms = frame_ms * 1.5;
+			}
+
+			void Render() override;
+
+			inline void ClearDisplay() override
+			{
+				Display->ClearDisplay();
+			}
+
+			inline void DrawByte(uint8_t data, uint8_t line, uint8_t offset, uint8_t background_color, uint8_t dot_color) override
+			{
+				Display->DrawByte(data, line, offset, background_color, dot_color);
+			}
+		private:
+			DisplayOutput *Display;
+			std::chrono::steady_clock::time_point last_frame_tp;
+			std::array<float, frame_history> FrameIntervals;
+			std::array<float, frame_history> RenderTimes;
+			size_t interval_count; // Total recorded, so the history is only partially filled at first
+			size_t render_count;
+			uint64_t late_frames;
+			double late_frame_ms;
+	};
+}
+
+#endif
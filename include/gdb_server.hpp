@@ -0,0 +1,64 @@
+#ifndef _GDB_SERVER_HPP_
+#define _GDB_SERVER_HPP_
+
+#include "cosmac_vip.hpp"
+#include "debugger.hpp"
+#include <cstdint>
+#include <string>
+
+namespace VIPR_Emulator
+{
+	/*
+	GDB Remote Serial Protocol register layout (see GetTargetDescription), values are big endian like the CDP1802's own 16-bit data
+
+		0-15: R0-RF (16-bit)
+		16: D, 17: DF, 18: P, 19: X, 20: T, 21: Q, 22: IE (8-bit)
+	*/
+
+	constexpr size_t gdb_register_count = 23;
+	constexpr uint32_t gdb_poll_clocks = 8 * 1024; // How often a running machine checks for an interrupt from the client
+
+	class GDBServer // Serves one client at a time on the emulation thread, so no machine state is shared with other threads
+	{
+		public:
+			GDBServer(COSMAC_VIP &System);
+			~GDBServer();
+			bool Listen(const std::string &address); // "<port>" listens on localhost over TCP, "unix:<path>" on a Unix domain socket
+			bool WaitForClient(); // Blocks until a client connects, then stops the machine before its next instruction
+			void RunMachineClocks(uint32_t clocks); // Runs the machine while serving the client, blocking while the client has it stopped
+
+			inline bool IsConnected() const
+			{
+				return client_fd >= 0;
+			}
+
+			inline bool IsKilled() const
+			{
+				return killed;
+			}
+
+			static std::string GetTargetDescription();
+		private:
+			COSMAC_VIP &System;
+			Debugger Debug;
+			int listen_fd;
+			int client_fd;
+			std::string unix_path;
+			std::string input_buffer;
+			bool no_ack;
+			bool running; // Whether the client is waiting for a stop reply
+			bool killed;
+
+			bool ReceiveData(bool blocking); // Returns false once the client has gone away
+			void ProcessInput();
+			void HandlePacket(const std::string &packet);
+			void SendPacket(const std::string &data);
+			void SendStopReply();
+			void Disconnect();
+			std::string ReadRegisters();
+			bool WriteRegisters(const std::string &data);
+			bool SetBreakpoint(const std::string &packet, bool insert);
+	};
+}
+
+#endif
@@ -2,12 +2,17 @@
 #define _GUI_HPP_
 
 #include "renderer.hpp"
+#include "xxhash.hpp"
 #include <cstdint>
+#include <array>
 #include <string>
 #include <vector>
-#include <sstream>
+#include <string_view>
 #include <variant>
 #include <concepts>
+#include <algorithm>
+#include <type_traits>
+#include <fmt/format.h>
 
 namespace VIPR_Emulator
 {
@@ -313,72 +318,67 @@ namespace VIPR_Emulator
 			GUIEventCallback<Menu> on_activate;
 		};
 
+		inline uint16_t DrawLabel(Renderer &renderer, std::string_view text, uint16_t x, uint16_t y) // Draws "text:" and returns where the value following it starts
+		{
+			renderer.DrawText(text, x, y);
+			renderer.DrawChar(':', x + (text.size() * 8), y);
+			return x + ((text.size() + 2) * 8);
+		}
+
 		template <typename T> requires HasText<T> && HasXY<T> && HasColor<T> && HasHidden<T>
-		void DrawElement(Renderer &renderer, T &element)
+		void DrawElement(Renderer &renderer, const T &element, uint16_t origin_x = 0, uint16_t origin_y = 0)
 		{
 			renderer.SetFontColor(element.color.red, element.color.green, element.color.blue);
 			if (!element.hidden)
 			{
-				renderer.DrawText(element.text, element.x, element.y);
+				renderer.DrawText(element.text, origin_x + element.x, origin_y + element.y);
 			}
 		}
 
 		template <typename T> requires HasText<T> && HasStatus<T> && HasXY<T> && HasColor<T> && HasStatusColor<T> && HasHidden<T>
-		void DrawElement(Renderer &renderer, T &element)
+		void DrawElement(Renderer &renderer, const T &element, uint16_t origin_x = 0, uint16_t origin_y = 0)
 		{
 			renderer.SetFontColor(element.color.red, element.color.green, element.color.blue);
 			if (!element.hidden)
 			{
-				std::ostringstream current_stream;
-				current_stream << element.text << ':';
-				std::string stream_str = current_stream.str();
-				renderer.DrawText(stream_str, element.x, element.y);
-				uint16_t current_x = element.x + ((stream_str.size() + 1) * 8);
+				uint16_t current_x = DrawLabel(renderer, element.text, origin_x + element.x, origin_y + element.y);
 				renderer.SetFontColor(element.status_color.red, element.status_color.green, element.status_color.blue);
-				renderer.DrawText(element.status, current_x, element.y);
+				renderer.DrawText(element.status, current_x, origin_y + element.y);
 			}
 		}
 
 		template <typename T> requires HasText<T> && HasXY<T> && HasColor<T> && HasSelectColor<T> && HasDisabledColor<T> && HasSelect<T> && HasDisabled<T> && HasHidden<T>
-		void DrawElement(Renderer &renderer, T &element)
+		void DrawElement(Renderer &renderer, const T &element, uint16_t origin_x = 0, uint16_t origin_y = 0)
 		{
-			ColorData &current_color = !element.select ? ((!element.disabled) ? element.color : element.disabled_color ) : element.select_color;
+			const ColorData &current_color = !element.select ? ((!element.disabled) ? element.color : element.disabled_color ) : element.select_color;
 			renderer.SetFontColor(current_color.red, current_color.green, current_color.blue);
 			if (!element.hidden)
 			{
-				renderer.DrawText(element.text, element.x, element.y);
+				renderer.DrawText(element.text, origin_x + element.x, origin_y + element.y);
 			}
 		}
 
 		template <typename T> requires HasText<T> && HasXY<T> && HasColor<T> && HasSelectColor<T> && HasToggleColor<T> && HasSelect<T> && HasToggle<T> && HasHidden<T>
-		void DrawElement(Renderer &renderer, T &element)
+		void DrawElement(Renderer &renderer, const T &element, uint16_t origin_x = 0, uint16_t origin_y = 0)
 		{
-			ColorData &current_color = !element.select ? element.color : element.select_color;
+			const ColorData &current_color = !element.select ? element.color : element.select_color;
 			renderer.SetFontColor(current_color.red, current_color.green, current_color.blue);
 			if (!element.hidden)
 			{
-				std::ostringstream current_stream;
-				current_stream << element.text << ':';
-				std::string stream_str = current_stream.str();
-				renderer.DrawText(stream_str, element.x, element.y);
-				uint16_t current_x = element.x + ((stream_str.size() + 1) * 8);
+				uint16_t current_x = DrawLabel(renderer, element.text, origin_x + element.x, origin_y + element.y);
 				renderer.SetFontColor(element.toggle_color.red, element.toggle_color.green, element.toggle_color.blue);
-				renderer.DrawText(element.toggle ? "On" : "Off", current_x, element.y);
+				renderer.DrawText(element.toggle ? "On" : "Off", current_x, origin_y + element.y);
 			}
 		}
 
 		template <typename T> requires HasText<T> && HasStoredInput<T> && HasInput<T> && HasXY<T> && HasColor<T> && HasSelectColor<T> && HasInputColor<T> && HasSelect<T> && HasFocus<T> && HasCursorPos<T> && HasMaxDisplay<T> && HasDisplayStart<T> && HasHidden<T>
-		void DrawElement(Renderer &renderer, T &element)
+		void DrawElement(Renderer &renderer, const T &element, uint16_t origin_x = 0, uint16_t origin_y = 0)
 		{
-			ColorData &current_color = !element.select ? element.color : element.select_color;
+			const ColorData &current_color = !element.select ? element.color : element.select_color;
 			renderer.SetFontColor(current_color.red, current_color.green, current_color.blue);
 			if (!element.hidden)
 			{
-				std::ostringstream current_stream;
-				current_stream << element.text << ':';
-				std::string stream_str = current_stream.str();
-				renderer.DrawText(stream_str, element.x, element.y);
-				uint16_t current_x = element.x + ((stream_str.size() + 1) * 8);
+				uint16_t current_x = DrawLabel(renderer, element.text, origin_x + element.x, origin_y + element.y);
 				renderer.SetFontColor(element.input_color.red, element.input_color.green, element.input_color.blue);
 				uint16_t input_count = element.focus ? element.input.size() : element.stored_input.size();
 				for (uint16_t i = element.display_start; i < input_count + 1 && i < element.display_start + element.max_display; ++i)
@@ -387,7 +387,7 @@ namespace VIPR_Emulator
 					{
 						renderer.SetFontFlags(0x01);
 					}
-					renderer.DrawChar(element.focus ? (i < input_count ? element.input[i] : 32) : (i < input_count ? element.stored_input[i] : 32), current_x, element.y);
+					renderer.DrawChar(element.focus ? (i < input_count ? element.input[i] : 32) : (i < input_count ? element.stored_input[i] : 32), current_x, origin_y + element.y);
 					renderer.SetFontFlags(0x00);
 					current_x += 8;
 				}
@@ -395,55 +395,42 @@ namespace VIPR_Emulator
 		}	
 
 		template <typename T> requires HasText<T> && HasXY<T> && HasColor<T> && HasSelectColor<T> && HasChoiceColor<T> && HasCurrentChoice<T> && HasChoiceList<T> && HasHidden<T>
-		void DrawElement(Renderer &renderer, T &element)
+		void DrawElement(Renderer &renderer, const T &element, uint16_t origin_x = 0, uint16_t origin_y = 0)
 		{
-			ColorData &current_color = !element.select ? element.color : element.select_color;
+			const ColorData &current_color = !element.select ? element.color : element.select_color;
 			renderer.SetFontColor(current_color.red, current_color.green, current_color.blue);
 			if (!element.hidden)
 			{
-				std::ostringstream current_stream;
-				current_stream << element.text << ':';
-				std::string stream_str = current_stream.str();
-				renderer.DrawText(stream_str, element.x, element.y);
+				uint16_t current_x = DrawLabel(renderer, element.text, origin_x + element.x, origin_y + element.y);
 				if (element.current_choice < element.choice_list.size())
 				{
-					uint16_t current_x = element.x + ((stream_str.size() + 1) * 8);
 					renderer.SetFontColor(element.choice_color.red, element.choice_color.green, element.choice_color.blue);
-					renderer.DrawText(element.choice_list[element.current_choice], current_x, element.y);
+					renderer.DrawText(element.choice_list[element.current_choice], current_x, origin_y + element.y);
 				};
 			}
 		}
 
 		template <typename T> requires HasText<T> && HasInput<T> && HasXY<T> && HasColor<T> && HasSelectColor<T> && HasValueColor<T> && HasSelect<T> && HasBase<T> && HasValue<T> && HasCursorPos<T> && HasFocus<T> && HasHidden<T>
-		void DrawElement(Renderer &renderer, T &element)
+		void DrawElement(Renderer &renderer, const T &element, uint16_t origin_x = 0, uint16_t origin_y = 0)
 		{
-			ColorData &current_color = !element.select ? element.color : element.select_color;
+			const ColorData &current_color = !element.select ? element.color : element.select_color;
 			renderer.SetFontColor(current_color.red, current_color.green, current_color.blue);
 			if (!element.hidden)
 			{
-				std::ostringstream current_stream;
-				current_stream << element.text << ':';
-				std::string stream_str = current_stream.str();
-				renderer.DrawText(stream_str, element.x, element.y);
-				uint16_t current_x = element.x + ((stream_str.size() + 1) * 8);
-				current_stream.str("");
+				uint16_t current_x = DrawLabel(renderer, element.text, origin_x + element.x, origin_y + element.y);
 				renderer.SetFontColor(element.value_color.red, element.value_color.green, element.value_color.blue);
-				if (element.base == ValueBaseType::Hexadecimal)
-				{
-					current_stream << "0x";
-					current_stream << std::hex;
-				}
 				if (!element.focus)
 				{
-					current_stream << element.value;
-					renderer.DrawText(current_stream.str(), current_x, element.y);
+					std::array<char, 16> value_buffer; // Fits "0x" followed by a 32-bit hexadecimal value or any signed 32-bit decimal value
+					auto result = (element.base == ValueBaseType::Hexadecimal) ? fmt::format_to_n(value_buffer.data(), value_buffer.size(), "0x{:x}", static_cast<uint32_t>(element.value)) : fmt::format_to_n(value_buffer.data(), value_buffer.size(), "{}", element.value);
+					renderer.DrawText(std::string_view(value_buffer.data(), result.size), current_x, origin_y + element.y);
 				}
 				else
 				{
 					if (element.base == ValueBaseType::Hexadecimal)
 					{
-						renderer.DrawText(current_stream.str(), current_x, element.y);
-						current_x += 8 * current_stream.str().size();
+						renderer.DrawText("0x", current_x, origin_y + element.y);
+						current_x += 8 * 2;
 					}
 					uint16_t input_count = element.input.size();
 					for (uint16_t i = 0; i < input_count + 1; ++i)
@@ -452,7 +439,7 @@ namespace VIPR_Emulator
 						{
 							renderer.SetFontFlags(0x01);
 						}
-						renderer.DrawChar(i < input_count ? element.input[i] : 32, current_x, element.y);
+						renderer.DrawChar(i < input_count ? element.input[i] : 32, current_x, origin_y + element.y);
 						renderer.SetFontFlags(0x00);
 						current_x += 8;
 					}
@@ -460,74 +447,301 @@ namespace VIPR_Emulator
 			}
 		}
 
+		inline void DrawMenuElement(Renderer &renderer, const ElementData &data, uint16_t origin_x, uint16_t origin_y)
+		{
+			switch (data.type)
+			{
+				case ElementType::Text:
+				{
+					DrawElement(renderer, std::get<Text>(data.element), origin_x, origin_y);
+					break;
+				}
+				case ElementType::Status:
+				{
+					DrawElement(renderer, std::get<Status>(data.element), origin_x, origin_y);
+					break;
+				}
+				case ElementType::Button:
+				{
+					DrawElement(renderer, std::get<Button>(data.element), origin_x, origin_y);
+					break;
+				}
+				case ElementType::Toggle:
+				{
+					DrawElement(renderer, std::get<Toggle>(data.element), origin_x, origin_y);
+					break;
+				}
+				case ElementType::Input:
+				{
+					DrawElement(renderer, std::get<Input>(data.element), origin_x, origin_y);
+					break;
+				}
+				case ElementType::MultiChoice:
+				{
+					DrawElement(renderer, std::get<MultiChoice>(data.element), origin_x, origin_y);
+					break;
+				}
+				case ElementType::Value:
+				{
+					DrawElement(renderer, std::get<Value>(data.element), origin_x, origin_y);
+					break;
+				}
+			}
+		}
+
 		template <typename T> requires HasXY<T> && HasElementList<T> && HasHidden<T>
-		void DrawElement(Renderer &renderer, T &element)
+		void DrawElement(Renderer &renderer, const T &element, uint16_t origin_x = 0, uint16_t origin_y = 0)
 		{
 			if (!element.hidden)
 			{
 				for (auto &i : element.element_list)
 				{
-					switch (i.type)
+					DrawMenuElement(renderer, i, origin_x + element.x, origin_y + element.y);
+				}
+			}
+		}
+
+		struct ElementCacheData
+		{
+			uint64_t hash;
+			uint16_t x;
+			uint16_t y;
+			uint16_t width;
+			bool dirty;
+		};
+
+		struct MenuCache // What was last drawn into the secondary framebuffer, so unchanged elements can be left alone
+		{
+			const Menu *menu = nullptr;
+			uint16_t x = 0;
+			uint16_t y = 0;
+			std::vector<ElementCacheData> element_cache;
+			std::vector<ElementCacheData> next_element_cache;
+		};
+
+		inline uint64_t HashString(const std::string &text, uint64_t seed)
+		{
+			return XXHash64(text.data(), text.size(), seed + text.size());
+		}
+
+		inline uint64_t HashColor(const ColorData &color, uint64_t seed)
+		{
+			std::array<uint8_t, 3> color_data = { color.red, color.green, color.blue };
+			return XXHash64(color_data.data(), color_data.size(), seed);
+		}
+
+		template <typename T> requires std::is_arithmetic_v<T> || std::is_enum_v<T>
+		inline uint64_t HashValue(T value, uint64_t seed)
+		{
+			return XXHash64(&value, sizeof(value), seed);
+		}
+
+		template <typename T> requires HasText<T> && HasXY<T> && HasHidden<T>
+		uint64_t GetElementHash(const T &element) // Covers everything DrawElement reads
+		{
+			uint64_t hash = HashString(element.text, 0);
+			hash = HashValue(element.x, hash);
+			hash = HashValue(element.y, hash);
+			hash = HashValue(element.hidden, hash);
+			if constexpr (HasColor<T>)
+			{
+				hash = HashColor(element.color, hash);
+			}
+			if constexpr (HasStatus<T>)
+			{
+				hash = HashString(element.status, hash);
+			}
+			if constexpr (HasStatusColor<T>)
+			{
+				hash = HashColor(element.status_color, hash);
+			}
+			if constexpr (HasSelectColor<T>)
+			{
+				hash = HashColor(element.select_color, hash);
+			}
+			if constexpr (HasDisabledColor<T>)
+			{
+				hash = HashColor(element.disabled_color, hash);
+			}
+			if constexpr (HasToggleColor<T>)
+			{
+				hash = HashColor(element.toggle_color, hash);
+			}
+			if constexpr (HasInputColor<T>)
+			{
+				hash = HashColor(element.input_color, hash);
+			}
+			if constexpr (HasChoiceColor<T>)
+			{
+				hash = HashColor(element.choice_color, hash);
+			}
+			if constexpr (HasValueColor<T>)
+			{
+				hash = HashColor(element.value_color, hash);
+			}
+			if constexpr (HasSelect<T>)
+			{
+				hash = HashValue(element.select, hash);
+			}
+			if constexpr (HasDisabled<T>)
+			{
+				hash = HashValue(element.disabled, hash);
+			}
+			if constexpr (HasToggle<T>)
+			{
+				hash = HashValue(element.toggle, hash);
+			}
+			if constexpr (HasFocus<T>)
+			{
+				hash = HashValue(element.focus, hash);
+			}
+			if constexpr (HasCursorPos<T>)
+			{
+				hash = HashValue(element.cursor_pos, hash);
+			}
+			if constexpr (HasMaxDisplay<T>)
+			{
+				hash = HashValue(element.max_display, hash);
+			}
+			if constexpr (HasDisplayStart<T>)
+			{
+				hash = HashValue(element.display_start, hash);
+			}
+			if constexpr (HasStoredInput<T>)
+			{
+				hash = HashString(element.stored_input, hash);
+			}
+			if constexpr (HasInput<T>)
+			{
+				hash = HashString(element.input, hash);
+			}
+			if constexpr (HasCurrentChoice<T> && HasChoiceList<T>)
+			{
+				hash = HashValue(element.current_choice, hash);
+				if (element.current_choice < element.choice_list.size())
+				{
+					hash = HashString(element.choice_list[element.current_choice], hash);
+				}
+			}
+			if constexpr (HasBase<T>)
+			{
+				hash = HashValue(element.base, hash);
+			}
+			if constexpr (HasValue<T>)
+			{
+				hash = HashValue(element.value, hash);
+			}
+			return hash;
+		}
+
+		template <typename T> requires HasText<T> && HasHidden<T>
+		uint16_t GetElementWidth(const T &element) // In pixels, covering everything DrawElement could draw (Labels are followed by ':' and a space)
+		{
+			if (element.hidden)
+			{
+				return 0;
+			}
+			size_t characters = element.text.size();
+			if constexpr (HasStatus<T>)
+			{
+				characters += 2 + element.status.size();
+			}
+			else if constexpr (HasToggle<T>)
+			{
+				characters += 2 + 3;
+			}
+			else if constexpr (HasStoredInput<T>)
+			{
+				characters += 2 + element.max_display;
+			}
+			else if constexpr (HasChoiceList<T>)
+			{
+				characters += 2 + ((element.current_choice < element.choice_list.size()) ? element.choice_list[element.current_choice].size() : 0);
+			}
+			else if constexpr (HasBase<T>)
+			{
+				characters += 2 + 2 + std::max<size_t>(11, element.input.size() + 1);
+			}
+			return static_cast<uint16_t>(characters * 8);
+		}
+
+		inline bool ElementBoundsIntersect(const ElementCacheData &a, const ElementCacheData &b)
+		{
+			return (a.width > 0 && b.width > 0 && a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + 8 && b.y < a.y + 8);
+		}
+
+		inline void DrawMenu(Renderer &renderer, const Menu &menu, MenuCache &cache) // Only redraws elements whose hash changed (along with anything they overlap)
+		{
+			cache.next_element_cache.resize(menu.element_list.size());
+			cache.element_cache.reserve(menu.element_list.size()); // The two are swapped every frame, so both get their storage on the first one
+			for (size_t i = 0; i < menu.element_list.size(); ++i)
+			{
+				ElementCacheData &current_data = cache.next_element_cache[i];
+				std::visit([&current_data, &menu](const auto &element)
+				{
+					current_data.hash = GetElementHash(element);
+					current_data.x = menu.x + element.x;
+					current_data.y = menu.y + element.y;
+					current_data.width = GetElementWidth(element);
+				}, menu.element_list[i].element);
+				current_data.dirty = false;
+			}
+			bool full_redraw = (cache.menu != &menu || cache.x != menu.x || cache.y != menu.y || cache.element_cache.size() != cache.next_element_cache.size());
+			if (full_redraw || menu.hidden)
+			{
+				renderer.ClearSecondaryFramebuffer();
+				for (auto &i : cache.next_element_cache)
+				{
+					i.dirty = !menu.hidden;
+				}
+			}
+			else
+			{
+				for (size_t i = 0; i < cache.next_element_cache.size(); ++i)
+				{
+					cache.next_element_cache[i].dirty = (cache.next_element_cache[i].hash != cache.element_cache[i].hash);
+				}
+				bool dirty_added = true;
+				while (dirty_added)
+				{
+					dirty_added = false;
+					for (size_t i = 0; i < cache.next_element_cache.size(); ++i)
 					{
-						case ElementType::Text:
+						if (!cache.next_element_cache[i].dirty)
 						{
-							Text current_element = std::get<Text>(i.element);
-							current_element.x += element.x;
-							current_element.y += element.y;
-							DrawElement(renderer, current_element);
-							break;
+							continue;
 						}
-						case ElementType::Status:
+						for (size_t j = 0; j < cache.next_element_cache.size(); ++j)
 						{
-							Status current_element = std::get<Status>(i.element);
-							current_element.x += element.x;
-							current_element.y += element.y;
-							DrawElement(renderer, current_element);
-							break;
-						}
-						case ElementType::Button:
-						{
-							Button current_element = std::get<Button>(i.element);
-							current_element.x += element.x;
-							current_element.y += element.y;
-							DrawElement(renderer, current_element);
-							break;
-						}
-						case ElementType::Toggle:
-						{
-							Toggle current_element = std::get<Toggle>(i.element);
-							current_element.x += element.x;
-							current_element.y += element.y;
-							DrawElement(renderer, current_element);
-							break;
-						}
-						case ElementType::Input:
-						{
-							Input current_element = std::get<Input>(i.element);
-							current_element.x += element.x;
-							current_element.y += element.y;
-							DrawElement(renderer, current_element);
-							break;
-						}
-						case ElementType::MultiChoice:
-						{
-							MultiChoice current_element = std::get<MultiChoice>(i.element);
-							current_element.x += element.x;
-							current_element.y += element.y;
-							DrawElement(renderer, current_element);
-							break;
-						}
-						case ElementType::Value:
-						{
-							Value current_element = std::get<Value>(i.element);
-							current_element.x += element.x;
-							current_element.y += element.y;
-							DrawElement(renderer, current_element);
-							break;
+							ElementCacheData &other_data = cache.next_element_cache[j];
+							if (!other_data.dirty && (ElementBoundsIntersect(cache.element_cache[i], other_data) || ElementBoundsIntersect(cache.next_element_cache[i], other_data)))
+							{
+								other_data.dirty = true;
+								dirty_added = true;
+							}
 						}
 					}
 				}
+				for (size_t i = 0; i < cache.next_element_cache.size(); ++i)
+				{
+					const ElementCacheData &previous_data = cache.element_cache[i];
+					if (cache.next_element_cache[i].dirty && previous_data.width > 0)
+					{
+						renderer.ClearSecondaryFramebufferRegion(previous_data.x, previous_data.y, previous_data.width, 8);
+					}
+				}
+			}
+			for (size_t i = 0; i < cache.next_element_cache.size(); ++i)
+			{
+				if (cache.next_element_cache[i].dirty)
+				{
+					DrawMenuElement(renderer, menu.element_list[i], menu.x, menu.y);
+				}
 			}
+			cache.menu = !menu.hidden ? &menu : nullptr;
+			cache.x = menu.x;
+			cache.y = menu.y;
+			std::swap(cache.element_cache, cache.next_element_cache);
 		}
 	}
 }
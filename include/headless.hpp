@@ -0,0 +1,81 @@
+#ifndef _HEADLESS_HPP_
+#define _HEADLESS_HPP_
+
+#include "cosmac_vip.hpp"
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <string>
+
+namespace VIPR_Emulator
+{
+	enum class ScriptEventType
+	{
+		Run, Reset, Press, Release
+	};
+
+	struct ScriptEvent
+	{
+		uint32_t frame;
+		ScriptEventType type;
+		uint8_t hex_key;
+		uint8_t keypad;
+	};
+
+	struct HeadlessOptions
+	{
+		bool enabled;
+		bool update_golden;
+		uint8_t ram_kb;
+		uint32_t frame_count;
+		std::string rom_file;
+		std::string script_file;
+		std::string golden_file;
+		std::string capture_file;
+		std::string audio_dump_file;
+		std::string profile_file;
+		std::string profile_folded_file;
+		std::string trace_file;
+		std::string instruction_trace_file;
+		std::string gdb_address;
+		std::string ram_file;
+		std::array<bool, 5> ExpansionBoard;
+	};
+
+	class VideoRecorder;
+	class WaveWriter;
+	class GDBServer;
+
+	struct HeadlessAudioOutput
+	{
+		uint64_t hash;
+		uint64_t sample_count;
+		VideoRecorder *Recorder;
+		WaveWriter *AudioDump;
+	};
+
+	class HeadlessRunner
+	{
+		public:
+			HeadlessRunner(COSMAC_VIP &System);
+			~HeadlessRunner();
+			void Run(const std::vector<ScriptEvent> &events, uint32_t frame_count, std::vector<uint64_t> &frame_hashes, GDBServer *Remote = nullptr); // With a remote debugger, it controls execution and can end the run early
+		private:
+			COSMAC_VIP &System;
+	};
+
+	void headless_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata);
+
+	bool WriteTextFile(const std::string &text_file, const std::string &text);
+	bool LoadROMFile(const std::string &rom_file, MappedFile &ROMImage); // Maps the file rather than reading it, so installing it copies nothing
+	void SetupHeadlessMachine(COSMAC_VIP &System, uint8_t ram_kb, const std::array<bool, 5> &ExpansionBoard, MappedFile &&ROMImage);
+	size_t CompareGoldenFrames(const std::vector<uint64_t> &golden_hashes, const std::vector<uint64_t> &frame_hashes, bool report_mismatches); // Returns the number of mismatched frames, counting a differing frame count as one
+	bool LoadInputScript(const std::string &script_file, std::vector<ScriptEvent> &events);
+	bool LoadGoldenFile(const std::string &golden_file, std::vector<uint64_t> &frame_hashes);
+	bool SaveGoldenFile(const std::string &golden_file, const std::vector<uint64_t> &frame_hashes);
+	bool ParseExpansionBoard(const std::string &board, std::array<bool, 5> &ExpansionBoard); // Boards that can't be installed together turn each other off
+	bool ParseHeadlessArguments(int argc, char *argv[], HeadlessOptions &options);
+	int RunHeadless(const HeadlessOptions &options);
+}
+
+#endif
@@ -0,0 +1,80 @@
+#ifndef _INSTRUCTION_TRACE_HPP_
+#define _INSTRUCTION_TRACE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <memory>
+#include <string>
+
+namespace VIPR_Emulator
+{
+	/*
+	VIPR Instruction Trace File (.vitr), all values are little endian
+
+	Header:
+		char magic[8] = "VIPRITR1"
+		uint32_t entry_count
+		uint32_t dropped_count (Instructions overwritten before the dump)
+
+	Entries (oldest first, 16 bytes each):
+		uint64_t machine_cycle (Of the fetch)
+		uint16_t address
+		uint8_t opcode
+		uint8_t D
+		uint8_t DF
+		uint8_t XP (X in the high nibble, P in the low one)
+		uint8_t reserved[2]
+	*/
+
+	constexpr std::array<char, 8> instruction_trace_magic = { 'V', 'I', 'P', 'R', 'I', 'T', 'R', '1' };
+	constexpr size_t instruction_trace_header_size = 16;
+	constexpr size_t instruction_trace_default_entries = 1 << 16; // 1 MB, a little under 2 seconds of emulated time
+
+	struct InstructionTraceEntry // The CPU state as the instruction was fetched, before it ran
+	{
+		uint64_t machine_cycle;
+		uint16_t address;
+		uint8_t opcode;
+		uint8_t D;
+		uint8_t DF;
+		uint8_t XP;
+		uint8_t reserved[2];
+	};
+
+	static_assert(sizeof(InstructionTraceEntry) == 16);
+
+	class InstructionTrace // Keeps the most recent instructions in a fixed ring; only written by a CDP1802 running its instrumented core
+	{
+		public:
+			InstructionTrace(size_t entry_count = instruction_trace_default_entries); // Rounded up to a power of two
+			~InstructionTrace();
+
+			inline void Record(uint64_t machine_cycle, uint16_t address, uint8_t opcode, uint8_t D, uint8_t DF, uint8_t X, uint8_t P)
+			{
+				InstructionTraceEntry &CurrentEntry = Entries[write_index & index_mask];
+				CurrentEntry.machine_cycle = machine_cycle;
+				CurrentEntry.address = address;
+				CurrentEntry.opcode = opcode;
+				CurrentEntry.D = D;
+				CurrentEntry.DF = DF;
+				CurrentEntry.XP = static_cast<uint8_t>((X << 4) | P);
+				++write_index;
+			}
+
+			void Clear();
+			bool WriteFile(const std::string &trace_file) const; // Must not run while the CPU is recording
+			size_t GetEntryCount() const;
+
+			inline size_t GetCapacity() const
+			{
+				return index_mask + 1;
+			}
+		private:
+			std::unique_ptr<InstructionTraceEntry[]> Entries;
+			size_t index_mask;
+			uint64_t write_index;
+	};
+}
+
+#endif
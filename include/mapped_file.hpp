@@ -0,0 +1,70 @@
+#ifndef _MAPPED_FILE_HPP_
+#define _MAPPED_FILE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+namespace VIPR_Emulator
+{
+#ifdef _WIN32
+	using NativeFileHandle = void *; // A HANDLE, kept as void * so windows.h stays out of this header
+	constexpr NativeFileHandle no_file_handle = nullptr;
+#else
+	using NativeFileHandle = int;
+	constexpr NativeFileHandle no_file_handle = -1;
+#endif
+
+	enum class MappedFileMode
+	{
+		Read, // Private mapping of the whole file; pages are shared with the page cache until written, and writes never reach the file
+		ReadWrite // Shared mapping, so writes land in the file without any explicit saving
+	};
+
+	class MappedFile // Move-only owner of a memory mapped file, so images can be installed into the memory map without being copied; mapped with mmap, or with file mapping objects on Windows
+	{
+		public:
+			MappedFile();
+			~MappedFile();
+			MappedFile(const MappedFile &) = delete;
+			MappedFile &operator=(const MappedFile &) = delete;
+			MappedFile(MappedFile &&other) noexcept;
+			MappedFile &operator=(MappedFile &&other) noexcept;
+
+			bool Open(const std::string &file, MappedFileMode mode, size_t size = 0); // ReadWrite creates the file if needed and sets it to size bytes, with any added bytes reading as zero
+			bool Resize(size_t size); // ReadWrite only; closes the file on failure
+			void Flush();
+			void Close();
+
+			inline bool IsOpen() const
+			{
+				return open;
+			}
+
+			inline uint8_t *GetData()
+			{
+				return data;
+			}
+
+			inline const uint8_t *GetData() const
+			{
+				return data;
+			}
+
+			inline size_t GetSize() const
+			{
+				return size;
+			}
+		private:
+			NativeFileHandle file; // Only kept open for ReadWrite mappings, which may be resized
+			uint8_t *data;
+			size_t size;
+			MappedFileMode mode;
+			bool open;
+
+			bool Map();
+			void Unmap();
+	};
+}
+
+#endif
@@ -6,9 +6,11 @@
 #include <GLES2/gl2.h>
 #include <GLES2/gl2ext.h>
 #include <string>
+#include <string_view>
 #include <array>
 #include <vector>
 #include "renderer_type.hpp"
+#include "display_output.hpp"
 
 namespace VIPR_Emulator
 {
@@ -40,22 +42,25 @@ namespace VIPR_Emulator
 
 	const RendererType renderer_type = RendererType::OpenGLES_2;
 
-	class Renderer
+	class Renderer : public DisplayOutput
 	{
 		public:
 			Renderer();
-			~Renderer();
+			~Renderer() override;
 			bool Setup(SDL_Window *window);
-			void Render();
+			bool LoadMenuFont(); // Text drawing loads it on first use, so it's only worth calling early to catch a missing font
+			void Render() override;
 			void ClearSecondaryFramebuffer();
-			void ClearDisplay();
+			void ClearSecondaryFramebufferRegion(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
+			void ClearDisplay() override;
 			void SetDisplayType(DisplayType type);
 			DisplayType GetDisplayType() const;
 			void SetFontColor(uint8_t r, uint8_t g, uint8_t b);
 			void SetFontFlags(uint32_t flags);
 			void DrawChar(char character, uint16_t x, uint16_t y);
-			void DrawText(std::string tex, uint16_t x, uint16_t y);
-			void DrawByte(uint8_t data, uint8_t line, uint8_t offset, uint8_t background_color, uint8_t dot_color);
+			void DrawText(std::string_view text, uint16_t x, uint16_t y);
+			void SetOverlayText(std::string_view text); // Drawn over the machine display, with '\n' starting a new line; empty text hides it
+			void DrawByte(uint8_t data, uint8_t line, uint8_t offset, uint8_t background_color, uint8_t dot_color) override;
 		private:
 			SDL_Window *CurrentWindow;
 			SDL_GLContext MainContext;
@@ -67,8 +72,11 @@ namespace VIPR_Emulator
 			GLint PosAttribId, TexAttribId, FontColorUniformId, FontFlagInvertUniformId;
 			DisplayType CurrentDisplayType;
 			FontControlData font_ctrl;
+			bool menu_font_loaded;
 			std::array<Vertex, 4> vertices;
-			std::array<uint8_t, 6> indices;
+			std::vector<uint16_t> indices; // Fullscreen quad, followed by one quad per batched glyph
+			std::vector<Vertex> glyph_vertices;
+			std::vector<Vertex> overlay_vertices;
 			std::array<ColorData<uint8_t>, 64 * 128> display_buffer;
 
 			const std::array<ColorData<uint8_t>, 4> background_colors = {
@@ -89,6 +97,12 @@ namespace VIPR_Emulator
 				ColorData<uint8_t> { 255, 255, 255, 255 }
 			};
 
+			static constexpr uint16_t max_batch_glyphs = 1024;
+
+			void AppendGlyph(char character, uint16_t x, uint16_t y);
+			void AppendGlyphVertices(std::vector<Vertex> &glyph_list, char character, uint16_t x, uint16_t y);
+			void DrawOverlay();
+			void FlushText();
 			bool CompileShader(GLuint &shader, GLuint shader_type, const char *shader_code);
 			bool LinkProgram(GLuint &program, std::vector<GLuint> shader_list);
 	};
@@ -0,0 +1,76 @@
+#ifndef _SETTINGS_HPP_
+#define _SETTINGS_HPP_
+
+#include <cstdint>
+#include <array>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+namespace VIPR_Emulator
+{
+	/*
+	Settings file layout, one "key = value" per line, with '#' or ';' starting a comment line
+
+		[machine]
+		rom = <file>
+		ram = <KB>
+		ram_file = <file>
+		boards = <board>, <board>, ... (vp585, vp590, vp595, vp550 or vp551)
+		autostart = true|false
+
+		[audio]
+		device = <name> (empty for the system default)
+		volume = <0-100>
+		latency = <ms>
+		tone_volume = <0-100> (the base tone generator)
+		vp595_volume = <0-100>
+		vp550_volume = <0-100> (also the VP-551)
+	*/
+
+	struct Settings // Flat, so each setting in the file maps straight onto a member
+	{
+		bool autostart; // Powers the machine on and switches it to RUN without going through the menus
+		uint8_t ram_kb;
+		uint8_t volume;
+		uint16_t audio_latency;
+		std::string rom_file;
+		std::string ram_file;
+		std::string audio_device; // Empty for the system default
+		std::array<bool, 5> ExpansionBoard;
+		std::array<uint8_t, 3> SourceVolume; // By SoundSourceType
+	};
+
+	Settings GetDefaultSettings();
+
+	class SettingsStore // Holds what's in the settings file and rewrites it on a background thread whenever it changes, so nothing waits on disk access
+	{
+		public:
+			SettingsStore(const std::string &settings_file);
+			~SettingsStore(); // Writes out any pending save first
+
+			bool Load(); // A missing or unreadable file leaves the defaults
+			void Save(); // Only the latest settings are written if saves come in faster than they're written
+
+			inline Settings &GetSettings()
+			{
+				return CurrentSettings;
+			}
+
+			static void WriterProcessor(SettingsStore *store);
+		private:
+			std::string settings_file;
+			Settings CurrentSettings;
+			Settings PendingSettings; // Guarded by lock, like the flags below
+			bool save_pending;
+			bool processing;
+			std::mutex lock;
+			std::condition_variable save_signal;
+			std::thread WriterThread; // Only started by the first save
+
+			bool WriteFile(const Settings &SavedSettings);
+	};
+}
+
+#endif
@@ -0,0 +1,151 @@
+#ifndef _SPSC_QUEUE_HPP_
+#define _SPSC_QUEUE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <array>
+#include <atomic>
+#include <algorithm>
+
+namespace VIPR_Emulator
+{
+	template <typename T, size_t Capacity>
+	class SPSCQueue // Lock-free, single producer, single consumer (slots are preallocated and reused)
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSCQueue capacity must be a power of two.");
+		public:
+			SPSCQueue() : head(0), tail(0)
+			{
+			}
+
+			inline T *AcquireWrite()
+			{
+				size_t current_tail = tail.load(std::memory_order_relaxed);
+				if (current_tail - head.load(std::memory_order_acquire) == Capacity)
+				{
+					return nullptr;
+				}
+				return &buffer[current_tail & (Capacity - 1)];
+			}
+
+			inline void CommitWrite()
+			{
+				tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			}
+
+			inline bool Push(const T &value)
+			{
+				T *slot = AcquireWrite();
+				if (slot == nullptr)
+				{
+					return false;
+				}
+				*slot = value;
+				CommitWrite();
+				return true;
+			}
+
+			inline T *AcquireRead()
+			{
+				size_t current_head = head.load(std::memory_order_relaxed);
+				if (current_head == tail.load(std::memory_order_acquire))
+				{
+					return nullptr;
+				}
+				return &buffer[current_head & (Capacity - 1)];
+			}
+
+			inline void CommitRead()
+			{
+				head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+			}
+
+			inline bool Pop(T &value)
+			{
+				T *slot = AcquireRead();
+				if (slot == nullptr)
+				{
+					return false;
+				}
+				value = *slot;
+				CommitRead();
+				return true;
+			}
+
+			inline size_t Size() const
+			{
+				return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+			}
+
+			inline bool Empty() const
+			{
+				return Size() == 0;
+			}
+
+			static constexpr size_t GetCapacity()
+			{
+				return Capacity;
+			}
+		private:
+			std::array<T, Capacity> buffer;
+			alignas(64) std::atomic<size_t> head;
+			alignas(64) std::atomic<size_t> tail;
+	};
+
+	template <typename T, size_t Capacity>
+	class SPSCRingBuffer // Lock-free, single producer, single consumer ring for bulk transfers of trivially copyable values (e.g. audio samples)
+	{
+		static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "SPSCRingBuffer capacity must be a power of two.");
+		public:
+			SPSCRingBuffer() : head(0), tail(0)
+			{
+			}
+
+			size_t Write(const T *data, size_t count)
+			{
+				size_t current_tail = tail.load(std::memory_order_relaxed);
+				size_t available = Capacity - (current_tail - head.load(std::memory_order_acquire));
+				count = std::min(count, available);
+				size_t offset = current_tail & (Capacity - 1);
+				size_t first_part = std::min(count, Capacity - offset);
+				std::copy_n(data, first_part, buffer.begin() + offset);
+				std::copy_n(data + first_part, count - first_part, buffer.begin());
+				tail.store(current_tail + count, std::memory_order_release);
+				return count;
+			}
+
+			size_t Read(T *data, size_t count)
+			{
+				size_t current_head = head.load(std::memory_order_relaxed);
+				size_t available = tail.load(std::memory_order_acquire) - current_head;
+				count = std::min(count, available);
+				size_t offset = current_head & (Capacity - 1);
+				size_t first_part = std::min(count, Capacity - offset);
+				std::copy_n(buffer.begin() + offset, first_part, data);
+				std::copy_n(buffer.begin(), count - first_part, data + first_part);
+				head.store(current_head + count, std::memory_order_release);
+				return count;
+			}
+
+			inline void Discard() // Consumer side only
+			{
+				head.store(tail.load(std::memory_order_acquire), std::memory_order_release);
+			}
+
+			inline size_t Size() const
+			{
+				return tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire);
+			}
+
+			static constexpr size_t GetCapacity()
+			{
+				return Capacity;
+			}
+		private:
+			std::array<T, Capacity> buffer;
+			alignas(64) std::atomic<size_t> head;
+			alignas(64) std::atomic<size_t> tail;
+	};
+}
+
+#endif
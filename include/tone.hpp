@@ -1,47 +1,35 @@
 #ifndef _TONE_HPP_
 #define _TONE_HPP_
 
+#include "audio.hpp"
+#include "audio_engine.hpp"
+#include "blep_synth.hpp"
 #include <cstdint>
-#include <array>
-#include <string>
-#include <thread>
-#include <SDL.h>
+#include <vector>
 
 namespace VIPR_Emulator
 {
-	class ToneGenerator
+	class ToneGenerator : public AudioSource // Parameter changes are queued as cycle-stamped events on the emulation thread and applied while rendering
 	{
 		public:
-			ToneGenerator();
+			ToneGenerator(uint32_t clock_frequency);
 			~ToneGenerator();
 
-			void SetupToneGenerator(std::string output_audio_device);
+			void Render(BandLimitedSynth &synth, uint64_t frame_start_cycle, uint64_t frame_end_cycle) override;
+			void Silence(BandLimitedSynth &synth) override;
 
-			inline void SetVolume(uint8_t volume)
+			inline void SetVolume(uint8_t volume, uint64_t machine_cycle) override
 			{
-				this->volume = static_cast<double>(volume) / 100.0;
+				PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::Volume, volume, 0 });
 			}
 			
-			inline void GenerateTone(bool toggle)
+			inline void GenerateTone(bool toggle, uint64_t machine_cycle)
 			{
-				generate_tone = toggle;
+				PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::Tone, static_cast<uint8_t>(toggle), 0 });
 			}
-			
-			inline void Pause(bool toggle)
-			{
-				pause = toggle;
-			}
-
-			static void AudioProcessor(ToneGenerator *generator);
 		private:
-			SDL_AudioSpec spec;
-			SDL_AudioDeviceID device;
-			bool processing;
-			bool pause;
-			bool generate_tone;
-			double volume;
-			double current_period;
-			std::thread AudioProcessingThread;
+			SquareWaveOscillator Oscillator;
+			std::vector<AudioEvent> PendingEvents; // Stamped with the machine cycle they happened on and applied in order while rendering
 	};
 }
 
@@ -0,0 +1,119 @@
+#ifndef _TRACE_HPP_
+#define _TRACE_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace VIPR_Emulator
+{
+#ifdef VIPR_ENABLE_TRACING
+	constexpr bool tracing_enabled = true;
+#else
+	constexpr bool tracing_enabled = false;
+#endif
+
+	struct TraceEvent // Fields are relaxed atomics so a trace can be written out while threads keep recording
+	{
+		std::atomic<const char *> name;
+		std::atomic<uint64_t> start_ns;
+		std::atomic<uint64_t> duration_ns;
+	};
+
+	class TraceBuffer // One per thread; a ring holding that thread's most recent zones
+	{
+		public:
+			static constexpr size_t buffer_events = 1 << 17; // Must be a power of two
+
+			TraceBuffer(uint32_t thread_id);
+			~TraceBuffer();
+
+			inline void Record(const char *name, uint64_t start_ns, uint64_t duration_ns)
+			{
+				uint64_t index = write_index.load(std::memory_order_relaxed);
+				TraceEvent &CurrentEvent = Events[index & (buffer_events - 1)];
+				CurrentEvent.name.store(name, std::memory_order_relaxed);
+				CurrentEvent.start_ns.store(start_ns, std::memory_order_relaxed);
+				CurrentEvent.duration_ns.store(duration_ns, std::memory_order_relaxed);
+				write_index.store(index + 1, std::memory_order_release);
+			}
+
+			friend class Tracer;
+		private:
+			std::unique_ptr<TraceEvent[]> Events;
+			std::atomic<uint64_t> write_index;
+			std::atomic<const char *> thread_name;
+			uint32_t thread_id;
+	};
+
+	class Tracer // Process wide, since zones are compiled into code shared by every machine
+	{
+		public:
+			static Tracer &Get();
+
+			inline uint64_t GetTimestamp() const // In nanoseconds since the tracer started
+			{
+				return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start_tp).count());
+			}
+
+			inline TraceBuffer *GetThreadBuffer()
+			{
+				thread_local TraceBuffer *CurrentBuffer = nullptr;
+				if (CurrentBuffer == nullptr)
+				{
+					CurrentBuffer = CreateThreadBuffer();
+				}
+				return CurrentBuffer;
+			}
+
+			inline void SetThreadName(const char *name)
+			{
+				GetThreadBuffer()->thread_name.store(name, std::memory_order_relaxed);
+			}
+
+			bool WriteChromeTrace(const std::string &trace_file); // Loadable in chrome://tracing or Perfetto
+		private:
+			Tracer();
+
+			std::chrono::steady_clock::time_point start_tp;
+			std::mutex buffer_lock; // Only taken when a thread records its first zone and while writing a trace
+			std::vector<std::unique_ptr<TraceBuffer>> Buffers; // Kept after their threads exit, so their zones still get written
+
+			TraceBuffer *CreateThreadBuffer();
+	};
+
+	class TraceZone
+	{
+		public:
+			inline TraceZone(const char *name) : name(name), Buffer(Tracer::Get().GetThreadBuffer()), start_ns(Tracer::Get().GetTimestamp())
+			{
+			}
+
+			inline ~TraceZone()
+			{
+				Buffer->Record(name, start_ns, Tracer::Get().GetTimestamp() - start_ns);
+			}
+		private:
+			const char *name;
+			TraceBuffer *Buffer;
+			uint64_t start_ns;
+	};
+}
+
+#define VIPR_TRACE_CONCAT_INNER(a, b) a##b
+#define VIPR_TRACE_CONCAT(a, b) VIPR_TRACE_CONCAT_INNER(a, b)
+
+#ifdef VIPR_ENABLE_TRACING
+#define VIPR_TRACE_ZONE(name) VIPR_Emulator::TraceZone VIPR_TRACE_CONCAT(trace_zone_, __LINE__)(name) // Name must be a string literal
+#define VIPR_TRACE_THREAD_NAME(name) VIPR_Emulator::Tracer::Get().SetThreadName(name)
+#else
+#define VIPR_TRACE_ZONE(name)
+#define VIPR_TRACE_THREAD_NAME(name)
+#endif
+
+#endif
@@ -0,0 +1,24 @@
+#ifndef _VIDEO_FRAME_HPP_
+#define _VIDEO_FRAME_HPP_
+
+#include <cstdint>
+#include <array>
+
+namespace VIPR_Emulator
+{
+	constexpr uint32_t clocks_per_frame = 262 * 14 * 8; // One CDP1861 frame (262 lines, 14 machine cycles per line, 8 clocks per machine cycle)
+
+	struct VideoFrame
+	{
+		std::array<uint8_t, (64 * 128) / 8> pixel_data; // 1bpp, 8 bytes per line
+		std::array<uint8_t, (64 * 128) / 8> color_data; // Per byte (Background Color = High Nibble, Dot Color = Low Nibble)
+		uint64_t frame_number;
+		uint64_t hash;
+	};
+
+	using FrameOutputCallback = void (*)(const VideoFrame &frame, void *userdata);
+
+	uint64_t HashVideoFrame(const VideoFrame &frame);
+}
+
+#endif
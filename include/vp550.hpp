@@ -0,0 +1,97 @@
+#ifndef _VP550_HPP_
+#define _VP550_HPP_
+
+#include "cdp1802.hpp"
+#include "cdp1863.hpp"
+#include "audio.hpp"
+#include "audio_engine.hpp"
+#include "blep_synth.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace VIPR_Emulator
+{
+	/*
+	VP-550 Super Sound Board (Two voices) / VP-551 Super Sound Board (Four voices)
+
+	Registers are written through memory writes to 0x8000-0xFFFF (including 0xC000-0xDFFF, which the VP-590 also sees), decoded
+	from the low address bits:
+		A0-A1: 1 = Voice A frequency (CDP1863 divide rate), 2 = Voice B frequency, 3 = Octave latch
+		A4-A5: 1 = Voice A amplitude (4-bit), 2 = Voice B amplitude, 3 = Sync interrupt enable (Bit 0)
+		A2: Selects voices C and D in place of A and B (VP-551 only)
+
+	Octave latch:
+		Bits 0-1: Clock 2 divider (CPU clock / 8, / 4, / 2, / 1)
+		Bits 2-3: Voice
+		Bit 4: Run the voice's CDP1863 from clock 2 instead of the CPU clock
+
+	All voices are gated by Q.
+	*/
+
+	class VP550 : public AudioSource // Like the other sound sources, register writes are queued as cycle-stamped events on the emulation thread
+	{
+		public:
+			VP550(CDP1802 *CPU, uint8_t voice_count);
+			~VP550();
+
+			void Render(BandLimitedSynth &synth, uint64_t frame_start_cycle, uint64_t frame_end_cycle) override;
+			void Silence(BandLimitedSynth &synth) override;
+
+			inline void SetVolume(uint8_t volume, uint64_t machine_cycle) override
+			{
+				PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::Volume, volume, 0 });
+			}
+
+			inline void GenerateTone(bool toggle, uint64_t machine_cycle)
+			{
+				PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::Tone, static_cast<uint8_t>(toggle), 0 });
+			}
+
+			inline void Reset(uint64_t machine_cycle)
+			{
+				GenerateTone(false, machine_cycle);
+				sync_enabled = false;
+			}
+
+			inline uint8_t GetVoiceCount() const
+			{
+				return static_cast<uint8_t>(Voices.size());
+			}
+
+			void Sync();
+			uint32_t GetQuietCycles(uint32_t machine_cycles) const; // Syncs before the next sync interrupt
+			void SkipCycles(uint32_t machine_cycles);
+
+			friend void VP550_memory_write(uint16_t address, uint8_t data, void *userdata);
+		private:
+			struct Voice
+			{
+				CDP1863 frequency_generator;
+				SquareWaveOscillator Oscillator;
+				uint32_t clock_divider; // CPU clocks per input clock of the CDP1863
+				uint8_t level; // 4-bit
+			};
+
+			CDP1802 *CPU;
+			std::vector<Voice> Voices;
+			std::vector<AudioEvent> PendingEvents; // Stamped with the machine cycle they happened on and applied in order while rendering
+			uint8_t volume;
+			bool sync_enabled;
+			uint32_t sync_period; // In machine cycles
+			uint32_t sync_cycles_left;
+
+			inline uint64_t GetHalfPeriod(const Voice &CurrentVoice) const // In 1/65536ths of a CPU clock
+			{
+				return static_cast<uint64_t>(CurrentVoice.frequency_generator.GetOutputHalfPeriod() * CurrentVoice.clock_divider) << 16;
+			}
+
+			inline int32_t GetAmplitude(const Voice &CurrentVoice) const // Four voice boards are mixed at half the level so all voices at full amplitude still fit
+			{
+				return (GetAudioAmplitude(volume) * CurrentVoice.level) / (15 * ((Voices.size() > 2) ? 2 : 1));
+			}
+	};
+
+	void VP550_memory_write(uint16_t address, uint8_t data, void *userdata);
+}
+
+#endif
@@ -4,13 +4,15 @@
 #include "cdp1802.hpp"
 #include "cdp1861.hpp"
 #include "cdp1862.hpp"
-#include "renderer.hpp"
+#include "display_output.hpp"
 #include <cstdint>
 #include <array>
 #include <cstring>
 
 namespace VIPR_Emulator
 {
+	using ColorVideoOutputCallback = void (*)(uint8_t value, uint8_t line, size_t address, uint8_t background_color, uint8_t dot_color, void *userdata);
+
 	class VP590 // VP-590 Color Board
 	{
 		public:
@@ -19,12 +21,11 @@ namespace VIPR_Emulator
 				Low, High
 			};
 
-			VP590(CDP1802 *CPU);
+			VP590(CDP1802 *CPU, ColorVideoOutputCallback video_output_func, void *video_output_userdata);
 			~VP590();
 
-			inline void AttachDisplayRenderer(Renderer *DisplayRenderer)
+			inline void AttachDisplayRenderer(DisplayOutput *DisplayRenderer)
 			{
-				this->DisplayRenderer = DisplayRenderer;
 				VDC.AttachDisplayRenderer(DisplayRenderer);
 			}
 
@@ -58,12 +59,19 @@ namespace VIPR_Emulator
 				color_generator.StepBackgroundColor();
 			}
 
+			inline uint8_t GetColorData(uint8_t location) const // One 4-bit location, as addressed in high resolution mode
+			{
+				return (color_data_RAM[location / 2] >> ((location % 2) * 4)) & 0xF;
+			}
+
 			inline ResolutionMode GetResolutionMode() const
 			{
 				return current_resolution_mode;
 			}
 
 			void Sync();
+			uint32_t GetQuietCycles(uint32_t machine_cycles) const;
+			void SkipCycles(uint32_t machine_cycles);
 
 			friend void VP590_video_output(uint8_t value, uint8_t line, size_t address, void *userdata);
 			friend void VP590_memory_write(uint16_t address, uint8_t data, void *userdata);
@@ -72,7 +80,8 @@ namespace VIPR_Emulator
 			CDP1862 color_generator;
 			ResolutionMode current_resolution_mode;
 			std::array<uint8_t, 128> color_data_RAM;
-			Renderer *DisplayRenderer;
+			void *video_output_userdata;
+			ColorVideoOutputCallback video_output_func;
 	};
 
 	void VP590_video_output(uint8_t value, uint8_t line, size_t address, void *userdata);
@@ -2,62 +2,55 @@
 #define _VP595_HPP_
 
 #include "cdp1863.hpp"
+#include "audio.hpp"
+#include "audio_engine.hpp"
+#include "blep_synth.hpp"
 #include <cstdint>
-#include <array>
-#include <string>
-#include <thread>
-#include <SDL.h>
+#include <vector>
 
 namespace VIPR_Emulator
 {
-	class VP595 // VP-595 Simple Sound Board
+	class VP595 : public AudioSource // VP-595 Simple Sound Board; like the tone generator, parameter changes are queued as cycle-stamped events on the emulation thread
 	{
 		public:
-			VP595(double input_frequency);
+			VP595(uint32_t clock_frequency);
 			~VP595();
 
-			void SetupVP595(std::string output_audio_device);
+			void Render(BandLimitedSynth &synth, uint64_t frame_start_cycle, uint64_t frame_end_cycle) override;
+			void Silence(BandLimitedSynth &synth) override;
 
-			inline void SetVolume(uint8_t volume)
+			inline void SetVolume(uint8_t volume, uint64_t machine_cycle) override
 			{
-				this->volume = static_cast<double>(volume) / 100.0;
+				PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::Volume, volume, 0 });
 			}
 
-			inline void SetFrequency(uint8_t value)
+			inline void SetFrequency(uint8_t value, uint64_t machine_cycle)
 			{
 				if (value == 0x00)
 				{
 					value = 0x80;
 				}
-				frequency_generator.SetDivideRate(value);
+				PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::DivideRate, value, 0 });
 			}
 
-			inline void GenerateTone(bool toggle)
+			inline void GenerateTone(bool toggle, uint64_t machine_cycle)
 			{
-				generate_tone = toggle;
+				PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::Tone, static_cast<uint8_t>(toggle), 0 });
 			}
 
-			inline void Reset()
+			inline void Reset(uint64_t machine_cycle)
 			{
-				frequency_generator.Reset();
+				PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::DivideRate, 53, 0 });
 			}
+		private:
+			CDP1863 frequency_generator;
+			SquareWaveOscillator Oscillator;
+			std::vector<AudioEvent> PendingEvents; // Stamped with the machine cycle they happened on and applied in order while rendering
 
-			inline void Pause(bool toggle)
+			inline uint64_t GetHalfPeriod() const // The board's oscillator is clocked from the CPU's machine cycles, so each input clock is 8 CPU clocks
 			{
-				pause = toggle;
+				return static_cast<uint64_t>(frequency_generator.GetOutputHalfPeriod() * 8) << 16;
 			}
-
-			static void AudioProcessor(VP595 *generator);
-		private:
-			SDL_AudioSpec spec;
-			SDL_AudioDeviceID device;
-			bool processing;
-			bool pause;
-			bool generate_tone;
-			double volume;
-			double current_period;
-			CDP1863 frequency_generator;
-			std::thread AudioProcessingThread;
 	};
 }
 
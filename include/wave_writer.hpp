@@ -0,0 +1,67 @@
+#ifndef _WAVE_WRITER_HPP_
+#define _WAVE_WRITER_HPP_
+
+#include "spsc_queue.hpp"
+#include <cstdint>
+#include <array>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <fstream>
+
+namespace VIPR_Emulator
+{
+	struct WaveAudioBlock
+	{
+		std::array<int16_t, 4096> samples;
+		uint32_t sample_count;
+	};
+
+	class WaveWriter // Dumps the mixed audio stream as 16-bit mono PCM; blocks come from a preallocated pool and are written by a background thread
+	{
+		public:
+			WaveWriter();
+			~WaveWriter();
+
+			bool Start(const std::string &audio_file, uint32_t sample_rate); // Files ending in '.raw' get headerless little endian samples instead of a WAV file
+			void Stop();
+
+			void SubmitAudio(const int *samples, size_t sample_count, int sample_rate);
+
+			inline void SetBlockWhenFull(bool toggle) // Only for offline runs (e.g. headless mode), where waiting on the writer is preferable to dropping audio
+			{
+				block_when_full = toggle;
+			}
+
+			inline bool IsRecording() const
+			{
+				return recording;
+			}
+
+			inline uint64_t GetDroppedBlocks() const
+			{
+				return dropped_blocks;
+			}
+
+			static void WriterProcessor(WaveWriter *writer);
+		private:
+			std::atomic<bool> recording;
+			std::atomic<bool> processing;
+			bool block_when_full;
+			bool raw;
+			uint32_t sample_rate;
+			uint64_t data_size; // Only touched by the writer thread while it's running
+			std::atomic<uint64_t> dropped_blocks;
+			std::ofstream audio_output;
+			std::array<uint8_t, sizeof(WaveAudioBlock::samples)> write_buffer;
+			SPSCQueue<WaveAudioBlock, 64> BlockPool;
+			std::thread WriterThread;
+
+			bool WritePendingBlocks();
+			void WriteHeader();
+	};
+
+	void WaveWriter_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata);
+}
+
+#endif
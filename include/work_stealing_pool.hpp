@@ -0,0 +1,42 @@
+#ifndef _WORK_STEALING_POOL_HPP_
+#define _WORK_STEALING_POOL_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <memory>
+
+namespace VIPR_Emulator
+{
+	using JobCallback = void (*)(size_t job, size_t worker, void *userdata);
+
+	class WorkStealingPool // Each worker takes jobs from the back of its own queue and steals from the front of the others once it runs dry
+	{
+		public:
+			WorkStealingPool(size_t worker_count); // 0 uses every hardware thread
+			~WorkStealingPool();
+
+			void Run(size_t job_count, JobCallback job_func, void *userdata); // Blocks until every job has run
+
+			inline size_t GetWorkerCount() const
+			{
+				return Queues.size();
+			}
+		private:
+			struct WorkerQueue
+			{
+				std::mutex lock; // Only contended while stealing
+				std::deque<size_t> jobs;
+			};
+
+			std::vector<std::unique_ptr<WorkerQueue>> Queues;
+
+			bool PopJob(size_t worker, size_t &job);
+			bool StealJob(size_t worker, size_t &job);
+			static void WorkerProcessor(WorkStealingPool *pool, size_t worker, JobCallback job_func, void *userdata);
+	};
+}
+
+#endif
@@ -0,0 +1,12 @@
+#ifndef _XXHASH_HPP_
+#define _XXHASH_HPP_
+
+#include <cstdint>
+#include <cstddef>
+
+namespace VIPR_Emulator
+{
+	uint64_t XXHash64(const void *data, size_t size, uint64_t seed = 0); // Standard XXH64, output matches the reference implementation.
+}
+
+#endif
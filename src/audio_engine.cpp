@@ -0,0 +1,60 @@
+#include "audio_engine.hpp"
+#include "trace.hpp"
+#include <algorithm>
+
+VIPR_Emulator::AudioEngine::AudioEngine() : Mixer(1760900, audio_sample_rate), rendered_machine_cycle(0), clock_synced(false), gain(32768), audio_output_func(nullptr), audio_output_userdata(nullptr) // Mixes at the COSMAC VIP's clock until a machine sets its own
+{
+	Sources.reserve(8);
+}
+
+VIPR_Emulator::AudioEngine::~AudioEngine()
+{
+}
+
+void VIPR_Emulator::AudioEngine::SetClockFrequency(uint32_t clock_frequency)
+{
+	Mixer = BandLimitedSynth(clock_frequency, audio_sample_rate);
+	clock_synced = false;
+}
+
+void VIPR_Emulator::AudioEngine::AttachSource(AudioSource *source)
+{
+	if (std::find(Sources.begin(), Sources.end(), source) == Sources.end())
+	{
+		Sources.push_back(source);
+	}
+}
+
+void VIPR_Emulator::AudioEngine::DetachSource(AudioSource *source)
+{
+	std::vector<AudioSource *>::iterator current_source = std::find(Sources.begin(), Sources.end(), source);
+	if (current_source != Sources.end())
+	{
+		source->Silence(Mixer);
+		Sources.erase(current_source);
+	}
+}
+
+void VIPR_Emulator::AudioEngine::Render(uint64_t machine_cycle_count)
+{
+	VIPR_TRACE_ZONE("AudioEngine::Render");
+	if (!clock_synced || machine_cycle_count < rendered_machine_cycle)
+	{
+		rendered_machine_cycle = machine_cycle_count;
+		clock_synced = true;
+	}
+	for (AudioSource *source : Sources)
+	{
+		source->Render(Mixer, rendered_machine_cycle, machine_cycle_count);
+	}
+	Mixer.EndFrame(static_cast<uint32_t>((machine_cycle_count - rendered_machine_cycle) * 8));
+	rendered_machine_cycle = machine_cycle_count;
+	while (Mixer.GetSamplesAvailable() > 0)
+	{
+		size_t sample_count = Mixer.ReadSamples(sample_buffer.data(), sample_buffer.size(), gain);
+		if (audio_output_func != nullptr)
+		{
+			audio_output_func(sample_buffer.data(), sample_count, audio_sample_rate, audio_output_userdata);
+		}
+	}
+}
@@ -0,0 +1,225 @@
+#include "audio_stream.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <fmt/core.h>
+
+VIPR_Emulator::AudioStream::AudioStream() : device(0), pause(false), fade_out_request(false), fade_out_complete(false), buffering(true), fade_in_position(0), fade_out_position(0), target_fill(0), max_fill(0), underruns(0), overruns(0), samples_written(0), samples_requested(0), callbacks(0), callback_duration {}, callback_interval {}, last_callback_counter(0), last_samples_written(0), last_samples_requested(0)
+{
+}
+
+VIPR_Emulator::AudioStream::~AudioStream()
+{
+	Close();
+}
+
+bool VIPR_Emulator::AudioStream::Open(const std::string &output_audio_device, uint16_t latency)
+{
+	latency = std::clamp(latency, audio_latency_min, audio_latency_max);
+	size_t latency_samples = (static_cast<size_t>(audio_sample_rate) * latency) / 1000;
+	uint16_t device_samples = 64;
+	while (device_samples < 8192 && device_samples * 4 <= latency_samples) // Keep the device buffer at a quarter to half of the requested latency
+	{
+		device_samples <<= 1;
+	}
+	SDL_AudioSpec desired;
+	SDL_zero(desired);
+	desired.freq = audio_sample_rate;
+	desired.channels = 1;
+	desired.samples = device_samples;
+	desired.format = AUDIO_S32;
+	desired.callback = AudioStream::AudioCallback;
+	desired.userdata = this;
+	SDL_AudioSpec obtained;
+	SDL_AudioDeviceID new_device = SDL_OpenAudioDevice(output_audio_device.empty() ? nullptr : output_audio_device.c_str(), 0, &desired, &obtained, 0); // Opened paused, so its callback can't run alongside the current device's
+	if (new_device == 0)
+	{
+		return false; // The current device, if any, keeps playing
+	}
+	CloseDevice();
+	spec = obtained;
+	target_fill = std::max<size_t>(latency_samples - std::min<size_t>(latency_samples, device_samples), device_samples);
+	max_fill = std::min((target_fill * 2) + device_samples, SampleRing.GetCapacity());
+	buffering = true;
+	device = new_device;
+	SDL_PauseAudioDevice(device, 0);
+	return true;
+}
+
+void VIPR_Emulator::AudioStream::Close()
+{
+	CloseDevice();
+	std::array<int, 1024> discard;
+	while (SampleRing.Read(discard.data(), discard.size()) > 0) // The callback is stopped, so the ring can be drained from here
+	{
+	}
+}
+
+void VIPR_Emulator::AudioStream::CloseDevice() // Fades the device out before closing it so switching devices doesn't click
+{
+	if (device == 0)
+	{
+		return;
+	}
+	if (!pause && SDL_GetAudioDeviceStatus(device) == SDL_AUDIO_PLAYING) // A removed device no longer runs its callback, so there's nothing to wait for
+	{
+		fade_out_request = true;
+		Uint32 timeout = SDL_GetTicks() + ((static_cast<Uint32>(spec.samples) * 2000) / static_cast<Uint32>(audio_sample_rate)) + 10; // Two device buffers
+		while (!fade_out_complete && !SDL_TICKS_PASSED(SDL_GetTicks(), timeout))
+		{
+			SDL_Delay(1);
+		}
+	}
+	SDL_PauseAudioDevice(device, 1);
+	SDL_CloseAudioDevice(device);
+	device = 0;
+	fade_out_request = false;
+	fade_out_complete = false;
+	fade_out_position = 0;
+	last_callback_counter = 0; // The gap to the next device's first callback isn't a callback interval
+}
+
+size_t VIPR_Emulator::AudioStream::Write(const int *samples, size_t sample_count)
+{
+	samples_written += sample_count;
+	size_t free_space = max_fill - std::min(max_fill, SampleRing.Size());
+	if (sample_count > free_space) // The emulation is running ahead of the device; drop samples rather than letting latency grow
+	{
+		++overruns;
+		sample_count = free_space;
+	}
+	return SampleRing.Write(samples, sample_count);
+}
+
+void VIPR_Emulator::AudioStream::AudioCallback(void *userdata, Uint8 *stream, int len)
+{
+	VIPR_TRACE_THREAD_NAME("Audio Callback");
+	VIPR_TRACE_ZONE("AudioStream::AudioCallback");
+	AudioStream *audio_stream = static_cast<AudioStream *>(userdata);
+	Uint64 callback_start = SDL_GetPerformanceCounter();
+	if (audio_stream->last_callback_counter != 0)
+	{
+		AddToHistogram(audio_stream->callback_interval, callback_start - audio_stream->last_callback_counter);
+	}
+	audio_stream->last_callback_counter = callback_start;
+	int *output = reinterpret_cast<int *>(stream);
+	size_t sample_count = static_cast<size_t>(len) / sizeof(int);
+	size_t samples_read = 0;
+	bool paused = audio_stream->pause;
+	bool fade_out = audio_stream->fade_out_request;
+	size_t playable_samples = fade_out ? std::min(sample_count, fade_samples - audio_stream->fade_out_position) : sample_count; // Once faded out, stop reading so the next device picks up where this one left off
+	if (paused)
+	{
+		audio_stream->SampleRing.Discard();
+		audio_stream->buffering = true;
+	}
+	else
+	{
+		audio_stream->samples_requested += sample_count;
+	}
+	if (!paused && playable_samples > 0 && (!audio_stream->buffering || audio_stream->SampleRing.Size() >= audio_stream->target_fill))
+	{
+		if (audio_stream->buffering)
+		{
+			audio_stream->buffering = false;
+			audio_stream->fade_in_position = 0; // Whatever was playing before stopped abruptly, so start from silence
+		}
+		samples_read = audio_stream->SampleRing.Read(output, playable_samples);
+		if (samples_read < playable_samples) // Refill up to the target latency before playing again instead of stuttering on every callback
+		{
+			audio_stream->buffering = true;
+			++audio_stream->underruns;
+		}
+	}
+	std::fill(output + samples_read, output + sample_count, 0);
+	for (size_t i = 0; i < samples_read && audio_stream->fade_in_position < fade_samples; ++i, ++audio_stream->fade_in_position)
+	{
+		output[i] = static_cast<int>((static_cast<int64_t>(output[i]) * static_cast<int64_t>(audio_stream->fade_in_position)) / static_cast<int64_t>(fade_samples));
+	}
+	if (fade_out)
+	{
+		for (size_t i = 0; i < samples_read; ++i, ++audio_stream->fade_out_position)
+		{
+			output[i] = static_cast<int>((static_cast<int64_t>(output[i]) * static_cast<int64_t>(fade_samples - audio_stream->fade_out_position)) / static_cast<int64_t>(fade_samples));
+		}
+		if (audio_stream->fade_out_position >= fade_samples || samples_read < playable_samples) // Nothing left to fade if the ring ran dry
+		{
+			audio_stream->fade_out_complete = true;
+		}
+	}
+	++audio_stream->callbacks;
+	AddToHistogram(audio_stream->callback_duration, SDL_GetPerformanceCounter() - callback_start);
+}
+
+void VIPR_Emulator::AudioStream::AddToHistogram(std::array<std::atomic<uint64_t>, AudioStats::histogram_buckets> &histogram, Uint64 counter_ticks)
+{
+	uint64_t microseconds = (counter_ticks * 1000000) / SDL_GetPerformanceFrequency();
+	size_t bucket = std::min<size_t>(std::bit_width(microseconds), histogram.size() - 1);
+	histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+}
+
+VIPR_Emulator::AudioStats VIPR_Emulator::AudioStream::GetStats()
+{
+	AudioStats stats;
+	constexpr double samples_per_ms = audio_sample_rate / 1000.0;
+	stats.queued_ms = SampleRing.Size() / samples_per_ms;
+	stats.target_ms = target_fill / samples_per_ms;
+	stats.device_ms = (device != 0) ? spec.samples / samples_per_ms : 0.0;
+	uint64_t current_samples_written = samples_written;
+	uint64_t current_samples_requested = samples_requested;
+	uint64_t written_delta = current_samples_written - last_samples_written;
+	uint64_t requested_delta = current_samples_requested - last_samples_requested;
+	stats.resample_ratio = (written_delta > 0) ? static_cast<double>(requested_delta) / static_cast<double>(written_delta) : 0.0;
+	last_samples_written = current_samples_written;
+	last_samples_requested = current_samples_requested;
+	stats.underruns = underruns;
+	stats.overruns = overruns;
+	stats.callbacks = callbacks;
+	for (size_t i = 0; i < AudioStats::histogram_buckets; ++i)
+	{
+		stats.callback_duration[i] = callback_duration[i].load(std::memory_order_relaxed);
+		stats.callback_interval[i] = callback_interval[i].load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+uint64_t VIPR_Emulator::AudioStats::GetPercentile(const Histogram &histogram, double fraction)
+{
+	uint64_t total = 0;
+	for (uint64_t count : histogram)
+	{
+		total += count;
+	}
+	uint64_t rank = static_cast<uint64_t>(total * fraction);
+	uint64_t seen = 0;
+	for (size_t i = 0; i < histogram.size(); ++i)
+	{
+		seen += histogram[i];
+		if (seen > rank)
+		{
+			return uint64_t(1) << i;
+		}
+	}
+	return 0;
+}
+
+std::string VIPR_Emulator::FormatAudioStats(const AudioStats &stats)
+{
+	auto format_histogram = [](const AudioStats::Histogram &histogram)
+	{
+		std::string buckets;
+		for (size_t i = 0; i < histogram.size(); ++i)
+		{
+			buckets += fmt::format("{}{}", (i > 0) ? ", " : "", histogram[i]);
+		}
+		return buckets;
+	};
+	std::string bucket_limits; // Exclusive upper bounds; the last bucket has none
+	for (size_t i = 0; i + 1 < AudioStats::histogram_buckets; ++i)
+	{
+		bucket_limits += fmt::format("{}{}", (i > 0) ? ", " : "", uint64_t(1) << i);
+	}
+	return fmt::format("{{\n\t\"sample_rate\": {},\n\t\"queued_ms\": {:.3f},\n\t\"target_ms\": {:.3f},\n\t\"device_ms\": {:.3f},\n\t\"resample_ratio\": {:.6f},\n\t\"underruns\": {},\n\t\"overruns\": {},\n\t\"callbacks\": {},\n\t\"bucket_limits_us\": [{}],\n\t\"callback_duration_us\": [{}],\n\t\"callback_interval_us\": [{}]\n}}\n",
+		audio_sample_rate, stats.queued_ms, stats.target_ms, stats.device_ms, stats.resample_ratio, stats.underruns, stats.overruns, stats.callbacks, bucket_limits, format_histogram(stats.callback_duration), format_histogram(stats.callback_interval));
+}
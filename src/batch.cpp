@@ -0,0 +1,321 @@
+#include "headless.hpp"
+#include "work_stealing_pool.hpp"
+#include "xxhash.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <filesystem>
+#include <fmt/core.h>
+
+namespace
+{
+	enum class BatchStatus
+	{
+		Ran, Passed, Failed, Updated, Error
+	};
+
+	constexpr std::array<const char *, 5> batch_status_names = { "ran", "passed", "failed", "updated", "error" };
+
+	struct BatchOptions
+	{
+		std::filesystem::path directory;
+		size_t worker_count;
+		uint32_t frame_count;
+		uint8_t ram_kb;
+		bool update_golden;
+		std::string json_file;
+		std::string csv_file;
+		std::array<bool, 5> ExpansionBoard;
+	};
+
+	struct BatchJob // A ROM, plus '<name>.script' and '<name>.golden' next to it if they exist
+	{
+		std::filesystem::path rom_file;
+		std::filesystem::path script_file;
+		std::filesystem::path golden_file;
+	};
+
+	struct BatchResult
+	{
+		BatchStatus status;
+		uint32_t frame_count;
+		uint64_t final_frame_hash;
+		uint64_t ram_hash;
+		uint64_t audio_hash;
+		uint64_t audio_sample_count;
+		uint64_t machine_cycles;
+		size_t mismatches;
+		double elapsed_ms;
+	};
+
+	struct BatchRun
+	{
+		const BatchOptions *options;
+		const std::vector<BatchJob> *Jobs;
+		std::vector<BatchResult> *Results; // Each job only writes its own entry, so workers never share one
+	};
+
+	void batch_job(size_t job, size_t, void *userdata)
+	{
+		BatchRun *run = static_cast<BatchRun *>(userdata);
+		const BatchOptions &options = *run->options;
+		const BatchJob &CurrentJob = (*run->Jobs)[job];
+		BatchResult &result = (*run->Results)[job];
+		std::chrono::steady_clock::time_point start_tp = std::chrono::steady_clock::now();
+		result = BatchResult { BatchStatus::Error, options.frame_count, 0, 0, 0, 0, 0, 0, 0.0 };
+		VIPR_Emulator::MappedFile ROMImage;
+		std::vector<VIPR_Emulator::ScriptEvent> events;
+		if (!VIPR_Emulator::LoadROMFile(CurrentJob.rom_file.string(), ROMImage))
+		{
+			return;
+		}
+		if (!CurrentJob.script_file.empty())
+		{
+			if (!VIPR_Emulator::LoadInputScript(CurrentJob.script_file.string(), events))
+			{
+				return;
+			}
+		}
+		else
+		{
+			events.push_back(VIPR_Emulator::ScriptEvent { 0, VIPR_Emulator::ScriptEventType::Run, 0x0, 0 });
+		}
+		VIPR_Emulator::AudioEngine SoundEngine;
+		VIPR_Emulator::COSMAC_VIP System;
+		if (System.Fail())
+		{
+			return;
+		}
+		VIPR_Emulator::SetupHeadlessMachine(System, options.ram_kb, options.ExpansionBoard, std::move(ROMImage));
+		VIPR_Emulator::HeadlessAudioOutput AudioOutput { 0, 0, nullptr, nullptr };
+		SoundEngine.SetAudioOutput(VIPR_Emulator::headless_audio_output, &AudioOutput);
+		System.AttachAudioEngine(&SoundEngine);
+		VIPR_Emulator::HeadlessRunner Runner(System);
+		std::vector<uint64_t> frame_hashes;
+		Runner.Run(events, options.frame_count, frame_hashes);
+		result.final_frame_hash = (frame_hashes.size() > 0) ? frame_hashes.back() : 0;
+		result.ram_hash = VIPR_Emulator::XXHash64(System.GetRAMData(), System.GetRAM());
+		result.audio_hash = AudioOutput.hash;
+		result.audio_sample_count = AudioOutput.sample_count;
+		result.machine_cycles = System.GetMachineCycleCount();
+		result.status = BatchStatus::Ran;
+		if (!CurrentJob.golden_file.empty())
+		{
+			if (options.update_golden)
+			{
+				result.status = VIPR_Emulator::SaveGoldenFile(CurrentJob.golden_file.string(), frame_hashes) ? BatchStatus::Updated : BatchStatus::Error;
+			}
+			else
+			{
+				std::vector<uint64_t> golden_hashes;
+				if (VIPR_Emulator::LoadGoldenFile(CurrentJob.golden_file.string(), golden_hashes))
+				{
+					result.mismatches = VIPR_Emulator::CompareGoldenFrames(golden_hashes, frame_hashes, false);
+					result.status = (result.mismatches == 0) ? BatchStatus::Passed : BatchStatus::Failed;
+				}
+				else
+				{
+					result.status = BatchStatus::Error;
+				}
+			}
+		}
+		result.elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_tp).count();
+	}
+
+	bool ParseBatchArguments(int argc, char *argv[], BatchOptions &options)
+	{
+		options = BatchOptions { "", 0, 600, 2, false, "", "", { false, false, false, false, false } };
+		for (int i = 1; i < argc; ++i)
+		{
+			std::string argument = argv[i];
+			bool has_value = (i + 1 < argc);
+			if (argument == "--update-golden")
+			{
+				options.update_golden = true;
+			}
+			else if (argument == "--jobs" && has_value)
+			{
+				options.worker_count = std::strtoul(argv[++i], nullptr, 10);
+			}
+			else if (argument == "--frames" && has_value)
+			{
+				options.frame_count = std::strtoul(argv[++i], nullptr, 10);
+			}
+			else if (argument == "--ram" && has_value)
+			{
+				int ram_kb = std::atoi(argv[++i]);
+				options.ram_kb = std::clamp(ram_kb, 1, 32);
+			}
+			else if (argument == "--board" && has_value)
+			{
+				if (!VIPR_Emulator::ParseExpansionBoard(argv[++i], options.ExpansionBoard))
+				{
+					return false;
+				}
+			}
+			else if (argument == "--json" && has_value)
+			{
+				options.json_file = argv[++i];
+			}
+			else if (argument == "--csv" && has_value)
+			{
+				options.csv_file = argv[++i];
+			}
+			else if (options.directory.empty() && argument.size() > 0 && argument[0] != '-')
+			{
+				options.directory = argument;
+			}
+			else
+			{
+				fmt::print("Unknown or incomplete argument '{}'.\n", argument);
+				return false;
+			}
+		}
+		if (options.directory.empty())
+		{
+			fmt::print("Usage: vipr_batch <directory> [--jobs <count>] [--frames <count>] [--ram <KB>] [--board vp585|vp590|vp595|vp550|vp551] [--update-golden] [--json <file>] [--csv <file>]\n");
+			return false;
+		}
+		return true;
+	}
+
+	bool FindBatchJobs(const std::filesystem::path &directory, bool update_golden, std::vector<BatchJob> &Jobs)
+	{
+		std::error_code error;
+		std::filesystem::recursive_directory_iterator current_entry(directory, error);
+		if (error)
+		{
+			fmt::print("Unable to read directory '{}'.\n", directory.string());
+			return false;
+		}
+		for (; current_entry != std::filesystem::recursive_directory_iterator(); current_entry.increment(error))
+		{
+			const std::filesystem::path &current_path = current_entry->path();
+			if (!current_entry->is_regular_file() || (current_path.extension() != ".rom" && current_path.extension() != ".bin"))
+			{
+				continue;
+			}
+			BatchJob CurrentJob { current_path, std::filesystem::path(current_path).replace_extension(".script"), std::filesystem::path(current_path).replace_extension(".golden") };
+			if (!std::filesystem::exists(CurrentJob.script_file))
+			{
+				CurrentJob.script_file.clear();
+			}
+			if (!update_golden && !std::filesystem::exists(CurrentJob.golden_file)) // Updating writes a golden file for every ROM
+			{
+				CurrentJob.golden_file.clear();
+			}
+			Jobs.push_back(CurrentJob);
+		}
+		std::sort(Jobs.begin(), Jobs.end(), [](const BatchJob &a, const BatchJob &b) { return a.rom_file < b.rom_file; }); // Reports come out in the same order no matter how the directory is listed
+		return true;
+	}
+
+	std::string EscapeJSON(const std::string &text)
+	{
+		std::string escaped;
+		escaped.reserve(text.size());
+		for (char current_character : text)
+		{
+			if (current_character == '"' || current_character == '\\')
+			{
+				escaped += '\\';
+			}
+			escaped += current_character;
+		}
+		return escaped;
+	}
+
+	std::string EscapeCSV(const std::string &text)
+	{
+		std::string escaped = "\"";
+		for (char current_character : text)
+		{
+			if (current_character == '"')
+			{
+				escaped += '"';
+			}
+			escaped += current_character;
+		}
+		return escaped + "\"";
+	}
+
+	bool WriteJSONSummary(const std::string &json_file, const std::vector<BatchJob> &Jobs, const std::vector<BatchResult> &Results, size_t worker_count, double elapsed_ms)
+	{
+		std::ofstream json_output(json_file, std::ios::trunc);
+		if (json_output.fail())
+		{
+			fmt::print("Unable to create JSON summary '{}'.\n", json_file);
+			return false;
+		}
+		json_output << fmt::format("{{\n\t\"jobs\": {},\n\t\"workers\": {},\n\t\"elapsed_ms\": {:.3f},\n\t\"results\": [", Jobs.size(), worker_count, elapsed_ms);
+		for (size_t i = 0; i < Jobs.size(); ++i)
+		{
+			const BatchResult &result = Results[i];
+			json_output << fmt::format("{}\n\t\t{{ \"rom\": \"{}\", \"script\": \"{}\", \"golden\": \"{}\", \"status\": \"{}\", \"frames\": {}, \"final_frame_hash\": \"{:016x}\", \"ram_hash\": \"{:016x}\", \"audio_hash\": \"{:016x}\", \"audio_samples\": {}, \"machine_cycles\": {}, \"mismatched_frames\": {}, \"elapsed_ms\": {:.3f} }}",
+				(i > 0) ? "," : "", EscapeJSON(Jobs[i].rom_file.string()), EscapeJSON(Jobs[i].script_file.string()), EscapeJSON(Jobs[i].golden_file.string()), batch_status_names[static_cast<size_t>(result.status)], result.frame_count, result.final_frame_hash, result.ram_hash, result.audio_hash, result.audio_sample_count, result.machine_cycles, result.mismatches, result.elapsed_ms);
+		}
+		json_output << "\n\t]\n}\n";
+		return true;
+	}
+
+	bool WriteCSVSummary(const std::string &csv_file, const std::vector<BatchJob> &Jobs, const std::vector<BatchResult> &Results)
+	{
+		std::ofstream csv_output(csv_file, std::ios::trunc);
+		if (csv_output.fail())
+		{
+			fmt::print("Unable to create CSV summary '{}'.\n", csv_file);
+			return false;
+		}
+		csv_output << "rom,script,golden,status,frames,final_frame_hash,ram_hash,audio_hash,audio_samples,machine_cycles,mismatched_frames,elapsed_ms\n";
+		for (size_t i = 0; i < Jobs.size(); ++i)
+		{
+			const BatchResult &result = Results[i];
+			csv_output << fmt::format("{},{},{},{},{},{:016x},{:016x},{:016x},{},{},{},{:.3f}\n", EscapeCSV(Jobs[i].rom_file.string()), EscapeCSV(Jobs[i].script_file.string()), EscapeCSV(Jobs[i].golden_file.string()), batch_status_names[static_cast<size_t>(result.status)], result.frame_count, result.final_frame_hash, result.ram_hash, result.audio_hash, result.audio_sample_count, result.machine_cycles, result.mismatches, result.elapsed_ms);
+		}
+		return true;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	BatchOptions options;
+	if (!ParseBatchArguments(argc, argv, options))
+	{
+		return -1;
+	}
+	std::vector<BatchJob> Jobs;
+	if (!FindBatchJobs(options.directory, options.update_golden, Jobs))
+	{
+		return -1;
+	}
+	std::vector<BatchResult> Results(Jobs.size());
+	VIPR_Emulator::WorkStealingPool Pool(options.worker_count);
+	BatchRun run { &options, &Jobs, &Results };
+	std::chrono::steady_clock::time_point start_tp = std::chrono::steady_clock::now();
+	Pool.Run(Jobs.size(), batch_job, &run);
+	double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_tp).count();
+	std::array<size_t, 5> status_count = { 0, 0, 0, 0, 0 };
+	for (size_t i = 0; i < Jobs.size(); ++i)
+	{
+		++status_count[static_cast<size_t>(Results[i].status)];
+		if (Results[i].status == BatchStatus::Failed || Results[i].status == BatchStatus::Error)
+		{
+			fmt::print("{}: {} ({} mismatched frames)\n", Jobs[i].rom_file.string(), batch_status_names[static_cast<size_t>(Results[i].status)], Results[i].mismatches);
+		}
+	}
+	fmt::print("{} jobs on {} workers in {:.1f} ms: {} passed, {} failed, {} ran without a golden file, {} golden files updated, {} errors.\n", Jobs.size(), Pool.GetWorkerCount(), elapsed_ms, status_count[static_cast<size_t>(BatchStatus::Passed)], status_count[static_cast<size_t>(BatchStatus::Failed)], status_count[static_cast<size_t>(BatchStatus::Ran)], status_count[static_cast<size_t>(BatchStatus::Updated)], status_count[static_cast<size_t>(BatchStatus::Error)]);
+	if (options.json_file.size() > 0 && !WriteJSONSummary(options.json_file, Jobs, Results, Pool.GetWorkerCount(), elapsed_ms))
+	{
+		return -1;
+	}
+	if (options.csv_file.size() > 0 && !WriteCSVSummary(options.csv_file, Jobs, Results))
+	{
+		return -1;
+	}
+	return (status_count[static_cast<size_t>(BatchStatus::Failed)] == 0 && status_count[static_cast<size_t>(BatchStatus::Error)] == 0) ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+#include "blep_synth.hpp"
+#include <algorithm>
+
+namespace
+{
+	// Kaiser-windowed (beta = 7) sinc impulse with a cutoff of 0.45 times the sample rate, in 32 sub-sample phases.
+	// Each row is quantized to sum to exactly 32768, so integrating a delta always settles on the exact new level.
+	constexpr std::array<std::array<int16_t, VIPR_Emulator::BandLimitedSynth::kernel_width>, VIPR_Emulator::BandLimitedSynth::kernel_phases> blep_kernel = {{
+		{ 48, -192, 511, -1047, 1755, -2496, 3063, 29489, 3063, -2496, 1755, -1047, 511, -192, 48, -5 },
+		{ 49, -191, 496, -990, 1603, -2135, 2145, 29445, 4021, -2852, 1900, -1097, 523, -192, 47, -4 },
+		{ 49, -187, 478, -928, 1443, -1773, 1270, 29325, 5015, -3200, 2034, -1139, 530, -190, 45, -4 },
+		{ 48, -183, 456, -861, 1278, -1412, 440, 29129, 6042, -3538, 2157, -1174, 533, -186, 43, -4 },
+		{ 47, -177, 432, -790, 1110, -1056, -341, 28853, 7097, -3862, 2268, -1201, 532, -180, 39, -3 },
+		{ 46, -170, 405, -716, 940, -706, -1073, 28502, 8178, -4169, 2363, -1219, 526, -173, 36, -2 },
+		{ 44, -162, 376, -639, 768, -365, -1752, 28077, 9278, -4455, 2443, -1226, 514, -163, 31, -1 },
+		{ 42, -152, 346, -560, 598, -36, -2378, 27575, 10395, -4718, 2506, -1224, 498, -150, 26, 0 },
+		{ 40, -143, 314, -480, 429, 280, -2949, 27007, 11523, -4954, 2550, -1211, 477, -136, 20, 1 },
+		{ 38, -132, 281, -400, 264, 581, -3464, 26369, 12657, -5160, 2575, -1188, 450, -119, 13, 3 },
+		{ 35, -121, 248, -320, 104, 864, -3924, 25671, 13792, -5333, 2579, -1153, 418, -101, 5, 4 },
+		{ 32, -110, 214, -241, -51, 1129, -4328, 24912, 14923, -5471, 2562, -1107, 381, -80, -3, 6 },
+		{ 30, -98, 181, -163, -199, 1374, -4676, 24092, 16045, -5569, 2523, -1049, 338, -57, -12, 8 },
+		{ 27, -87, 147, -88, -339, 1597, -4968, 23223, 17154, -5626, 2461, -980, 290, -33, -21, 11 },
+		{ 24, -75, 115, -16, -471, 1799, -5206, 22305, 18243, -5639, 2375, -900, 238, -6, -31, 13 },
+		{ 21, -64, 83, 54, -594, 1978, -5391, 21344, 19307, -5605, 2266, -809, 181, 22, -41, 16 },
+		{ 18, -52, 52, 119, -706, 2134, -5523, 20341, 20343, -5523, 2134, -706, 119, 52, -52, 18 },
+		{ 16, -41, 22, 181, -809, 2266, -5605, 19307, 21344, -5391, 1978, -594, 54, 83, -64, 21 },
+		{ 13, -31, -6, 238, -900, 2375, -5639, 18243, 22305, -5206, 1799, -471, -16, 115, -75, 24 },
+		{ 11, -21, -33, 290, -980, 2461, -5626, 17154, 23223, -4968, 1597, -339, -88, 147, -87, 27 },
+		{ 8, -12, -57, 338, -1049, 2523, -5569, 16045, 24092, -4676, 1374, -199, -163, 181, -98, 30 },
+		{ 6, -3, -80, 381, -1107, 2562, -5471, 14923, 24912, -4328, 1129, -51, -241, 214, -110, 32 },
+		{ 4, 5, -101, 418, -1153, 2579, -5333, 13792, 25671, -3924, 864, 104, -320, 248, -121, 35 },
+		{ 3, 13, -119, 450, -1188, 2575, -5160, 12657, 26369, -3464, 581, 264, -400, 281, -132, 38 },
+		{ 1, 20, -136, 477, -1211, 2550, -4954, 11523, 27007, -2949, 280, 429, -480, 314, -143, 40 },
+		{ 0, 26, -150, 498, -1224, 2506, -4718, 10395, 27575, -2378, -36, 598, -560, 346, -152, 42 },
+		{ -1, 31, -163, 514, -1226, 2443, -4455, 9278, 28077, -1752, -365, 768, -639, 376, -162, 44 },
+		{ -2, 36, -173, 526, -1219, 2363, -4169, 8178, 28502, -1073, -706, 940, -716, 405, -170, 46 },
+		{ -3, 39, -180, 532, -1201, 2268, -3862, 7097, 28853, -341, -1056, 1110, -790, 432, -177, 47 },
+		{ -4, 43, -186, 533, -1174, 2157, -3538, 6042, 29129, 440, -1412, 1278, -861, 456, -183, 48 },
+		{ -4, 45, -190, 530, -1139, 2034, -3200, 5015, 29325, 1270, -1773, 1443, -928, 478, -187, 49 },
+		{ -4, 47, -192, 523, -1097, 1900, -2852, 4021, 29445, 2145, -2135, 1603, -990, 496, -191, 49 }
+	}};
+}
+
+VIPR_Emulator::BandLimitedSynth::BandLimitedSynth(uint32_t clock_frequency, uint32_t sample_rate) : clock_frequency(clock_frequency), sample_rate(sample_rate), frame_remainder(0), samples_available(0), integrator(0)
+{
+	delta_buffer.resize(4096 + kernel_width, 0);
+}
+
+VIPR_Emulator::BandLimitedSynth::~BandLimitedSynth()
+{
+}
+
+void VIPR_Emulator::BandLimitedSynth::AddDelta(uint32_t clock_time, int32_t delta)
+{
+	uint64_t position = ((frame_remainder + (static_cast<uint64_t>(clock_time) * sample_rate)) * kernel_phases) / clock_frequency;
+	size_t index = samples_available + static_cast<size_t>(position / kernel_phases);
+	if (index + kernel_width > delta_buffer.size())
+	{
+		delta_buffer.resize(index + kernel_width + 4096, 0);
+	}
+	const std::array<int16_t, kernel_width> &kernel = blep_kernel[position % kernel_phases];
+	int64_t *current_delta = &delta_buffer[index];
+	for (size_t i = 0; i < kernel_width; ++i)
+	{
+		current_delta[i] += static_cast<int64_t>(delta) * kernel[i];
+	}
+}
+
+void VIPR_Emulator::BandLimitedSynth::EndFrame(uint32_t clocks)
+{
+	uint64_t total = frame_remainder + (static_cast<uint64_t>(clocks) * sample_rate);
+	samples_available += static_cast<size_t>(total / clock_frequency);
+	frame_remainder = total % clock_frequency;
+	if (samples_available + kernel_width > delta_buffer.size())
+	{
+		delta_buffer.resize(samples_available + kernel_width + 4096, 0);
+	}
+}
+
+size_t VIPR_Emulator::BandLimitedSynth::ReadSamples(int *output, size_t sample_count, int32_t gain)
+{
+	sample_count = std::min(sample_count, samples_available);
+	for (size_t i = 0; i < sample_count; ++i)
+	{
+		integrator += delta_buffer[i];
+		int64_t value = std::clamp<int64_t>(integrator >> 15, INT16_MIN, INT16_MAX);
+		output[i] = static_cast<int>(value * gain);
+	}
+	size_t remaining = (samples_available - sample_count) + kernel_width; // Unread samples plus the tails of impulses that extend past them
+	std::copy(delta_buffer.begin() + sample_count, delta_buffer.begin() + sample_count + remaining, delta_buffer.begin());
+	std::fill(delta_buffer.begin() + remaining, delta_buffer.begin() + sample_count + remaining, 0);
+	samples_available -= sample_count;
+	return sample_count;
+}
+
+void VIPR_Emulator::BandLimitedSynth::Clear()
+{
+	std::fill(delta_buffer.begin(), delta_buffer.end(), 0);
+	samples_available = 0;
+	frame_remainder = 0;
+	integrator = 0;
+}
+
+VIPR_Emulator::SquareWaveOscillator::SquareWaveOscillator(uint64_t half_period, int32_t amplitude) : half_period(std::max<uint64_t>(half_period, 1 << 16)), next_toggle(this->half_period), high(true), gate(false), amplitude(amplitude), level(0)
+{
+}
+
+VIPR_Emulator::SquareWaveOscillator::~SquareWaveOscillator()
+{
+}
+
+void VIPR_Emulator::SquareWaveOscillator::Run(BandLimitedSynth &synth, uint64_t time)
+{
+	for (; next_toggle <= time; next_toggle += half_period)
+	{
+		high = !high;
+		if (gate)
+		{
+			UpdateLevel(synth, next_toggle);
+		}
+	}
+}
+
+void VIPR_Emulator::SquareWaveOscillator::SetGate(BandLimitedSynth &synth, uint64_t time, bool gate)
+{
+	Run(synth, time);
+	this->gate = gate;
+	UpdateLevel(synth, time);
+}
+
+void VIPR_Emulator::SquareWaveOscillator::SetAmplitude(BandLimitedSynth &synth, uint64_t time, int32_t amplitude)
+{
+	Run(synth, time);
+	this->amplitude = amplitude;
+	UpdateLevel(synth, time);
+}
+
+void VIPR_Emulator::SquareWaveOscillator::SetHalfPeriod(BandLimitedSynth &synth, uint64_t time, uint64_t half_period)
+{
+	Run(synth, time);
+	this->half_period = std::max<uint64_t>(half_period, 1 << 16);
+	next_toggle = std::min(next_toggle, time + this->half_period); // A shorter period takes effect on the current half cycle
+}
+
+void VIPR_Emulator::SquareWaveOscillator::EndFrame(uint64_t frame_time)
+{
+	next_toggle -= std::min(next_toggle, frame_time);
+}
+
+void VIPR_Emulator::SquareWaveOscillator::UpdateLevel(BandLimitedSynth &synth, uint64_t time)
+{
+	int32_t new_level = gate ? (high ? amplitude : -amplitude) : 0;
+	if (new_level != level)
+	{
+		synth.AddDelta(static_cast<uint32_t>(time >> 16), new_level - level);
+		level = new_level;
+	}
+}
@@ -0,0 +1,225 @@
+#include "capture.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <fmt/core.h>
+
+namespace
+{
+	template <typename T>
+	inline void AppendLE(std::vector<uint8_t> &buffer, T value)
+	{
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			buffer.push_back(static_cast<uint8_t>(static_cast<uint64_t>(value) >> (i * 8)));
+		}
+	}
+
+	inline void WriteChunk(std::ofstream &output, uint8_t type, const std::vector<uint8_t> &payload)
+	{
+		std::array<uint8_t, 5> chunk_header = { type, static_cast<uint8_t>(payload.size()), static_cast<uint8_t>(payload.size() >> 8), static_cast<uint8_t>(payload.size() >> 16), static_cast<uint8_t>(payload.size() >> 24) };
+		output.write(reinterpret_cast<const char *>(chunk_header.data()), chunk_header.size());
+		output.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+	}
+}
+
+VIPR_Emulator::VideoRecorder::VideoRecorder() : recording(false), processing(false), block_when_full(false), dropped_frames(0), dropped_audio_blocks(0), color_data_valid(false)
+{
+}
+
+VIPR_Emulator::VideoRecorder::~VideoRecorder()
+{
+	Stop();
+}
+
+bool VIPR_Emulator::VideoRecorder::Start(const std::string &capture_file, uint32_t frame_rate_numerator, uint32_t frame_rate_denominator)
+{
+	Stop();
+	capture_output.open(capture_file, std::ios::binary | std::ios::trunc);
+	if (capture_output.fail())
+	{
+		fmt::print("Unable to create capture file '{}'.\n", capture_file);
+		return false;
+	}
+	std::vector<uint8_t> header(capture_magic.begin(), capture_magic.end());
+	AppendLE<uint32_t>(header, frame_rate_numerator);
+	AppendLE<uint32_t>(header, frame_rate_denominator);
+	AppendLE<uint16_t>(header, 64);
+	AppendLE<uint16_t>(header, 128);
+	capture_output.write(reinterpret_cast<const char *>(header.data()), header.size());
+	while (FrameQueue.AcquireRead() != nullptr)
+	{
+		FrameQueue.CommitRead();
+	}
+	while (AudioQueue.AcquireRead() != nullptr)
+	{
+		AudioQueue.CommitRead();
+	}
+	dropped_frames = 0;
+	dropped_audio_blocks = 0;
+	color_data_valid = false;
+	processing = true;
+	WriterThread = std::thread(VideoRecorder::WriterProcessor, this);
+	recording = true;
+	return true;
+}
+
+void VIPR_Emulator::VideoRecorder::Stop()
+{
+	recording = false;
+	if (processing)
+	{
+		processing = false;
+		WriterThread.join();
+		capture_output.close();
+		if (dropped_frames > 0 || dropped_audio_blocks > 0)
+		{
+			fmt::print("Capture dropped {} frames and {} audio blocks.\n", dropped_frames.load(), dropped_audio_blocks.load());
+		}
+	}
+}
+
+void VIPR_Emulator::VideoRecorder::SubmitFrame(const VideoFrame &frame)
+{
+	if (!recording)
+	{
+		return;
+	}
+	while (!FrameQueue.Push(frame))
+	{
+		if (!block_when_full)
+		{
+			++dropped_frames;
+			return;
+		}
+		std::this_thread::yield();
+	}
+}
+
+void VIPR_Emulator::VideoRecorder::SubmitAudio(const int *samples, size_t sample_count, int sample_rate)
+{
+	if (!recording)
+	{
+		return;
+	}
+	while (sample_count > 0)
+	{
+		CaptureAudioBlock *block = AudioQueue.AcquireWrite();
+		if (block == nullptr)
+		{
+			if (!block_when_full)
+			{
+				++dropped_audio_blocks;
+				return;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+		size_t block_size = std::min(sample_count, block->samples.size());
+		for (size_t i = 0; i < block_size; ++i)
+		{
+			block->samples[i] = static_cast<int16_t>(samples[i] >> 16);
+		}
+		block->sample_count = static_cast<uint32_t>(block_size);
+		block->sample_rate = static_cast<uint32_t>(sample_rate);
+		AudioQueue.CommitWrite();
+		samples += block_size;
+		sample_count -= block_size;
+	}
+}
+
+bool VIPR_Emulator::VideoRecorder::WritePendingData()
+{
+	VIPR_TRACE_ZONE("VideoRecorder::WritePendingData");
+	bool written = false;
+	for (VideoFrame *frame = FrameQueue.AcquireRead(); frame != nullptr; frame = FrameQueue.AcquireRead())
+	{
+		WriteFrame(*frame);
+		FrameQueue.CommitRead();
+		written = true;
+	}
+	for (CaptureAudioBlock *block = AudioQueue.AcquireRead(); block != nullptr; block = AudioQueue.AcquireRead())
+	{
+		WriteAudio(*block);
+		AudioQueue.CommitRead();
+		written = true;
+	}
+	return written;
+}
+
+void VIPR_Emulator::VideoRecorder::WriteFrame(const VideoFrame &frame)
+{
+	chunk_buffer.clear();
+	AppendLE<uint64_t>(chunk_buffer, frame.frame_number);
+	chunk_buffer.insert(chunk_buffer.end(), frame.pixel_data.begin(), frame.pixel_data.end());
+	size_t color_delta_count = 0;
+	if (color_data_valid)
+	{
+		for (size_t i = 0; i < frame.color_data.size(); ++i)
+		{
+			if (frame.color_data[i] != previous_color_data[i])
+			{
+				++color_delta_count;
+			}
+		}
+	}
+	if (!color_data_valid || color_delta_count * 3 >= frame.color_data.size()) // Deltas cost 3 bytes each, so fall back to full color data once they stop saving space
+	{
+		AppendLE<uint16_t>(chunk_buffer, capture_full_color_data);
+		chunk_buffer.insert(chunk_buffer.end(), frame.color_data.begin(), frame.color_data.end());
+	}
+	else
+	{
+		AppendLE<uint16_t>(chunk_buffer, static_cast<uint16_t>(color_delta_count));
+		for (size_t i = 0; i < frame.color_data.size(); ++i)
+		{
+			if (frame.color_data[i] != previous_color_data[i])
+			{
+				AppendLE<uint16_t>(chunk_buffer, static_cast<uint16_t>(i));
+				chunk_buffer.push_back(frame.color_data[i]);
+			}
+		}
+	}
+	previous_color_data = frame.color_data;
+	color_data_valid = true;
+	WriteChunk(capture_output, capture_chunk_frame, chunk_buffer);
+}
+
+void VIPR_Emulator::VideoRecorder::WriteAudio(const CaptureAudioBlock &block)
+{
+	chunk_buffer.clear();
+	AppendLE<uint32_t>(chunk_buffer, block.sample_rate);
+	AppendLE<uint32_t>(chunk_buffer, block.sample_count);
+	for (uint32_t i = 0; i < block.sample_count; ++i)
+	{
+		AppendLE<uint16_t>(chunk_buffer, static_cast<uint16_t>(block.samples[i]));
+	}
+	WriteChunk(capture_output, capture_chunk_audio, chunk_buffer);
+}
+
+void VIPR_Emulator::VideoRecorder::WriterProcessor(VideoRecorder *recorder)
+{
+	VIPR_TRACE_THREAD_NAME("Capture Writer");
+	while (recorder->processing)
+	{
+		if (!recorder->WritePendingData())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+	recorder->WritePendingData();
+	recorder->capture_output.flush();
+}
+
+void VIPR_Emulator::VideoRecorder_frame_output(const VideoFrame &frame, void *userdata)
+{
+	VideoRecorder *recorder = static_cast<VideoRecorder *>(userdata);
+	recorder->SubmitFrame(frame);
+}
+
+void VIPR_Emulator::VideoRecorder_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata)
+{
+	VideoRecorder *recorder = static_cast<VideoRecorder *>(userdata);
+	recorder->SubmitAudio(samples, sample_count, sample_rate);
+}
@@ -0,0 +1,300 @@
+#include "capture.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <fmt/core.h>
+
+namespace
+{
+	struct RGBColor
+	{
+		uint8_t r, g, b;
+	};
+
+	// Matches the display palette used by the renderers
+	constexpr std::array<RGBColor, 4> background_colors = {
+		RGBColor { 0, 0, 192 },
+		RGBColor { 0, 0, 0 },
+		RGBColor { 0, 192, 0 },
+		RGBColor { 192, 0, 0 }
+	};
+
+	constexpr std::array<RGBColor, 8> foreground_colors = {
+		RGBColor { 0, 0, 0 },
+		RGBColor { 192, 0, 0 },
+		RGBColor { 0, 0, 192 },
+		RGBColor { 192, 0, 192 },
+		RGBColor { 0, 192, 0 },
+		RGBColor { 192, 192, 0 },
+		RGBColor { 0, 192, 192 },
+		RGBColor { 255, 255, 255 }
+	};
+
+	template <typename T>
+	inline T ReadLE(const uint8_t *data)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			value |= static_cast<uint64_t>(data[i]) << (i * 8);
+		}
+		return static_cast<T>(value);
+	}
+
+	template <typename T>
+	inline void WriteLE(std::ofstream &output, T value)
+	{
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			output.put(static_cast<char>(static_cast<uint64_t>(value) >> (i * 8)));
+		}
+	}
+
+	class Y4MWriter // YUV 4:4:4, BT.601 limited range
+	{
+		public:
+			Y4MWriter(std::ofstream &output, uint32_t width, uint32_t height, uint32_t scale_x, uint32_t scale_y) : output(output), width(width), height(height), scale_x(scale_x), scale_y(scale_y)
+			{
+				plane_data.resize(static_cast<size_t>(width * scale_x) * (height * scale_y) * 3);
+			}
+
+			void WriteHeader(uint32_t frame_rate_numerator, uint32_t frame_rate_denominator)
+			{
+				output << fmt::format("YUV4MPEG2 W{} H{} F{}:{} Ip A1:1 C444\n", width * scale_x, height * scale_y, frame_rate_numerator, frame_rate_denominator);
+			}
+
+			void WriteFrame(const std::array<uint8_t, (64 * 128) / 8> &pixel_data, const std::array<uint8_t, (64 * 128) / 8> &color_data)
+			{
+				size_t plane_size = plane_data.size() / 3;
+				size_t output_width = width * scale_x;
+				for (uint32_t y = 0; y < height; ++y)
+				{
+					for (uint32_t x = 0; x < width; ++x)
+					{
+						size_t address = (y * (width / 8)) + (x / 8);
+						uint8_t color = color_data[address];
+						bool dot = (pixel_data[address] >> (7 - (x % 8))) & 0x1;
+						const RGBColor &current_color = dot ? foreground_colors[(color & 0xF) % 8] : background_colors[(color >> 4) % 4];
+						uint8_t Y = static_cast<uint8_t>(16 + (((66 * current_color.r) + (129 * current_color.g) + (25 * current_color.b) + 128) >> 8));
+						uint8_t U = static_cast<uint8_t>(128 + (((-38 * current_color.r) - (74 * current_color.g) + (112 * current_color.b) + 128) >> 8));
+						uint8_t V = static_cast<uint8_t>(128 + (((112 * current_color.r) - (94 * current_color.g) - (18 * current_color.b) + 128) >> 8));
+						for (uint32_t sy = 0; sy < scale_y; ++sy)
+						{
+							size_t row = ((y * scale_y) + sy) * output_width;
+							for (uint32_t sx = 0; sx < scale_x; ++sx)
+							{
+								size_t index = row + (x * scale_x) + sx;
+								plane_data[index] = Y;
+								plane_data[plane_size + index] = U;
+								plane_data[(plane_size * 2) + index] = V;
+							}
+						}
+					}
+				}
+				output << "FRAME\n";
+				output.write(reinterpret_cast<const char *>(plane_data.data()), plane_data.size());
+			}
+		private:
+			std::ofstream &output;
+			uint32_t width, height;
+			uint32_t scale_x, scale_y;
+			std::vector<uint8_t> plane_data;
+	};
+
+	void PrintUsage()
+	{
+		fmt::print("Usage: vipr_capture_convert <capture.vcap> <output.y4m> [output.wav] [--scale-x N] [--scale-y N]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	using namespace VIPR_Emulator;
+	std::vector<std::string> file_arguments;
+	uint32_t scale_x = 8;
+	uint32_t scale_y = 2; // The VIP's pixels are four times wider than they are tall
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (argument == "--scale-x" && has_value)
+		{
+			scale_x = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (argument == "--scale-y" && has_value)
+		{
+			scale_y = std::max(1ul, std::strtoul(argv[++i], nullptr, 10));
+		}
+		else if (argument.size() > 0 && argument[0] != '-')
+		{
+			file_arguments.push_back(argument);
+		}
+		else
+		{
+			PrintUsage();
+			return -1;
+		}
+	}
+	if (file_arguments.size() < 2 || file_arguments.size() > 3)
+	{
+		PrintUsage();
+		return -1;
+	}
+	std::ifstream capture_input(file_arguments[0], std::ios::binary);
+	if (capture_input.fail())
+	{
+		fmt::print("Unable to open capture file '{}'.\n", file_arguments[0]);
+		return -1;
+	}
+	std::array<uint8_t, 20> header;
+	if (!capture_input.read(reinterpret_cast<char *>(header.data()), header.size()) || !std::equal(capture_magic.begin(), capture_magic.end(), header.begin()))
+	{
+		fmt::print("'{}' is not a VIPR capture file.\n", file_arguments[0]);
+		return -1;
+	}
+	uint32_t frame_rate_numerator = ReadLE<uint32_t>(&header[8]);
+	uint32_t frame_rate_denominator = ReadLE<uint32_t>(&header[12]);
+	uint16_t width = ReadLE<uint16_t>(&header[16]);
+	uint16_t height = ReadLE<uint16_t>(&header[18]);
+	if (width != 64 || height != 128)
+	{
+		fmt::print("Unsupported capture dimensions ({}x{}).\n", width, height);
+		return -1;
+	}
+	std::ofstream video_output(file_arguments[1], std::ios::binary | std::ios::trunc);
+	if (video_output.fail())
+	{
+		fmt::print("Unable to create video file '{}'.\n", file_arguments[1]);
+		return -1;
+	}
+	std::ofstream audio_output;
+	if (file_arguments.size() == 3)
+	{
+		audio_output.open(file_arguments[2], std::ios::binary | std::ios::trunc);
+		if (audio_output.fail())
+		{
+			fmt::print("Unable to create audio file '{}'.\n", file_arguments[2]);
+			return -1;
+		}
+		audio_output.write("RIFF\0\0\0\0WAVEfmt ", 16);
+		WriteLE<uint32_t>(audio_output, 16);
+		WriteLE<uint16_t>(audio_output, 1); // PCM
+		WriteLE<uint16_t>(audio_output, 1); // Mono
+		WriteLE<uint32_t>(audio_output, 0); // Sample rate, filled in from the first audio chunk
+		WriteLE<uint32_t>(audio_output, 0);
+		WriteLE<uint16_t>(audio_output, 2);
+		WriteLE<uint16_t>(audio_output, 16);
+		audio_output.write("data\0\0\0\0", 8);
+	}
+	Y4MWriter VideoWriter(video_output, width, height, scale_x, scale_y);
+	VideoWriter.WriteHeader(frame_rate_numerator, frame_rate_denominator);
+	std::array<uint8_t, (64 * 128) / 8> pixel_data {};
+	std::array<uint8_t, (64 * 128) / 8> color_data {};
+	std::vector<uint8_t> payload;
+	uint64_t frames_written = 0;
+	uint64_t last_frame_number = 0;
+	uint32_t sample_rate = 0;
+	uint64_t audio_data_size = 0;
+	std::array<uint8_t, 5> chunk_header;
+	while (capture_input.read(reinterpret_cast<char *>(chunk_header.data()), chunk_header.size()))
+	{
+		uint32_t payload_size = ReadLE<uint32_t>(&chunk_header[1]);
+		payload.resize(payload_size);
+		if (!capture_input.read(reinterpret_cast<char *>(payload.data()), payload_size))
+		{
+			fmt::print("Capture file is truncated; stopping at the last complete chunk.\n");
+			break;
+		}
+		switch (chunk_header[0])
+		{
+			case capture_chunk_frame:
+			{
+				if (payload_size < 8 + pixel_data.size() + 2)
+				{
+					fmt::print("Invalid frame chunk.\n");
+					return -1;
+				}
+				uint64_t frame_number = ReadLE<uint64_t>(&payload[0]);
+				if (frames_written > 0)
+				{
+					for (uint64_t i = last_frame_number + 1; i < frame_number; ++i) // Repeat the previous frame over dropped frames to keep timing intact
+					{
+						VideoWriter.WriteFrame(pixel_data, color_data);
+						++frames_written;
+					}
+				}
+				std::copy(payload.begin() + 8, payload.begin() + 8 + pixel_data.size(), pixel_data.begin());
+				size_t position = 8 + pixel_data.size();
+				uint16_t color_delta_count = ReadLE<uint16_t>(&payload[position]);
+				position += 2;
+				if (color_delta_count == capture_full_color_data)
+				{
+					if (payload_size < position + color_data.size())
+					{
+						fmt::print("Invalid frame chunk.\n");
+						return -1;
+					}
+					std::copy(payload.begin() + position, payload.begin() + position + color_data.size(), color_data.begin());
+				}
+				else
+				{
+					if (payload_size < position + (color_delta_count * 3))
+					{
+						fmt::print("Invalid frame chunk.\n");
+						return -1;
+					}
+					for (uint16_t i = 0; i < color_delta_count; ++i, position += 3)
+					{
+						color_data[ReadLE<uint16_t>(&payload[position]) % color_data.size()] = payload[position + 2];
+					}
+				}
+				VideoWriter.WriteFrame(pixel_data, color_data);
+				++frames_written;
+				last_frame_number = frame_number;
+				break;
+			}
+			case capture_chunk_audio:
+			{
+				if (!audio_output.is_open() || payload_size < 8)
+				{
+					break;
+				}
+				uint32_t chunk_sample_rate = ReadLE<uint32_t>(&payload[0]);
+				uint32_t sample_count = ReadLE<uint32_t>(&payload[4]);
+				if (sample_rate == 0)
+				{
+					sample_rate = chunk_sample_rate;
+				}
+				else if (chunk_sample_rate != sample_rate)
+				{
+					fmt::print("Skipping audio chunk with a different sample rate ({} Hz).\n", chunk_sample_rate);
+					break;
+				}
+				size_t sample_bytes = std::min<size_t>(static_cast<size_t>(sample_count) * 2, payload_size - 8);
+				audio_output.write(reinterpret_cast<const char *>(&payload[8]), sample_bytes);
+				audio_data_size += sample_bytes;
+				break;
+			}
+			default:
+			{
+				break; // Unknown chunks are skipped so newer captures can still be converted
+			}
+		}
+	}
+	if (audio_output.is_open())
+	{
+		audio_output.seekp(4);
+		WriteLE<uint32_t>(audio_output, static_cast<uint32_t>(36 + audio_data_size));
+		audio_output.seekp(24);
+		WriteLE<uint32_t>(audio_output, sample_rate);
+		WriteLE<uint32_t>(audio_output, sample_rate * 2);
+		audio_output.seekp(40);
+		WriteLE<uint32_t>(audio_output, static_cast<uint32_t>(audio_data_size));
+	}
+	fmt::print("Converted {} frames{}.\n", frames_written, audio_output.is_open() ? fmt::format(" and {} audio samples", audio_data_size / 2) : "");
+	return 0;
+}
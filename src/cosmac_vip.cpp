@@ -1,25 +1,35 @@
 #include "cosmac_vip.hpp"
+#include <algorithm>
 #include <chrono>
 #include <cstring>
+#include <filesystem>
 #include <fstream>
 #include <fmt/core.h>
 
-VIPR_Emulator::COSMAC_VIP::COSMAC_VIP() : CPU(1760900.0, VIPR_Emulator::VIP_memory_read, VIPR_Emulator::VIP_memory_write, VIPR_Emulator::VIP_input, VIPR_Emulator::VIP_output, VIPR_Emulator::VIP_q_output, VIPR_Emulator::VIP_sync, this), VDC(nullptr), tone_generator(nullptr), color_board(nullptr), simple_sound_board(nullptr), run(false), address_inhibit_latch(true), hex_key_latch(0x0), current_hex_key { 0x0, 0x0 }, hex_key_pressed { false, false }, hex_key_press_signal { CPU.GetEFPtr(2), CPU.GetEFPtr(3) }, fail(false), RAM(2 << 10)
+VIPR_Emulator::COSMAC_VIP::COSMAC_VIP() : CPU(1760900.0, VIPR_Emulator::VIP_memory_read, VIPR_Emulator::VIP_memory_write, VIPR_Emulator::VIP_input, VIPR_Emulator::VIP_output, VIPR_Emulator::VIP_q_output, VIPR_Emulator::VIP_sync, VIPR_Emulator::VIP_sync_skip, this), VDC(nullptr), tone_generator(nullptr), color_board(nullptr), simple_sound_board(nullptr), super_sound_board(nullptr), run(false), address_inhibit_latch(true), hex_key_latch(0x0), current_hex_key { 0x0, 0x0 }, hex_key_pressed { false, false }, hex_key_press_signal { CPU.GetEFPtr(2), CPU.GetEFPtr(3) }, fail(false), RAM(2 << 10), RAMData(RAM), DisplayRenderer(nullptr), SoundEngine(nullptr), Debug(nullptr), frame_output_func(nullptr), frame_output_userdata(nullptr)
 {
 	VDC = std::make_unique<CDP1861>(&CPU, 0, VIP_video_output, this);
 	memset(RAM.data(), 0, RAM.size());
 	MemoryMap.resize(2);
-	MemoryMap[0] = MemoryMapData { 0x0000, 0x7FFF, ROM.data(), ROM.size(), 0x01, nullptr, nullptr };
-	MemoryMap[1] = MemoryMapData { 0x8000, 0xFFFF, ROM.data(), ROM.size(), 0x01, nullptr, nullptr };
-	tone_generator = std::make_unique<ToneGenerator>();
+	MemoryMap[0] = MemoryMapData { 0x0000, 0x7FFF, ROMData.data(), ROMData.size(), 0x01, nullptr, nullptr };
+	MemoryMap[1] = MemoryMapData { 0x8000, 0xFFFF, ROMData.data(), ROMData.size(), 0x01, nullptr, nullptr };
+	tone_generator = std::make_unique<ToneGenerator>(static_cast<uint32_t>(CPU.GetCycleFrequency()));
 	for (size_t i = 0; i < ExpansionBoard.size(); ++i)
 	{
 		ExpansionBoard[i] = false;
 	}
+	source_volume.fill(100);
+	current_frame.pixel_data.fill(0x00);
+	current_frame.color_data.fill(0x17);
+	current_frame.frame_number = 0;
+	current_frame.hash = 0;
+	last_frame = current_frame;
+	last_frame.hash = HashVideoFrame(last_frame);
 }
 
 VIPR_Emulator::COSMAC_VIP::~COSMAC_VIP()
 {
+	AttachAudioEngine(nullptr);
 }
 
 void VIPR_Emulator::COSMAC_VIP::SetRunSwitch(bool run)
@@ -32,7 +42,7 @@ void VIPR_Emulator::COSMAC_VIP::SetRunSwitch(bool run)
 			CPU.SetControlMode(CDP1802::ControlMode::Run, std::chrono::high_resolution_clock::now());
 			if (simple_sound_board != nullptr)
 			{
-				simple_sound_board->SetFrequency(0x00);
+				simple_sound_board->SetFrequency(0x00, CPU.GetMachineCycleCount());
 			}
 		}
 		else
@@ -51,22 +61,53 @@ void VIPR_Emulator::COSMAC_VIP::SetRunSwitch(bool run)
 			CPU.SetControlMode(CDP1802::ControlMode::Reset, std::chrono::high_resolution_clock::now());
 			address_inhibit_latch = true;
 			hex_key_latch = 0x0;
-			if (tone_generator != nullptr)
+			tone_generator->GenerateTone(false, CPU.GetMachineCycleCount());
+			if (simple_sound_board != nullptr)
 			{
-				tone_generator->GenerateTone(false);
+				simple_sound_board->GenerateTone(false, CPU.GetMachineCycleCount());
+				simple_sound_board->Reset(CPU.GetMachineCycleCount());
 			}
-			else if (simple_sound_board != nullptr)
+			if (super_sound_board != nullptr)
 			{
-				simple_sound_board->GenerateTone(false);
-				simple_sound_board->Reset();
+				super_sound_board->Reset(CPU.GetMachineCycleCount());
 			}
-			MemoryMap[0].memory = ROM.data();
-			MemoryMap[0].size = ROM.size();
+			MemoryMap[0].memory = ROMData.data();
+			MemoryMap[0].size = ROMData.size();
 			MemoryMap[0].access = 0x01;
 		}
 	}
 }
 
+bool VIPR_Emulator::COSMAC_VIP::AttachRAMFile(const std::string &ram_file)
+{
+	std::error_code error;
+	bool has_contents = std::filesystem::file_size(ram_file, error) > 0 && !error;
+	MappedFile NewRAMImage;
+	if (!NewRAMImage.Open(ram_file, MappedFileMode::ReadWrite, RAMData.size()))
+	{
+		return false;
+	}
+	if (!has_contents)
+	{
+		std::copy(RAMData.begin(), RAMData.end(), NewRAMImage.GetData());
+	}
+	RAMImage = std::move(NewRAMImage);
+	UpdateRAMData(std::span<uint8_t>(RAMImage.GetData(), RAMImage.GetSize()));
+	RAM.clear();
+	RAM.shrink_to_fit();
+	return true;
+}
+
+void VIPR_Emulator::COSMAC_VIP::DetachRAMFile()
+{
+	if (RAMImage.IsOpen())
+	{
+		RAM.assign(RAMData.begin(), RAMData.end());
+		UpdateRAMData(RAM);
+		RAMImage.Close();
+	}
+}
+
 uint8_t VIPR_Emulator::VIP_memory_read(uint16_t address, void *userdata)
 {
 	COSMAC_VIP *VIP = static_cast<COSMAC_VIP *>(userdata);
@@ -114,12 +155,9 @@ void VIPR_Emulator::VIP_memory_write(uint16_t address, uint8_t data, void *userd
 					if (CurrentMemoryMap.custom_memory_write == nullptr)
 					{
 						CurrentMemoryMap.memory[offset] = data;
+						return;
 					}
-					else
-					{
-						CurrentMemoryMap.custom_memory_write(address, data, CurrentMemoryMap.custom_memory_write_userdata);
-					}
-					return;
+					CurrentMemoryMap.custom_memory_write(address, data, CurrentMemoryMap.custom_memory_write_userdata); // Boards decode only some address lines, so every board whose range holds the address sees the write, whatever order they were installed in
 				}
 			}
 		}
@@ -135,6 +173,50 @@ void VIPR_Emulator::VIP_memory_write(uint16_t address, uint8_t data, void *userd
 	}
 }
 
+uint8_t VIPR_Emulator::VIP_debug_memory_read(uint16_t address, void *userdata)
+{
+	COSMAC_VIP *VIP = static_cast<COSMAC_VIP *>(userdata);
+	CDP1802::CycleState cycle_state = VIP->CPU.GetCycleState();
+	if (cycle_state != CDP1802::CycleState::Fetch && cycle_state != CDP1802::CycleState::DMA) // Fetches are execution breakpoints, and DMA reads are the display refresh
+	{
+		if (VIP->Debug->CheckAddress(address, static_cast<uint8_t>(BreakpointType::Read)))
+		{
+			VIP->Debug->Stop(StopReason::Read, address);
+		}
+	}
+	return VIP_memory_read(address, userdata);
+}
+
+void VIPR_Emulator::VIP_debug_memory_write(uint16_t address, uint8_t data, void *userdata)
+{
+	COSMAC_VIP *VIP = static_cast<COSMAC_VIP *>(userdata);
+	Debugger *Debug = VIP->Debug;
+	if (Debug->CheckAddress(address, static_cast<uint8_t>(BreakpointType::Write)))
+	{
+		Debug->Stop(StopReason::Write, address);
+	}
+	bool watch = Debug->CheckAddress(address, static_cast<uint8_t>(BreakpointType::Watch));
+	uint8_t previous_data = watch ? VIP_memory_read(address, userdata) : 0x00;
+	bool color_watch = false;
+	uint8_t color_location = 0x00;
+	uint8_t previous_color_data = 0x0;
+	if (Debug->HasColorWatches() && VIP->color_board != nullptr && address >= 0xC000 && address <= 0xDFFF)
+	{
+		color_location = static_cast<uint8_t>(address & 0xFF);
+		color_watch = ((address & 0xF00) == 0x000) && Debug->CheckColorWatch(color_location); // Only the first 256 locations of the board hold color data
+		previous_color_data = color_watch ? VIP->color_board->GetColorData(color_location) : 0x0;
+	}
+	VIP_memory_write(address, data, userdata);
+	if (watch && VIP_memory_read(address, userdata) != previous_data)
+	{
+		Debug->Stop(StopReason::Watch, address);
+	}
+	if (color_watch && VIP->color_board->GetColorData(color_location) != previous_color_data)
+	{
+		Debug->Stop(StopReason::ColorWatch, color_location);
+	}
+}
+
 uint8_t VIPR_Emulator::VIP_input(uint8_t N, void *userdata)
 {
 	COSMAC_VIP *VIP = static_cast<COSMAC_VIP *>(userdata);
@@ -182,7 +264,7 @@ void VIPR_Emulator::VIP_output(uint8_t N, uint8_t data, void *userdata)
 		{
 			if (VIP->ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP595_SimpleSoundBoard)])
 			{
-				VIP->simple_sound_board->SetFrequency(data);
+				VIP->simple_sound_board->SetFrequency(data, VIP->CPU.GetMachineCycleCount());
 			}
 			break;
 		}
@@ -205,40 +287,27 @@ void VIPR_Emulator::VIP_output(uint8_t N, uint8_t data, void *userdata)
 void VIPR_Emulator::VIP_q_output(uint8_t Q, void *userdata)
 {
 	COSMAC_VIP *VIP = static_cast<COSMAC_VIP *>(userdata);
-	if (Q)
+	uint64_t machine_cycle = VIP->CPU.GetMachineCycleCount();
+	if (VIP->simple_sound_board != nullptr)
 	{
-		if (VIP->tone_generator != nullptr)
-		{
-			VIP->tone_generator->GenerateTone(true);
-		}
-		else if (VIP->simple_sound_board != nullptr)
-		{
-			VIP->simple_sound_board->GenerateTone(true);
-		}
+		VIP->simple_sound_board->GenerateTone(Q != 0, machine_cycle);
 	}
-	else
+	if (VIP->super_sound_board != nullptr)
 	{
-		if (VIP->tone_generator != nullptr)
-		{
-			VIP->tone_generator->GenerateTone(false);
-		}
-		else if (VIP->simple_sound_board != nullptr)
-		{
-			VIP->simple_sound_board->GenerateTone(false);
-		}
+		VIP->super_sound_board->GenerateTone(Q != 0, machine_cycle);
+	}
+	if (VIP->simple_sound_board == nullptr && VIP->super_sound_board == nullptr)
+	{
+		VIP->tone_generator->GenerateTone(Q != 0, machine_cycle);
 	}
 }
 
 void VIPR_Emulator::VIP_sync(void *userdata)
 {
 	COSMAC_VIP *VIP = static_cast<COSMAC_VIP *>(userdata);
-	for (size_t i = 0; i < VIP->hex_key_press_signal.size(); ++i)
+	for (size_t i = 0; i < VIP->GetKeypadCount(); ++i)
 	{
-		if (i == 1 && (!VIP->ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP585_ExpansionKeypadInterface)] && !VIP->ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP590_ColorBoard)]))
-		{
-			break;
-		}
-		*VIP->hex_key_press_signal[i] = (VIP->current_hex_key[i] == VIP->hex_key_latch && VIP->hex_key_pressed[i]);
+		*VIP->hex_key_press_signal[i] = VIP->GetHexKeyPressSignal(i);
 	}
 	if (VIP->VDC != nullptr)
 	{
@@ -248,10 +317,77 @@ void VIPR_Emulator::VIP_sync(void *userdata)
 	{
 		VIP->color_board->Sync();
 	}
+	if (VIP->super_sound_board != nullptr)
+	{
+		VIP->super_sound_board->Sync();
+	}
+}
+
+uint32_t VIPR_Emulator::VIP_sync_skip(uint32_t machine_cycles, uint32_t cycles_per_step, void *userdata)
+{
+	COSMAC_VIP *VIP = static_cast<COSMAC_VIP *>(userdata);
+	for (size_t i = 0; i < VIP->GetKeypadCount(); ++i)
+	{
+		if (*VIP->hex_key_press_signal[i] != VIP->GetHexKeyPressSignal(i)) // A key changed since the last sync, so the next one has a flag to update
+		{
+			return 0;
+		}
+	}
+	uint32_t quiet_cycles = machine_cycles;
+	if (VIP->VDC != nullptr)
+	{
+		quiet_cycles = VIP->VDC->GetQuietCycles(quiet_cycles);
+	}
+	else if (VIP->color_board != nullptr)
+	{
+		quiet_cycles = VIP->color_board->GetQuietCycles(quiet_cycles);
+	}
+	if (VIP->super_sound_board != nullptr)
+	{
+		quiet_cycles = VIP->super_sound_board->GetQuietCycles(quiet_cycles);
+	}
+	quiet_cycles -= quiet_cycles % cycles_per_step;
+	if (quiet_cycles > 0)
+	{
+		if (VIP->VDC != nullptr)
+		{
+			VIP->VDC->SkipCycles(quiet_cycles);
+		}
+		else if (VIP->color_board != nullptr)
+		{
+			VIP->color_board->SkipCycles(quiet_cycles);
+		}
+		if (VIP->super_sound_board != nullptr)
+		{
+			VIP->super_sound_board->SkipCycles(quiet_cycles);
+		}
+	}
+	return quiet_cycles;
 }
 
 void VIPR_Emulator::VIP_video_output(uint8_t value, uint8_t line, size_t address, void *userdata)
+{
+	VIP_color_video_output(value, line, address, 1, 7, userdata);
+}
+
+void VIPR_Emulator::VIP_color_video_output(uint8_t value, uint8_t line, size_t address, uint8_t background_color, uint8_t dot_color, void *userdata)
 {
 	COSMAC_VIP *VIP = static_cast<COSMAC_VIP *>(userdata);
-	VIP->DisplayRenderer->DrawByte(value, line, address, 1, 7);
+	if (VIP->DisplayRenderer != nullptr)
+	{
+		VIP->DisplayRenderer->DrawByte(value, line, address, background_color, dot_color);
+	}
+	size_t offset = (line * 8) + address;
+	VIP->current_frame.pixel_data[offset] = value;
+	VIP->current_frame.color_data[offset] = ((background_color & 0xF) << 4) | (dot_color & 0xF);
+	if (line == 127 && address == 7)
+	{
+		VIP->current_frame.hash = HashVideoFrame(VIP->current_frame);
+		VIP->last_frame = VIP->current_frame;
+		++VIP->current_frame.frame_number;
+		if (VIP->frame_output_func != nullptr)
+		{
+			VIP->frame_output_func(VIP->last_frame, VIP->frame_output_userdata);
+		}
+	}
 }
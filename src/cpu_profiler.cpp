@@ -0,0 +1,176 @@
+#include "cpu_profiler.hpp"
+#include <algorithm>
+#include <numeric>
+#include <fmt/core.h>
+
+namespace
+{
+	constexpr std::array<const char *, 16> short_branch_mnemonics = { "BR", "BQ", "BZ", "BDF", "B1", "B2", "B3", "B4", "SKP", "BNQ", "BNZ", "BNF", "BN1", "BN2", "BN3", "BN4" };
+	constexpr std::array<const char *, 16> control_mnemonics = { "RET", "DIS", "LDXA", "STXD", "ADC", "SDB", "SHRC", "SMB", "SAV", "MARK", "REQ", "SEQ", "ADCI", "SDBI", "SHLC", "SMBI" };
+	constexpr std::array<const char *, 16> long_branch_mnemonics = { "LBR", "LBQ", "LBZ", "LBDF", "NOP", "LSNQ", "LSNZ", "LSNF", "LSKP", "LBNQ", "LBNZ", "LBNF", "LSIE", "LSQ", "LSZ", "LSDF" };
+	constexpr std::array<const char *, 16> alu_mnemonics = { "LDX", "OR", "AND", "XOR", "ADD", "SD", "SHR", "SM", "LDI", "ORI", "ANI", "XRI", "ADI", "SDI", "SHL", "SMI" };
+	constexpr std::array<const char *, 16> register_mnemonics = { "LDN", "INC", "DEC", "", "LDA", "STR", "", "", "GLO", "GHI", "PLO", "PHI", "", "SEP", "SEX", "" };
+
+	double GetShare(uint64_t cycles, uint64_t total_cycles)
+	{
+		return (total_cycles > 0) ? (static_cast<double>(cycles) * 100.0) / static_cast<double>(total_cycles) : 0.0;
+	}
+}
+
+std::string VIPR_Emulator::GetMnemonic(uint8_t opcode)
+{
+	uint8_t I = opcode >> 4;
+	uint8_t N = opcode & 0xF;
+	switch (I)
+	{
+		case 0x0:
+		{
+			return (N == 0) ? "IDL" : fmt::format("LDN R{:X}", N);
+		}
+		case 0x3:
+		{
+			return short_branch_mnemonics[N];
+		}
+		case 0x6:
+		{
+			if (N == 0)
+			{
+				return "IRX";
+			}
+			else if (N == 8)
+			{
+				return "(68)"; // Not an instruction on the CDP1802
+			}
+			return fmt::format("{} {}", (N < 8) ? "OUT" : "INP", N & 0x7);
+		}
+		case 0x7:
+		{
+			return control_mnemonics[N];
+		}
+		case 0xC:
+		{
+			return long_branch_mnemonics[N];
+		}
+		case 0xF:
+		{
+			return alu_mnemonics[N];
+		}
+		default:
+		{
+			return fmt::format("{} R{:X}", register_mnemonics[I], N);
+		}
+	}
+}
+
+VIPR_Emulator::CPUProfiler::CPUProfiler() : Addresses(0x10000)
+{
+	Reset();
+}
+
+VIPR_Emulator::CPUProfiler::~CPUProfiler()
+{
+}
+
+void VIPR_Emulator::CPUProfiler::Reset()
+{
+	std::fill(Opcodes.begin(), Opcodes.end(), ExecutionStats { 0, 0, 0 });
+	for (size_t i = 0; i < Opcodes.size(); ++i)
+	{
+		Opcodes[i].opcode = static_cast<uint8_t>(i);
+	}
+	std::fill(Addresses.begin(), Addresses.end(), ExecutionStats { 0, 0, 0 });
+	Routines.clear();
+	Routines.push_back(RoutineNode { 0, 0xFF, 0x0000, 0 });
+	RoutineChildren.clear();
+	current_routine = 0;
+	current_P = 0xFF; // The first fetch always enters a routine
+	current_opcode = 0x00;
+	current_address = 0x0000;
+	instruction_cycles = 0;
+	dma_cycles = 0;
+	interrupt_cycles = 0;
+}
+
+void VIPR_Emulator::CPUProfiler::SwitchProgramCounter(uint8_t P, uint16_t address) // Switching back to a P register already on the path is a return, anything else is a call
+{
+	current_P = P;
+	for (uint32_t routine = current_routine; routine != 0; routine = Routines[routine].parent)
+	{
+		if (Routines[routine].P == P)
+		{
+			current_routine = routine;
+			return;
+		}
+	}
+	uint64_t key = (static_cast<uint64_t>(current_routine) << 24) | (static_cast<uint64_t>(P) << 16) | address;
+	std::unordered_map<uint64_t, uint32_t>::iterator child = RoutineChildren.find(key);
+	if (child != RoutineChildren.end())
+	{
+		current_routine = child->second;
+		return;
+	}
+	uint32_t new_routine = static_cast<uint32_t>(Routines.size());
+	Routines.push_back(RoutineNode { current_routine, P, address, 0 });
+	RoutineChildren.emplace(key, new_routine);
+	current_routine = new_routine;
+}
+
+std::string VIPR_Emulator::CPUProfiler::FormatReport(size_t hot_spot_count) const
+{
+	uint64_t total_cycles = instruction_cycles + dma_cycles + interrupt_cycles;
+	std::string report = fmt::format("CDP1802 Profile: {} machine cycles ({} instruction, {} DMA, {} interrupt)\n\n", total_cycles, instruction_cycles, dma_cycles, interrupt_cycles);
+	report += fmt::format("{:<8}{:<10}{:>14}{:>14}{:>9}\n", "Opcode", "Mnemonic", "Executions", "Cycles", "Share");
+	std::vector<ExecutionStats> SortedOpcodes(Opcodes.begin(), Opcodes.end());
+	std::stable_sort(SortedOpcodes.begin(), SortedOpcodes.end(), [](const ExecutionStats &a, const ExecutionStats &b) { return a.cycles > b.cycles; });
+	for (const ExecutionStats &CurrentOpcode : SortedOpcodes)
+	{
+		if (CurrentOpcode.executions == 0)
+		{
+			break;
+		}
+		report += fmt::format("{:02X}      {:<10}{:>14}{:>14}{:>8.2f}%\n", CurrentOpcode.opcode, GetMnemonic(CurrentOpcode.opcode), CurrentOpcode.executions, CurrentOpcode.cycles, GetShare(CurrentOpcode.cycles, total_cycles));
+	}
+	std::vector<uint32_t> SortedAddresses(Addresses.size());
+	std::iota(SortedAddresses.begin(), SortedAddresses.end(), 0);
+	hot_spot_count = std::min(hot_spot_count, SortedAddresses.size());
+	std::partial_sort(SortedAddresses.begin(), SortedAddresses.begin() + hot_spot_count, SortedAddresses.end(), [this](uint32_t a, uint32_t b) { return (Addresses[a].cycles != Addresses[b].cycles) ? Addresses[a].cycles > Addresses[b].cycles : a < b; });
+	report += fmt::format("\nHot Spots (Top {} Addresses)\n{:<9}{:<8}{:<10}{:>14}{:>14}{:>9}\n", hot_spot_count, "Address", "Opcode", "Mnemonic", "Executions", "Cycles", "Share");
+	for (size_t i = 0; i < hot_spot_count && Addresses[SortedAddresses[i]].executions > 0; ++i)
+	{
+		const ExecutionStats &CurrentAddress = Addresses[SortedAddresses[i]];
+		report += fmt::format("{:04X}     {:02X}      {:<10}{:>14}{:>14}{:>8.2f}%\n", SortedAddresses[i], CurrentAddress.opcode, GetMnemonic(CurrentAddress.opcode), CurrentAddress.executions, CurrentAddress.cycles, GetShare(CurrentAddress.cycles, total_cycles));
+	}
+	return report;
+}
+
+std::string VIPR_Emulator::CPUProfiler::FormatFoldedStacks() const
+{
+	std::string folded;
+	std::vector<uint32_t> path;
+	for (uint32_t routine = 1; routine < Routines.size(); ++routine)
+	{
+		if (Routines[routine].cycles == 0)
+		{
+			continue;
+		}
+		path.clear();
+		for (uint32_t current = routine; current != 0; current = Routines[current].parent)
+		{
+			path.push_back(current);
+		}
+		for (std::vector<uint32_t>::reverse_iterator current = path.rbegin(); current != path.rend(); ++current)
+		{
+			folded += fmt::format("{}R{:X}@{:04X}", (current != path.rbegin()) ? ";" : "", Routines[*current].P, Routines[*current].entry_address);
+		}
+		folded += fmt::format(" {}\n", Routines[routine].cycles);
+	}
+	if (dma_cycles > 0)
+	{
+		folded += fmt::format("DMA {}\n", dma_cycles);
+	}
+	if (interrupt_cycles > 0)
+	{
+		folded += fmt::format("Interrupt {}\n", interrupt_cycles);
+	}
+	return folded;
+}
@@ -0,0 +1,188 @@
+#include "debugger.hpp"
+#include <algorithm>
+#include <fmt/core.h>
+
+VIPR_Emulator::Debugger::Debugger() : memory_breakpoint_count(0), color_watch_count(0), pause_request(false), step_request(false), resume_fetch(false), stopped(false), stop_reason(StopReason::None), stop_address(0)
+{
+	AddressFlags.fill(0x00);
+	PageFlags.fill(0x00);
+	ColorWatches.fill(false);
+}
+
+VIPR_Emulator::Debugger::~Debugger()
+{
+}
+
+bool VIPR_Emulator::Debugger::AddBreakpoint(BreakpointType type, uint16_t address)
+{
+	if (type == BreakpointType::ColorWatch)
+	{
+		if (address >= ColorWatches.size() || ColorWatches[address])
+		{
+			return false;
+		}
+		ColorWatches[address] = true;
+		++color_watch_count;
+	}
+	else
+	{
+		uint8_t flag = static_cast<uint8_t>(type);
+		if (AddressFlags[address] & flag)
+		{
+			return false;
+		}
+		AddressFlags[address] |= flag;
+		PageFlags[address >> 8] |= flag;
+		if (flag & memory_breakpoint_flags)
+		{
+			++memory_breakpoint_count;
+		}
+	}
+	Breakpoints.push_back(Breakpoint { type, address });
+	return true;
+}
+
+bool VIPR_Emulator::Debugger::RemoveBreakpoint(BreakpointType type, uint16_t address)
+{
+	std::vector<Breakpoint>::iterator CurrentBreakpoint = std::find_if(Breakpoints.begin(), Breakpoints.end(), [type, address](const Breakpoint &breakpoint) { return breakpoint.type == type && breakpoint.address == address; });
+	if (CurrentBreakpoint == Breakpoints.end())
+	{
+		return false;
+	}
+	Breakpoints.erase(CurrentBreakpoint);
+	if (type == BreakpointType::ColorWatch)
+	{
+		ColorWatches[address] = false;
+		--color_watch_count;
+	}
+	else
+	{
+		uint8_t flag = static_cast<uint8_t>(type);
+		AddressFlags[address] &= ~flag;
+		UpdatePageFlags(static_cast<uint8_t>(address >> 8));
+		if (flag & memory_breakpoint_flags)
+		{
+			--memory_breakpoint_count;
+		}
+	}
+	return true;
+}
+
+void VIPR_Emulator::Debugger::ClearBreakpoints()
+{
+	AddressFlags.fill(0x00);
+	PageFlags.fill(0x00);
+	ColorWatches.fill(false);
+	Breakpoints.clear();
+	memory_breakpoint_count = 0;
+	color_watch_count = 0;
+}
+
+void VIPR_Emulator::Debugger::UpdatePageFlags(uint8_t page)
+{
+	uint8_t flags = 0x00;
+	for (size_t i = static_cast<size_t>(page) << 8; i < (static_cast<size_t>(page) + 1) << 8; ++i)
+	{
+		flags |= AddressFlags[i];
+	}
+	PageFlags[page] = flags;
+}
+
+void VIPR_Emulator::Debugger::Pause()
+{
+	if (!stopped)
+	{
+		pause_request = true;
+	}
+}
+
+void VIPR_Emulator::Debugger::Step()
+{
+	Resume();
+	step_request = true;
+}
+
+void VIPR_Emulator::Debugger::Continue()
+{
+	Resume();
+}
+
+void VIPR_Emulator::Debugger::Resume()
+{
+	if (stopped)
+	{
+		resume_fetch = (stop_reason == StopReason::Pause || stop_reason == StopReason::Step || stop_reason == StopReason::Execute); // These stop before the fetch, which hasn't happened yet
+	}
+	stopped = false;
+	stop_reason = StopReason::None;
+	pause_request = false;
+	step_request = false;
+}
+
+std::string VIPR_Emulator::Debugger::FormatStopReason() const
+{
+	switch (stop_reason)
+	{
+		case StopReason::None:
+		{
+			return "Running";
+		}
+		case StopReason::Pause:
+		{
+			return fmt::format("Paused at {:04X}", stop_address);
+		}
+		case StopReason::Step:
+		{
+			return fmt::format("Stepped to {:04X}", stop_address);
+		}
+		case StopReason::Execute:
+		{
+			return fmt::format("Breakpoint at {:04X}", stop_address);
+		}
+		case StopReason::Read:
+		{
+			return fmt::format("Read from {:04X}", stop_address);
+		}
+		case StopReason::Write:
+		{
+			return fmt::format("Write to {:04X}", stop_address);
+		}
+		case StopReason::Watch:
+		{
+			return fmt::format("{:04X} changed", stop_address);
+		}
+		case StopReason::ColorWatch:
+		{
+			return fmt::format("Color RAM {:02X} changed", stop_address);
+		}
+	}
+	return "";
+}
+
+std::string VIPR_Emulator::GetBreakpointTypeName(BreakpointType type)
+{
+	switch (type)
+	{
+		case BreakpointType::Execute:
+		{
+			return "Execute";
+		}
+		case BreakpointType::Read:
+		{
+			return "Read";
+		}
+		case BreakpointType::Write:
+		{
+			return "Write";
+		}
+		case BreakpointType::Watch:
+		{
+			return "Watch";
+		}
+		case BreakpointType::ColorWatch:
+		{
+			return "Color Watch";
+		}
+	}
+	return "";
+}
@@ -0,0 +1,58 @@
+#include "frame_timer.hpp"
+#include <algorithm>
+
+namespace
+{
+	double GetPercentile(std::array<float, VIPR_Emulator::FrameTimer::frame_history> history, size_t count, double fraction) // Takes a copy, since nth_element reorders it
+	{
+		if (count == 0)
+		{
+			return 0.0;
+		}
+		count = std::min(count, history.size());
+		size_t rank = std::min(static_cast<size_t>(count * fraction), count - 1);
+		std::nth_element(history.begin(), history.begin() + rank, history.begin() + count);
+		return history[rank];
+	}
+}
+
+VIPR_Emulator::FrameTimer::FrameTimer() : Display(nullptr), late_frame_ms(25.0)
+{
+	Reset();
+}
+
+VIPR_Emulator::FrameTimer::~FrameTimer()
+{
+}
+
+void VIPR_Emulator::FrameTimer::Reset()
+{
+	last_frame_tp = std::chrono::steady_clock::time_point();
+	interval_count = 0;
+	render_count = 0;
+	late_frames = 0;
+}
+
+void VIPR_Emulator::FrameTimer::Render()
+{
+	std::chrono::steady_clock::time_point frame_tp = std::chrono::steady_clock::now();
+	if (last_frame_tp != std::chrono::steady_clock::time_point())
+	{
+		float interval_ms = std::chrono::duration<float, std::milli>(frame_tp - last_frame_tp).count();
+		FrameIntervals[interval_count % frame_history] = interval_ms;
+		++interval_count;
+		if (interval_ms > late_frame_ms)
+		{
+			++late_frames;
+		}
+	}
+	last_frame_tp = frame_tp;
+	Display->Render();
+	RenderTimes[render_count % frame_history] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frame_tp).count();
+	++render_count;
+}
+
+VIPR_Emulator::FrameTimingStats VIPR_Emulator::FrameTimer::GetStats() const
+{
+	return FrameTimingStats { render_count, late_frames, GetPercentile(FrameIntervals, interval_count, 0.5), GetPercentile(FrameIntervals, interval_count, 0.95), GetPercentile(FrameIntervals, interval_count, 0.99), GetPercentile(RenderTimes, render_count, 0.5), GetPercentile(RenderTimes, render_count, 0.99) };
+}
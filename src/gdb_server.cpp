@@ -0,0 +1,647 @@
+#include "gdb_server.hpp"
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fmt/core.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
+
+namespace
+{
+	inline uint8_t ParseHexDigit(char digit)
+	{
+		if (digit >= '0' && digit <= '9')
+		{
+			return digit - '0';
+		}
+		if (digit >= 'a' && digit <= 'f')
+		{
+			return digit - 'a' + 10;
+		}
+		if (digit >= 'A' && digit <= 'F')
+		{
+			return digit - 'A' + 10;
+		}
+		return 0xFF;
+	}
+
+	bool ParseHex(const std::string &text, size_t &position, uint32_t &value) // Reads hex digits up to the next non-hex character
+	{
+		size_t start = position;
+		value = 0;
+		for (; position < text.size() && ParseHexDigit(text[position]) != 0xFF; ++position)
+		{
+			value = (value << 4) | ParseHexDigit(text[position]);
+		}
+		return position > start;
+	}
+
+	bool ParseHexBytes(const std::string &text, size_t position, std::vector<uint8_t> &data)
+	{
+		data.clear();
+		for (; position + 1 < text.size(); position += 2)
+		{
+			uint8_t high = ParseHexDigit(text[position]);
+			uint8_t low = ParseHexDigit(text[position + 1]);
+			if (high == 0xFF || low == 0xFF)
+			{
+				return false;
+			}
+			data.push_back(static_cast<uint8_t>((high << 4) | low));
+		}
+		return position == text.size();
+	}
+
+	bool SendAll(int fd, const char *data, size_t size)
+	{
+		while (size > 0)
+		{
+			ssize_t sent = send(fd, data, size, MSG_NOSIGNAL);
+			if (sent <= 0)
+			{
+				return false;
+			}
+			data += sent;
+			size -= static_cast<size_t>(sent);
+		}
+		return true;
+	}
+}
+
+VIPR_Emulator::GDBServer::GDBServer(COSMAC_VIP &System) : System(System), listen_fd(-1), client_fd(-1), no_ack(false), running(false), killed(false)
+{
+}
+
+VIPR_Emulator::GDBServer::~GDBServer()
+{
+	if (client_fd >= 0 && running)
+	{
+		SendPacket("W00"); // The run ended while the client was waiting on the machine
+	}
+	Disconnect();
+	if (listen_fd >= 0)
+	{
+		close(listen_fd);
+	}
+	if (unix_path.size() > 0)
+	{
+		unlink(unix_path.c_str());
+	}
+}
+
+bool VIPR_Emulator::GDBServer::Listen(const std::string &address)
+{
+	if (address.starts_with("unix:"))
+	{
+		unix_path = address.substr(5);
+		sockaddr_un unix_address {};
+		if (unix_path.size() == 0 || unix_path.size() >= sizeof(unix_address.sun_path))
+		{
+			fmt::print("Invalid GDB socket path '{}'.\n", unix_path);
+			unix_path.clear();
+			return false;
+		}
+		unix_address.sun_family = AF_UNIX;
+		std::memcpy(unix_address.sun_path, unix_path.c_str(), unix_path.size());
+		unlink(unix_path.c_str()); // Left behind by an earlier run that didn't exit cleanly
+		listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr *>(&unix_address), sizeof(unix_address)) < 0 || listen(listen_fd, 1) < 0)
+		{
+			fmt::print("Unable to listen for GDB on '{}'.\n", unix_path);
+			unix_path.clear();
+			return false;
+		}
+	}
+	else
+	{
+		char *end = nullptr;
+		unsigned long port = std::strtoul(address.c_str(), &end, 10);
+		if (address.size() == 0 || *end != '\0' || port == 0 || port > 0xFFFF)
+		{
+			fmt::print("Invalid GDB port '{}'.\n", address);
+			return false;
+		}
+		sockaddr_in tcp_address {};
+		tcp_address.sin_family = AF_INET;
+		tcp_address.sin_port = htons(static_cast<uint16_t>(port));
+		tcp_address.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // Memory can be written through the stub, so it's never exposed beyond this machine
+		listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+		int reuse = 1;
+		if (listen_fd >= 0)
+		{
+			setsockopt(listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+		}
+		if (listen_fd < 0 || bind(listen_fd, reinterpret_cast<sockaddr *>(&tcp_address), sizeof(tcp_address)) < 0 || listen(listen_fd, 1) < 0)
+		{
+			fmt::print("Unable to listen for GDB on port {}.\n", port);
+			return false;
+		}
+	}
+	return true;
+}
+
+bool VIPR_Emulator::GDBServer::WaitForClient()
+{
+	if (listen_fd < 0)
+	{
+		return false;
+	}
+	fmt::print("Waiting for GDB to connect.\n");
+	client_fd = accept(listen_fd, nullptr, nullptr);
+	if (client_fd < 0)
+	{
+		fmt::print("Unable to accept a GDB connection.\n");
+		return false;
+	}
+	if (unix_path.size() == 0)
+	{
+		int no_delay = 1; // Packets are small and strictly request/reply
+		setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+	}
+	fmt::print("GDB connected.\n");
+	input_buffer.clear();
+	no_ack = false;
+	running = false;
+	Debug.ClearBreakpoints();
+	Debug.Continue();
+	Debug.Pause(); // Clients expect the target to be stopped once they attach
+	System.AttachDebugger(&Debug);
+	return true;
+}
+
+void VIPR_Emulator::GDBServer::Disconnect()
+{
+	if (client_fd >= 0)
+	{
+		close(client_fd);
+		client_fd = -1;
+		Debug.ClearBreakpoints();
+		Debug.Continue();
+		System.AttachDebugger(nullptr); // Back to the plain core and memory bus
+		fmt::print("GDB disconnected.\n");
+	}
+}
+
+void VIPR_Emulator::GDBServer::RunMachineClocks(uint32_t clocks)
+{
+	uint32_t clocks_left = clocks;
+	while (clocks_left > 0 && client_fd >= 0)
+	{
+		if (!ReceiveData(false))
+		{
+			Disconnect();
+			break;
+		}
+		ProcessInput();
+		if (Debug.IsStopped())
+		{
+			if (running)
+			{
+				SendStopReply();
+				running = false;
+			}
+			if (!ReceiveData(true))
+			{
+				Disconnect();
+				break;
+			}
+			ProcessInput();
+			continue;
+		}
+		uint32_t chunk_clocks = std::min(clocks_left, gdb_poll_clocks);
+		uint64_t start_cycle = System.GetMachineCycleCount();
+		System.RunMachineClocks(chunk_clocks);
+		clocks_left -= Debug.IsStopped() ? static_cast<uint32_t>(std::min<uint64_t>(clocks_left, (System.GetMachineCycleCount() - start_cycle) * 8)) : chunk_clocks; // A stop drops the rest of the chunk
+	}
+	if (client_fd < 0 && clocks_left > 0 && !killed)
+	{
+		System.RunMachineClocks(clocks_left);
+	}
+}
+
+bool VIPR_Emulator::GDBServer::ReceiveData(bool blocking)
+{
+	pollfd client_poll { client_fd, POLLIN, 0 };
+	int ready = poll(&client_poll, 1, blocking ? -1 : 0);
+	if (ready <= 0)
+	{
+		return ready == 0 || errno == EINTR;
+	}
+	std::array<char, 4096> receive_buffer;
+	ssize_t received = recv(client_fd, receive_buffer.data(), receive_buffer.size(), 0);
+	if (received <= 0)
+	{
+		return false;
+	}
+	input_buffer.append(receive_buffer.data(), static_cast<size_t>(received));
+	return true;
+}
+
+void VIPR_Emulator::GDBServer::ProcessInput()
+{
+	size_t position = 0;
+	while (position < input_buffer.size() && client_fd >= 0)
+	{
+		char current_char = input_buffer[position];
+		if (current_char == 0x03) // Interrupt, sent out of band while the target runs
+		{
+			Debug.Pause();
+			++position;
+		}
+		else if (current_char == '$')
+		{
+			size_t end = input_buffer.find('#', position);
+			if (end == std::string::npos || end + 2 >= input_buffer.size())
+			{
+				break; // Wait for the rest of the packet
+			}
+			std::string packet = input_buffer.substr(position + 1, end - position - 1);
+			uint8_t checksum = 0;
+			for (char packet_char : packet)
+			{
+				checksum += static_cast<uint8_t>(packet_char);
+			}
+			uint8_t expected_checksum = static_cast<uint8_t>((ParseHexDigit(input_buffer[end + 1]) << 4) | ParseHexDigit(input_buffer[end + 2]));
+			position = end + 3;
+			if (!no_ack)
+			{
+				SendAll(client_fd, (checksum == expected_checksum) ? "+" : "-", 1);
+			}
+			if (checksum == expected_checksum || no_ack)
+			{
+				HandlePacket(packet);
+			}
+		}
+		else // Acknowledgements and anything between packets
+		{
+			++position;
+		}
+	}
+	if (client_fd >= 0)
+	{
+		input_buffer.erase(0, position);
+	}
+}
+
+void VIPR_Emulator::GDBServer::SendPacket(const std::string &data)
+{
+	uint8_t checksum = 0;
+	for (char data_char : data)
+	{
+		checksum += static_cast<uint8_t>(data_char);
+	}
+	std::string packet = fmt::format("${}#{:02x}", data, checksum);
+	if (!SendAll(client_fd, packet.data(), packet.size()))
+	{
+		Disconnect();
+	}
+}
+
+void VIPR_Emulator::GDBServer::SendStopReply()
+{
+	switch (Debug.GetStopReason())
+	{
+		case StopReason::Write:
+		case StopReason::Watch:
+		{
+			SendPacket(fmt::format("T05watch:{:x};", Debug.GetStopAddress()));
+			break;
+		}
+		case StopReason::Read:
+		{
+			SendPacket(fmt::format("T05rwatch:{:x};", Debug.GetStopAddress()));
+			break;
+		}
+		case StopReason::Pause:
+		{
+			SendPacket("T02"); // SIGINT, as the client asked for it
+			break;
+		}
+		default:
+		{
+			SendPacket("T05");
+			break;
+		}
+	}
+}
+
+std::string VIPR_Emulator::GDBServer::ReadRegisters()
+{
+	CPURegisters Registers = System.GetCPURegisters();
+	std::string data;
+	data.reserve(16 * 4 + 7 * 2);
+	for (uint16_t value : Registers.R)
+	{
+		data += fmt::format("{:04x}", value);
+	}
+	data += fmt::format("{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}{:02x}", Registers.D, Registers.DF, Registers.P, Registers.X, Registers.T, Registers.Q, Registers.IE);
+	return data;
+}
+
+bool VIPR_Emulator::GDBServer::WriteRegisters(const std::string &data)
+{
+	std::vector<uint8_t> bytes;
+	if (!ParseHexBytes(data, 0, bytes) || bytes.size() != 16 * 2 + 7)
+	{
+		return false;
+	}
+	CPURegisters Registers;
+	for (size_t i = 0; i < Registers.R.size(); ++i)
+	{
+		Registers.R[i] = static_cast<uint16_t>((bytes[i * 2] << 8) | bytes[(i * 2) + 1]);
+	}
+	Registers.D = bytes[32];
+	Registers.DF = bytes[33];
+	Registers.P = bytes[34];
+	Registers.X = bytes[35];
+	Registers.T = bytes[36];
+	Registers.Q = bytes[37];
+	Registers.IE = bytes[38];
+	System.SetCPURegisters(Registers);
+	return true;
+}
+
+bool VIPR_Emulator::GDBServer::SetBreakpoint(const std::string &packet, bool insert) // Z/z type,address,kind
+{
+	size_t position = 3;
+	uint32_t address = 0;
+	if (packet.size() < 4 || packet[2] != ',' || !ParseHex(packet, position, address) || address > 0xFFFF)
+	{
+		return false;
+	}
+	std::vector<BreakpointType> types;
+	switch (packet[1])
+	{
+		case '0': // Software and hardware breakpoints are the same thing here
+		case '1':
+		{
+			types = { BreakpointType::Execute };
+			break;
+		}
+		case '2':
+		{
+			types = { BreakpointType::Write };
+			break;
+		}
+		case '3':
+		{
+			types = { BreakpointType::Read };
+			break;
+		}
+		case '4':
+		{
+			types = { BreakpointType::Read, BreakpointType::Write };
+			break;
+		}
+		default:
+		{
+			return false;
+		}
+	}
+	for (BreakpointType type : types)
+	{
+		if (insert)
+		{
+			Debug.AddBreakpoint(type, static_cast<uint16_t>(address)); // Already being set isn't an error to the client
+		}
+		else
+		{
+			Debug.RemoveBreakpoint(type, static_cast<uint16_t>(address));
+		}
+	}
+	System.AttachDebugger(&Debug);
+	return true;
+}
+
+void VIPR_Emulator::GDBServer::HandlePacket(const std::string &packet)
+{
+	if (packet.size() == 0)
+	{
+		SendPacket("");
+		return;
+	}
+	switch (packet[0])
+	{
+		case '?':
+		{
+			SendStopReply();
+			break;
+		}
+		case 'g':
+		{
+			SendPacket(ReadRegisters());
+			break;
+		}
+		case 'G':
+		{
+			SendPacket(WriteRegisters(packet.substr(1)) ? "OK" : "E01");
+			break;
+		}
+		case 'p':
+		{
+			size_t position = 1;
+			uint32_t register_number = 0;
+			if (!ParseHex(packet, position, register_number) || register_number >= gdb_register_count)
+			{
+				SendPacket("E01");
+				break;
+			}
+			std::string data = ReadRegisters();
+			SendPacket((register_number < 16) ? data.substr(register_number * 4, 4) : data.substr(64 + ((register_number - 16) * 2), 2));
+			break;
+		}
+		case 'P':
+		{
+			size_t position = 1;
+			uint32_t register_number = 0;
+			uint32_t value = 0;
+			if (!ParseHex(packet, position, register_number) || register_number >= gdb_register_count || position >= packet.size() || packet[position] != '=')
+			{
+				SendPacket("E01");
+				break;
+			}
+			++position;
+			ParseHex(packet, position, value);
+			std::string data = ReadRegisters(); // Patched and written back whole
+			if (register_number < 16)
+			{
+				data.replace(register_number * 4, 4, fmt::format("{:04x}", value & 0xFFFF));
+			}
+			else
+			{
+				data.replace(64 + ((register_number - 16) * 2), 2, fmt::format("{:02x}", value & 0xFF));
+			}
+			SendPacket(WriteRegisters(data) ? "OK" : "E01");
+			break;
+		}
+		case 'm':
+		{
+			size_t position = 1;
+			uint32_t address = 0;
+			uint32_t length = 0;
+			if (!ParseHex(packet, position, address) || position >= packet.size() || packet[position++] != ',' || !ParseHex(packet, position, length))
+			{
+				SendPacket("E01");
+				break;
+			}
+			std::string data;
+			length = std::min<uint32_t>(length, 0x800);
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				data += fmt::format("{:02x}", System.PeekMemory(static_cast<uint16_t>(address + i)));
+			}
+			SendPacket(data);
+			break;
+		}
+		case 'M':
+		{
+			size_t position = 1;
+			uint32_t address = 0;
+			uint32_t length = 0;
+			std::vector<uint8_t> bytes;
+			if (!ParseHex(packet, position, address) || position >= packet.size() || packet[position++] != ',' || !ParseHex(packet, position, length) || position >= packet.size() || packet[position++] != ':' || !ParseHexBytes(packet, position, bytes) || bytes.size() != length)
+			{
+				SendPacket("E01");
+				break;
+			}
+			for (uint32_t i = 0; i < length; ++i)
+			{
+				System.PokeMemory(static_cast<uint16_t>(address + i), bytes[i]);
+			}
+			SendPacket("OK");
+			break;
+		}
+		case 'c':
+		case 's':
+		{
+			if (packet.size() > 1) // Resuming at an address
+			{
+				size_t position = 1;
+				uint32_t address = 0;
+				if (ParseHex(packet, position, address))
+				{
+					CPURegisters Registers = System.GetCPURegisters();
+					Registers.R[Registers.P] = static_cast<uint16_t>(address);
+					System.SetCPURegisters(Registers);
+				}
+			}
+			if (packet[0] == 'c')
+			{
+				Debug.Continue();
+			}
+			else
+			{
+				Debug.Step();
+			}
+			running = true;
+			break;
+		}
+		case 'Z':
+		case 'z':
+		{
+			SendPacket(SetBreakpoint(packet, packet[0] == 'Z') ? "OK" : "");
+			break;
+		}
+		case 'H':
+		case 'T':
+		{
+			SendPacket("OK"); // There's only the one thread
+			break;
+		}
+		case 'D':
+		{
+			SendPacket("OK");
+			Disconnect();
+			break;
+		}
+		case 'k':
+		{
+			killed = true;
+			Disconnect();
+			break;
+		}
+		case 'q':
+		case 'Q':
+		{
+			if (packet.starts_with("qSupported"))
+			{
+				SendPacket("PacketSize=1000;qXfer:features:read+;QStartNoAckMode+");
+			}
+			else if (packet == "QStartNoAckMode")
+			{
+				SendPacket("OK");
+				no_ack = true;
+			}
+			else if (packet.starts_with("qXfer:features:read:target.xml:"))
+			{
+				size_t position = 31;
+				uint32_t offset = 0;
+				uint32_t length = 0;
+				if (!ParseHex(packet, position, offset) || position >= packet.size() || packet[position++] != ',' || !ParseHex(packet, position, length))
+				{
+					SendPacket("E01");
+					break;
+				}
+				std::string description = GetTargetDescription();
+				if (offset >= description.size())
+				{
+					SendPacket("l");
+				}
+				else
+				{
+					std::string chunk = description.substr(offset, length);
+					SendPacket(((offset + chunk.size() < description.size()) ? "m" : "l") + chunk);
+				}
+			}
+			else if (packet == "qAttached")
+			{
+				SendPacket("1");
+			}
+			else if (packet == "qC")
+			{
+				SendPacket("QC1");
+			}
+			else if (packet == "qfThreadInfo")
+			{
+				SendPacket("m1");
+			}
+			else if (packet == "qsThreadInfo")
+			{
+				SendPacket("l");
+			}
+			else
+			{
+				SendPacket("");
+			}
+			break;
+		}
+		default:
+		{
+			SendPacket(""); // Unsupported
+			break;
+		}
+	}
+}
+
+std::string VIPR_Emulator::GDBServer::GetTargetDescription()
+{
+	std::string description = "<?xml version=\"1.0\"?>\n<!DOCTYPE target SYSTEM \"gdb-target.dtd\">\n<target version=\"1.0\">\n<feature name=\"org.vipr.cdp1802\">\n";
+	for (size_t i = 0; i < 16; ++i)
+	{
+		description += fmt::format("<reg name=\"r{}\" bitsize=\"16\" type=\"uint16\" regnum=\"{}\"/>\n", i, i); // Any of them can be the program counter, as picked by P
+	}
+	constexpr std::array<const char *, 7> byte_registers = { "d", "df", "p", "x", "t", "q", "ie" };
+	for (size_t i = 0; i < byte_registers.size(); ++i)
+	{
+		description += fmt::format("<reg name=\"{}\" bitsize=\"8\" type=\"uint8\" regnum=\"{}\"/>\n", byte_registers[i], 16 + i);
+	}
+	description += "</feature>\n</target>\n";
+	return description;
+}
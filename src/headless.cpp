@@ -0,0 +1,533 @@
+#include "headless.hpp"
+#include "capture.hpp"
+#include "wave_writer.hpp"
+#include "xxhash.hpp"
+#include "trace.hpp"
+#ifdef VIPR_ENABLE_GDB_SERVER
+#include "gdb_server.hpp"
+#endif
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <fmt/core.h>
+
+void VIPR_Emulator::headless_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata) // Chains an XXH64 over every rendered sample, so identical runs report identical audio
+{
+	HeadlessAudioOutput *output = static_cast<HeadlessAudioOutput *>(userdata);
+	output->hash = XXHash64(samples, sample_count * sizeof(int), output->hash);
+	output->sample_count += sample_count;
+	if (output->Recorder != nullptr)
+	{
+		output->Recorder->SubmitAudio(samples, sample_count, sample_rate);
+	}
+	if (output->AudioDump != nullptr)
+	{
+		output->AudioDump->SubmitAudio(samples, sample_count, sample_rate);
+	}
+}
+
+VIPR_Emulator::HeadlessRunner::HeadlessRunner(COSMAC_VIP &System) : System(System)
+{
+}
+
+VIPR_Emulator::HeadlessRunner::~HeadlessRunner()
+{
+}
+
+void VIPR_Emulator::HeadlessRunner::Run(const std::vector<ScriptEvent> &events, uint32_t frame_count, std::vector<uint64_t> &frame_hashes, GDBServer *Remote)
+{
+	size_t current_event = 0;
+	frame_hashes.resize(frame_count);
+	for (uint32_t frame = 0; frame < frame_count; ++frame)
+	{
+		for (; current_event < events.size() && events[current_event].frame == frame; ++current_event)
+		{
+			const ScriptEvent &event = events[current_event];
+			switch (event.type)
+			{
+				case ScriptEventType::Run:
+				{
+					System.SetRunSwitch(true);
+					break;
+				}
+				case ScriptEventType::Reset:
+				{
+					System.SetRunSwitch(false);
+					break;
+				}
+				case ScriptEventType::Press:
+				{
+					System.IssueHexKeyPress(event.hex_key, event.keypad);
+					break;
+				}
+				case ScriptEventType::Release:
+				{
+					System.IssueHexKeyRelease(event.keypad);
+					break;
+				}
+			}
+		}
+		if (System.IsRunning())
+		{
+#ifdef VIPR_ENABLE_GDB_SERVER
+			if (Remote != nullptr)
+			{
+				Remote->RunMachineClocks(clocks_per_frame);
+				if (Remote->IsKilled())
+				{
+					frame_hashes.resize(frame);
+					break;
+				}
+			}
+			else
+			{
+				System.RunMachineClocks(clocks_per_frame);
+			}
+#else
+			static_cast<void>(Remote); // Always null without the GDB server
+			System.RunMachineClocks(clocks_per_frame);
+#endif
+		}
+		frame_hashes[frame] = System.GetLastFrame().hash;
+	}
+}
+
+bool VIPR_Emulator::WriteTextFile(const std::string &text_file, const std::string &text)
+{
+	std::ofstream output(text_file, std::ios::trunc);
+	if (output.fail())
+	{
+		fmt::print("Unable to write '{}'.\n", text_file);
+		return false;
+	}
+	output << text;
+	return true;
+}
+
+bool VIPR_Emulator::LoadROMFile(const std::string &rom_file, MappedFile &ROMImage)
+{
+	if (!ROMImage.Open(rom_file, MappedFileMode::Read))
+	{
+		fmt::print("Unable to load ROM file '{}'.\n", rom_file);
+		return false;
+	}
+	if (ROMImage.GetSize() > 32768)
+	{
+		ROMImage.Close();
+		fmt::print("ROM file '{}' is too large.\n", rom_file);
+		return false;
+	}
+	return true;
+}
+
+void VIPR_Emulator::SetupHeadlessMachine(COSMAC_VIP &System, uint8_t ram_kb, const std::array<bool, 5> &ExpansionBoard, MappedFile &&ROMImage)
+{
+	System.AdjustRAM(ram_kb);
+	System.InstallROM(std::move(ROMImage));
+	for (uint8_t i = 0; i < ExpansionBoard.size(); ++i)
+	{
+		if (ExpansionBoard[i])
+		{
+			System.InstallExpansionBoard(static_cast<ExpansionBoardType>(i));
+		}
+	}
+}
+
+size_t VIPR_Emulator::CompareGoldenFrames(const std::vector<uint64_t> &golden_hashes, const std::vector<uint64_t> &frame_hashes, bool report_mismatches)
+{
+	size_t mismatches = 0;
+	for (size_t i = 0; i < frame_hashes.size(); ++i)
+	{
+		if (i >= golden_hashes.size() || golden_hashes[i] != frame_hashes[i])
+		{
+			if (report_mismatches && mismatches < 10)
+			{
+				fmt::print("Frame {}: Expected {:016x}, Got {:016x}\n", i, (i < golden_hashes.size()) ? golden_hashes[i] : 0, frame_hashes[i]);
+			}
+			++mismatches;
+		}
+	}
+	if (golden_hashes.size() != frame_hashes.size())
+	{
+		if (report_mismatches)
+		{
+			fmt::print("Frame count differs (Golden: {}, Run: {}).\n", golden_hashes.size(), frame_hashes.size());
+		}
+		++mismatches;
+	}
+	return mismatches;
+}
+
+bool VIPR_Emulator::LoadInputScript(const std::string &script_file, std::vector<ScriptEvent> &events)
+{
+	std::ifstream input_script(script_file);
+	if (input_script.fail())
+	{
+		fmt::print("Unable to open input script '{}'.\n", script_file);
+		return false;
+	}
+	std::string line;
+	for (size_t line_number = 1; std::getline(input_script, line); ++line_number)
+	{
+		line = line.substr(0, line.find('#'));
+		if (line.find_first_not_of(" \t\r") == std::string::npos)
+		{
+			continue;
+		}
+		std::istringstream current_stream(line);
+		uint32_t frame = 0;
+		std::string command;
+		if (!(current_stream >> frame >> command))
+		{
+			fmt::print("Invalid input script line {}: '{}'\n", line_number, line);
+			return false;
+		}
+		ScriptEvent event = { frame, ScriptEventType::Run, 0x0, 0 };
+		uint32_t keypad = 0;
+		if (command == "run")
+		{
+			event.type = ScriptEventType::Run;
+		}
+		else if (command == "reset")
+		{
+			event.type = ScriptEventType::Reset;
+		}
+		else if (command == "press")
+		{
+			uint32_t hex_key = 0;
+			if (!(current_stream >> std::hex >> hex_key) || hex_key > 0xF)
+			{
+				fmt::print("Invalid hex key on input script line {}.\n", line_number);
+				return false;
+			}
+			event.type = ScriptEventType::Press;
+			event.hex_key = hex_key;
+			if (current_stream >> std::dec >> keypad)
+			{
+				event.keypad = (keypad > 0) ? 1 : 0;
+			}
+		}
+		else if (command == "release")
+		{
+			event.type = ScriptEventType::Release;
+			if (current_stream >> keypad)
+			{
+				event.keypad = (keypad > 0) ? 1 : 0;
+			}
+		}
+		else
+		{
+			fmt::print("Unknown command '{}' on input script line {}.\n", command, line_number);
+			return false;
+		}
+		events.push_back(event);
+	}
+	std::stable_sort(events.begin(), events.end(), [](const ScriptEvent &a, const ScriptEvent &b) { return a.frame < b.frame; });
+	return true;
+}
+
+bool VIPR_Emulator::LoadGoldenFile(const std::string &golden_file, std::vector<uint64_t> &frame_hashes)
+{
+	std::ifstream golden(golden_file);
+	if (golden.fail())
+	{
+		fmt::print("Unable to open golden file '{}'.\n", golden_file);
+		return false;
+	}
+	std::string line;
+	while (std::getline(golden, line))
+	{
+		if (line.size() == 0 || line[0] == '#')
+		{
+			continue;
+		}
+		std::istringstream current_stream(line);
+		uint32_t frame = 0;
+		uint64_t hash = 0;
+		if (!(current_stream >> frame >> std::hex >> hash))
+		{
+			fmt::print("Invalid golden file line: '{}'\n", line);
+			return false;
+		}
+		if (frame >= frame_hashes.size())
+		{
+			frame_hashes.resize(frame + 1);
+		}
+		frame_hashes[frame] = hash;
+	}
+	return true;
+}
+
+bool VIPR_Emulator::SaveGoldenFile(const std::string &golden_file, const std::vector<uint64_t> &frame_hashes)
+{
+	std::ofstream golden(golden_file);
+	if (golden.fail())
+	{
+		fmt::print("Unable to write golden file '{}'.\n", golden_file);
+		return false;
+	}
+	golden << "# VIPR Emulator Golden Frames (Frame, XXH64)\n";
+	for (size_t i = 0; i < frame_hashes.size(); ++i)
+	{
+		golden << fmt::format("{} {:016x}\n", i, frame_hashes[i]);
+	}
+	return true;
+}
+
+bool VIPR_Emulator::ParseExpansionBoard(const std::string &board, std::array<bool, 5> &ExpansionBoard)
+{
+	if (board == "vp585")
+	{
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP585_ExpansionKeypadInterface)] = true;
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP590_ColorBoard)] = false;
+	}
+	else if (board == "vp590")
+	{
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP590_ColorBoard)] = true;
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP585_ExpansionKeypadInterface)] = false;
+	}
+	else if (board == "vp595")
+	{
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP595_SimpleSoundBoard)] = true;
+	}
+	else if (board == "vp550")
+	{
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP550_SuperSoundBoard)] = true;
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP551_SuperSoundBoard)] = false;
+	}
+	else if (board == "vp551")
+	{
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP551_SuperSoundBoard)] = true;
+		ExpansionBoard[static_cast<uint8_t>(ExpansionBoardType::VP550_SuperSoundBoard)] = false;
+	}
+	else
+	{
+		fmt::print("Unknown expansion board '{}'.\n", board);
+		return false;
+	}
+	return true;
+}
+
+bool VIPR_Emulator::ParseHeadlessArguments(int argc, char *argv[], HeadlessOptions &options)
+{
+	options = HeadlessOptions { false, false, 2, 600, "", "", "", "", "", "", "", "", "", "", "", { false, false, false, false, false } };
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (argument == "--headless")
+		{
+			options.enabled = true;
+		}
+		else if (argument == "--update-golden")
+		{
+			options.update_golden = true;
+		}
+		else if (argument == "--rom" && has_value)
+		{
+			options.rom_file = argv[++i];
+		}
+		else if (argument == "--script" && has_value)
+		{
+			options.script_file = argv[++i];
+		}
+		else if (argument == "--golden" && has_value)
+		{
+			options.golden_file = argv[++i];
+		}
+		else if (argument == "--capture" && has_value)
+		{
+			options.capture_file = argv[++i];
+		}
+		else if (argument == "--audio-dump" && has_value)
+		{
+			options.audio_dump_file = argv[++i];
+		}
+		else if (argument == "--profile" && has_value)
+		{
+			options.profile_file = argv[++i];
+		}
+		else if (argument == "--profile-folded" && has_value)
+		{
+			options.profile_folded_file = argv[++i];
+		}
+		else if (argument == "--trace" && has_value)
+		{
+			options.trace_file = argv[++i];
+		}
+		else if (argument == "--instruction-trace" && has_value)
+		{
+			options.instruction_trace_file = argv[++i];
+		}
+		else if (argument == "--gdb" && has_value)
+		{
+			options.gdb_address = argv[++i];
+		}
+		else if (argument == "--ram-file" && has_value)
+		{
+			options.ram_file = argv[++i];
+		}
+		else if (argument == "--ram" && has_value)
+		{
+			int ram_kb = std::atoi(argv[++i]);
+			options.ram_kb = std::clamp(ram_kb, 1, 32);
+		}
+		else if (argument == "--frames" && has_value)
+		{
+			options.frame_count = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (argument == "--board" && has_value)
+		{
+			if (!ParseExpansionBoard(argv[++i], options.ExpansionBoard))
+			{
+				return false;
+			}
+		}
+		else
+		{
+			fmt::print("Unknown or incomplete argument '{}'.\n", argument);
+			return false;
+		}
+	}
+	return true;
+}
+
+int VIPR_Emulator::RunHeadless(const HeadlessOptions &options)
+{
+	if (options.rom_file.size() == 0)
+	{
+		fmt::print("A ROM file is required for headless mode.\n");
+		return -1;
+	}
+	if (options.trace_file.size() > 0 && !tracing_enabled)
+	{
+		fmt::print("Tracing isn't available; rebuild with VIPR_ENABLE_TRACING to use '--trace'.\n");
+		return -1;
+	}
+#ifndef VIPR_ENABLE_GDB_SERVER
+	if (options.gdb_address.size() > 0)
+	{
+		fmt::print("The GDB server isn't available on this platform, so '--gdb' can't be used.\n");
+		return -1;
+	}
+#endif
+	VIPR_TRACE_THREAD_NAME("Headless");
+	MappedFile ROMImage;
+	if (!LoadROMFile(options.rom_file, ROMImage))
+	{
+		return -1;
+	}
+	std::vector<ScriptEvent> events;
+	if (options.script_file.size() > 0)
+	{
+		if (!LoadInputScript(options.script_file, events))
+		{
+			return -1;
+		}
+	}
+	else
+	{
+		events.push_back(ScriptEvent { 0, ScriptEventType::Run, 0x0, 0 });
+	}
+	AudioEngine SoundEngine; // Audio is rendered from machine cycles, so it's deterministic in headless runs as well
+	COSMAC_VIP System;
+	SetupHeadlessMachine(System, options.ram_kb, options.ExpansionBoard, std::move(ROMImage));
+	if (options.ram_file.size() > 0 && !System.AttachRAMFile(options.ram_file))
+	{
+		fmt::print("Unable to map RAM file '{}'.\n", options.ram_file);
+		return -1;
+	}
+	VideoRecorder Recorder;
+	WaveWriter AudioDump;
+	HeadlessAudioOutput AudioOutput { 0, 0, nullptr, nullptr };
+	if (options.capture_file.size() > 0)
+	{
+		if (!Recorder.Start(options.capture_file, static_cast<uint32_t>(System.GetClockFrequency()), clocks_per_frame))
+		{
+			return -1;
+		}
+		Recorder.SetBlockWhenFull(true);
+		System.SetFrameOutput(VideoRecorder_frame_output, &Recorder);
+		AudioOutput.Recorder = &Recorder;
+	}
+	if (options.audio_dump_file.size() > 0)
+	{
+		if (!AudioDump.Start(options.audio_dump_file, audio_sample_rate))
+		{
+			return -1;
+		}
+		AudioDump.SetBlockWhenFull(true);
+		AudioOutput.AudioDump = &AudioDump;
+	}
+	std::unique_ptr<CPUProfiler> Profiler = nullptr;
+	if (options.profile_file.size() > 0 || options.profile_folded_file.size() > 0)
+	{
+		Profiler = std::make_unique<CPUProfiler>();
+		System.SetProfiler(Profiler.get());
+	}
+	std::unique_ptr<InstructionTrace> Trace = nullptr;
+	if (options.instruction_trace_file.size() > 0)
+	{
+		Trace = std::make_unique<InstructionTrace>();
+		System.SetInstructionTrace(Trace.get());
+	}
+	SoundEngine.SetAudioOutput(headless_audio_output, &AudioOutput);
+	System.AttachAudioEngine(&SoundEngine);
+	HeadlessRunner Runner(System);
+	std::vector<uint64_t> frame_hashes;
+#ifdef VIPR_ENABLE_GDB_SERVER
+	std::unique_ptr<GDBServer> Remote = nullptr;
+	if (options.gdb_address.size() > 0)
+	{
+		Remote = std::make_unique<GDBServer>(System);
+		if (!Remote->Listen(options.gdb_address) || !Remote->WaitForClient())
+		{
+			return -1;
+		}
+	}
+	Runner.Run(events, options.frame_count, frame_hashes, Remote.get());
+#else
+	Runner.Run(events, options.frame_count, frame_hashes);
+#endif
+	Recorder.Stop();
+	AudioDump.Stop();
+	if (options.trace_file.size() > 0 && !Tracer::Get().WriteChromeTrace(options.trace_file))
+	{
+		return -1;
+	}
+	if (Trace != nullptr && !Trace->WriteFile(options.instruction_trace_file))
+	{
+		return -1;
+	}
+	if (Profiler != nullptr)
+	{
+		if (options.profile_file.size() > 0 && !WriteTextFile(options.profile_file, Profiler->FormatReport(32)))
+		{
+			return -1;
+		}
+		if (options.profile_folded_file.size() > 0 && !WriteTextFile(options.profile_folded_file, Profiler->FormatFoldedStacks()))
+		{
+			return -1;
+		}
+	}
+	if (options.golden_file.size() == 0)
+	{
+		fmt::print("Final Frame Hash: {:016x}\n", frame_hashes.size() > 0 ? frame_hashes.back() : 0);
+		fmt::print("Audio Hash: {:016x} ({} samples)\n", AudioOutput.hash, AudioOutput.sample_count);
+		return 0;
+	}
+	if (options.update_golden)
+	{
+		return SaveGoldenFile(options.golden_file, frame_hashes) ? 0 : -1;
+	}
+	std::vector<uint64_t> golden_hashes;
+	if (!LoadGoldenFile(options.golden_file, golden_hashes))
+	{
+		return -1;
+	}
+	size_t mismatches = CompareGoldenFrames(golden_hashes, frame_hashes, true);
+	fmt::print("{} ({} of {} frames mismatched).\n", (mismatches == 0) ? "Passed" : "Failed", mismatches, frame_hashes.size());
+	return (mismatches == 0) ? 0 : 1;
+}
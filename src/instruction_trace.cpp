@@ -0,0 +1,68 @@
+#include "instruction_trace.hpp"
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <fmt/core.h>
+
+namespace
+{
+	template <typename T>
+	inline void WriteLE(std::ofstream &output, T value)
+	{
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			output.put(static_cast<char>(static_cast<uint64_t>(value) >> (i * 8)));
+		}
+	}
+}
+
+VIPR_Emulator::InstructionTrace::InstructionTrace(size_t entry_count) : Entries(std::make_unique<InstructionTraceEntry[]>(std::bit_ceil(std::max<size_t>(entry_count, 1)))), index_mask(std::bit_ceil(std::max<size_t>(entry_count, 1)) - 1), write_index(0)
+{
+}
+
+VIPR_Emulator::InstructionTrace::~InstructionTrace()
+{
+}
+
+void VIPR_Emulator::InstructionTrace::Clear()
+{
+	write_index = 0;
+}
+
+size_t VIPR_Emulator::InstructionTrace::GetEntryCount() const
+{
+	return static_cast<size_t>(std::min<uint64_t>(write_index, GetCapacity()));
+}
+
+bool VIPR_Emulator::InstructionTrace::WriteFile(const std::string &trace_file) const
+{
+	std::ofstream trace_output(trace_file, std::ios::binary | std::ios::trunc);
+	if (trace_output.fail())
+	{
+		fmt::print("Unable to create instruction trace file '{}'.\n", trace_file);
+		return false;
+	}
+	size_t entry_count = GetEntryCount();
+	uint64_t first_index = write_index - entry_count;
+	trace_output.write(instruction_trace_magic.data(), instruction_trace_magic.size());
+	WriteLE<uint32_t>(trace_output, static_cast<uint32_t>(entry_count));
+	WriteLE<uint32_t>(trace_output, static_cast<uint32_t>(std::min<uint64_t>(first_index, UINT32_MAX)));
+	for (uint64_t i = first_index; i < write_index; ++i) // Written field by field so the file doesn't depend on the host's byte order
+	{
+		const InstructionTraceEntry &CurrentEntry = Entries[i & index_mask];
+		WriteLE<uint64_t>(trace_output, CurrentEntry.machine_cycle);
+		WriteLE<uint16_t>(trace_output, CurrentEntry.address);
+		WriteLE<uint8_t>(trace_output, CurrentEntry.opcode);
+		WriteLE<uint8_t>(trace_output, CurrentEntry.D);
+		WriteLE<uint8_t>(trace_output, CurrentEntry.DF);
+		WriteLE<uint8_t>(trace_output, CurrentEntry.XP);
+		WriteLE<uint16_t>(trace_output, 0);
+	}
+	if (trace_output.fail())
+	{
+		fmt::print("Unable to write instruction trace file '{}'.\n", trace_file);
+		return false;
+	}
+	fmt::print("Wrote {} instructions to '{}'.\n", entry_count, trace_file);
+	return true;
+}
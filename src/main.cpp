@@ -1,10 +1,17 @@
 #include "application.hpp"
+#include "headless.hpp"
+#include <algorithm>
 #include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
 #include <fstream>
+#include <iterator>
 #include <sstream>
+#include <string_view>
 #include <ranges>
 
-VIPR_Emulator::Application::Application() : current_hex_key(0x0), key_down_callback(VIPR_Emulator::machine_key_down), key_up_callback(VIPR_Emulator::machine_key_up), current_operation_mode(OperationMode::Menu), InputFocus(nullptr), exit(false), fail(false), retcode(0)
+VIPR_Emulator::Application::Application(const Settings &LaunchSettings, const LaunchArguments &Arguments, SettingsStore &Store) : current_hex_key(0x0), key_down_callback(VIPR_Emulator::machine_key_down), key_up_callback(VIPR_Emulator::machine_key_up), current_operation_mode(OperationMode::Menu), Store(Store), InputFocus(nullptr), audio_stats_overlay(false), speed_overlay(false), overlay_refresh_ticks(0), overlay_machine_cycles(0), audio_devices_listed(false), exit(false), fail(false), retcode(0)
 {
 	SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
 	if (System.Fail())
@@ -49,13 +56,32 @@ VIPR_Emulator::Application::Application() : current_hex_key(0x0), key_down_callb
 		return;
 	}
 	System.SetupDisplay(&MainRenderer);
+	DisplayTimer.SetDisplay(&MainRenderer);
+	DisplayTimer.SetNominalFrameTime((clocks_per_frame * 1000.0) / System.GetClockFrequency());
+	System.AttachAudioEngine(&SoundEngine);
+	System.AttachDebugger(&Debug);
+	SoundEngine.SetAudioOutput(application_audio_output, this);
 	InitializeKeyMaps();
 	ConstructMenus();
-	GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&EmulatorOptionsMenu.element_list[1].element);
-	System.SetupAudio(OutputAudioDevice->choice_list[OutputAudioDevice->current_choice]);
 	CurrentMenu = &MainMenu;
-	DrawCurrentMenu();
 	SetOperationMode(OperationMode::Menu);
+	if (!ApplySettings(LaunchSettings, Arguments))
+	{
+		fail = true;
+		retcode = -1;
+		return;
+	}
+	SetupAudio();
+	if (current_operation_mode == OperationMode::Menu) // Otherwise the machine was started, and the font is loaded and the menu drawn once they're first shown
+	{
+		if (!MainRenderer.LoadMenuFont())
+		{
+			fail = true;
+			retcode = -1;
+			return;
+		}
+		DrawCurrentMenu();
+	}
 }
 
 VIPR_Emulator::Application::~Application()
@@ -65,6 +91,7 @@ VIPR_Emulator::Application::~Application()
 
 void VIPR_Emulator::Application::RunMainLoop()
 {
+	VIPR_TRACE_THREAD_NAME("Main");
 	while (!exit)
 	{
 		SDL_Event event;
@@ -90,30 +117,18 @@ void VIPR_Emulator::Application::RunMainLoop()
 				}
 				case SDL_AUDIODEVICEADDED:
 				{
-					std::vector<std::string> OutputAudioDeviceList(SDL_GetNumAudioDevices(0));
-					for (size_t i = 0; i < OutputAudioDeviceList.size(); ++i)
-					{
-						OutputAudioDeviceList[i] = SDL_GetAudioDeviceName(i, 0);
-					}
-					GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&EmulatorOptionsMenu.element_list[1].element);
-					OutputAudioDevice->choice_list = std::move(OutputAudioDeviceList);
-					size_t choice_count = OutputAudioDevice->choice_list.size();
-					if (OutputAudioDevice->current_choice >= choice_count)
-					{
-						if (choice_count > 0)
-						{
-							OutputAudioDevice->current_choice = OutputAudioDevice->choice_list.size() - 1;
-							System.SetupAudio(OutputAudioDevice->choice_list[OutputAudioDevice->current_choice]);
-						}
-					}
-					if (CurrentMenu == &EmulatorOptionsMenu)
+					if (!event.adevice.iscapture && audio_devices_listed) // Every device is announced at startup, which shouldn't force listing them
 					{
-						DrawCurrentMenu();
+						RefreshAudioDevices(false);
 					}
 					break;
 				}
 				case SDL_AUDIODEVICEREMOVED:
 				{
+					if (!event.adevice.iscapture)
+					{
+						RefreshAudioDevices(event.adevice.which == OutputStream.GetDeviceID());
+					}
 					break;
 				}
 				case SDL_QUIT:
@@ -123,9 +138,17 @@ void VIPR_Emulator::Application::RunMainLoop()
 				}
 			}
 		}
+		if ((audio_stats_overlay || speed_overlay) && SDL_TICKS_PASSED(SDL_GetTicks(), overlay_refresh_ticks))
+		{
+			UpdateOverlay();
+		}
 		if (System.IsRunning() && current_operation_mode == OperationMode::Machine)
 		{
 			System.RunMachine(std::chrono::high_resolution_clock::now());
+			if (Debug.IsStopped())
+			{
+				ShowDebugger();
+			}
 		}
 		else
 		{
@@ -336,10 +359,14 @@ int VIPR_Emulator::Application::GetReturnCode() const
 
 void VIPR_Emulator::Application::DrawCurrentMenu()
 {
-	MainRenderer.ClearSecondaryFramebuffer();
 	if (CurrentMenu != nullptr)
 	{
-		GUI::DrawElement(MainRenderer, *CurrentMenu);
+		GUI::DrawMenu(MainRenderer, *CurrentMenu, MenuRenderCache);
+	}
+	else
+	{
+		MainRenderer.ClearSecondaryFramebuffer();
+		MenuRenderCache.menu = nullptr;
 	}
 }
 
@@ -369,6 +396,275 @@ void VIPR_Emulator::Application::SetOperationMode(OperationMode mode)
 	}
 }
 
+void VIPR_Emulator::Application::SetupAudio()
+{
+	GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&EmulatorOptionsMenu.element_list[1].element);
+	GUI::Value *AudioLatency = std::get_if<GUI::Value>(&EmulatorOptionsMenu.element_list[3].element);
+	OutputStream.Open((OutputAudioDevice->current_choice < OutputAudioDevice->choice_list.size()) ? OutputAudioDevice->choice_list[OutputAudioDevice->current_choice] : std::string(), static_cast<uint16_t>(AudioLatency->value));
+}
+
+void VIPR_Emulator::Application::RefreshAudioDevices(bool output_device_removed) // Keeps the chosen device selected by name, since indices shift as devices come and go
+{
+	GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&EmulatorOptionsMenu.element_list[1].element);
+	std::string current_device = (OutputAudioDevice->current_choice < OutputAudioDevice->choice_list.size()) ? OutputAudioDevice->choice_list[OutputAudioDevice->current_choice] : std::string();
+	std::vector<std::string> OutputAudioDeviceList(SDL_GetNumAudioDevices(0));
+	for (size_t i = 0; i < OutputAudioDeviceList.size(); ++i)
+	{
+		OutputAudioDeviceList[i] = SDL_GetAudioDeviceName(i, 0);
+	}
+	OutputAudioDevice->choice_list = std::move(OutputAudioDeviceList);
+	std::vector<std::string>::iterator current_device_choice = std::find(OutputAudioDevice->choice_list.begin(), OutputAudioDevice->choice_list.end(), current_device);
+	if (current_device_choice != OutputAudioDevice->choice_list.end())
+	{
+		OutputAudioDevice->current_choice = current_device_choice - OutputAudioDevice->choice_list.begin();
+		if (output_device_removed) // Same name, but the device we had open went away (e.g. it was unplugged and another took its name)
+		{
+			SetupAudio();
+		}
+	}
+	else
+	{
+		OutputAudioDevice->current_choice = 0;
+		if (current_device.size() > 0 || output_device_removed || !OutputStream.IsOpen()) // The system default device stays open when devices are first listed
+		{
+			SetupAudio(); // Falls back to the system default device if no devices are listed
+		}
+	}
+	audio_devices_listed = true;
+	if (CurrentMenu == &EmulatorOptionsMenu)
+	{
+		DrawCurrentMenu();
+	}
+}
+
+void VIPR_Emulator::Application::ToggleCapture()
+{
+	if (Recorder.IsRecording())
+	{
+		System.SetFrameOutput(nullptr, nullptr);
+		Recorder.Stop();
+		fmt::print("Capture Stopped.\n");
+		return;
+	}
+	std::array<char, 32> time_string;
+	std::time_t current_time = std::time(nullptr);
+	std::strftime(time_string.data(), time_string.size(), "%Y%m%d_%H%M%S", std::localtime(&current_time));
+	std::string capture_file = fmt::format("vipr_capture_{}.vcap", time_string.data());
+	if (Recorder.Start(capture_file, static_cast<uint32_t>(System.GetClockFrequency()), clocks_per_frame))
+	{
+		System.SetFrameOutput(VideoRecorder_frame_output, &Recorder);
+		fmt::print("Capturing to '{}'.\n", capture_file);
+	}
+}
+
+void VIPR_Emulator::Application::ToggleAudioDump()
+{
+	if (AudioDump.IsRecording())
+	{
+		AudioDump.Stop();
+		fmt::print("Audio Dump Stopped.\n");
+		return;
+	}
+	std::array<char, 32> time_string;
+	std::time_t current_time = std::time(nullptr);
+	std::strftime(time_string.data(), time_string.size(), "%Y%m%d_%H%M%S", std::localtime(&current_time));
+	std::string audio_file = fmt::format("vipr_audio_{}.wav", time_string.data());
+	if (AudioDump.Start(audio_file, audio_sample_rate))
+	{
+		fmt::print("Dumping audio to '{}'.\n", audio_file);
+	}
+}
+
+void VIPR_Emulator::Application::ToggleInstructionTrace() // Tracing runs the CPU's instrumented core, so it's only on while asked for
+{
+	if (CPUTrace != nullptr)
+	{
+		std::array<char, 32> time_string;
+		std::time_t current_time = std::time(nullptr);
+		std::strftime(time_string.data(), time_string.size(), "%Y%m%d_%H%M%S", std::localtime(&current_time));
+		System.SetInstructionTrace(nullptr);
+		CPUTrace->WriteFile(fmt::format("vipr_itrace_{}.vitr", time_string.data()));
+		CPUTrace.reset();
+		return;
+	}
+	CPUTrace = std::make_unique<InstructionTrace>();
+	System.SetInstructionTrace(CPUTrace.get());
+	fmt::print("Tracing the last {} instructions.\n", CPUTrace->GetCapacity());
+}
+
+void VIPR_Emulator::Application::ToggleAudioStatsOverlay()
+{
+	audio_stats_overlay = !audio_stats_overlay;
+	UpdateOverlay();
+}
+
+void VIPR_Emulator::Application::ToggleSpeedOverlay() // The timer only sits in front of the renderer while the overlay is shown, so it costs nothing otherwise
+{
+	speed_overlay = !speed_overlay;
+	if (speed_overlay)
+	{
+		DisplayTimer.Reset();
+		overlay_machine_cycles = System.GetMachineCycleCount();
+		overlay_tp = std::chrono::steady_clock::now();
+	}
+	System.SetupDisplay(speed_overlay ? static_cast<DisplayOutput *>(&DisplayTimer) : &MainRenderer);
+	UpdateOverlay();
+}
+
+void VIPR_Emulator::Application::UpdateOverlay() // Refreshed a few times a second, which is also the window the speed and resample ratio are measured over
+{
+	overlay_refresh_ticks = SDL_GetTicks() + 250;
+	overlay_text.clear();
+	if (speed_overlay)
+	{
+		std::chrono::steady_clock::time_point current_tp = std::chrono::steady_clock::now();
+		uint64_t machine_cycles = System.GetMachineCycleCount();
+		double elapsed_seconds = std::chrono::duration<double>(current_tp - overlay_tp).count();
+		double clock_mhz = (elapsed_seconds > 0.0) ? ((machine_cycles - overlay_machine_cycles) * 8.0) / (elapsed_seconds * 1000000.0) : 0.0;
+		double nominal_mhz = System.GetClockFrequency() / 1000000.0;
+		overlay_machine_cycles = machine_cycles;
+		overlay_tp = current_tp;
+		FrameTimingStats stats = DisplayTimer.GetStats();
+		fmt::format_to(std::back_inserter(overlay_text), "Speed: {:.4f} MHz ({:.1f}% of {:.4f} MHz)\n", clock_mhz, (clock_mhz * 100.0) / nominal_mhz, nominal_mhz);
+		fmt::format_to(std::back_inserter(overlay_text), "Frame Time: p50 {:.1f} ms, p95 {:.1f} ms, p99 {:.1f} ms\n", stats.interval_p50, stats.interval_p95, stats.interval_p99);
+		fmt::format_to(std::back_inserter(overlay_text), "Render/Present: p50 {:.2f} ms, p99 {:.2f} ms\n", stats.render_p50, stats.render_p99);
+		fmt::format_to(std::back_inserter(overlay_text), "Audio Queue: {:.1f} ms  Late Frames: {} of {}\n", OutputStream.GetQueuedMilliseconds(), stats.late_frames, stats.frames);
+	}
+	if (audio_stats_overlay)
+	{
+		AudioStats stats = OutputStream.GetStats();
+		fmt::format_to(std::back_inserter(overlay_text), "Queued: {:.1f} ms (Target {:.1f} ms, Device {:.1f} ms)\n", stats.queued_ms, stats.target_ms, stats.device_ms);
+		fmt::format_to(std::back_inserter(overlay_text), "Underruns: {}  Overruns: {}\n", stats.underruns, stats.overruns);
+		fmt::format_to(std::back_inserter(overlay_text), "Ratio: {:.4f}  Callbacks: {}\n", stats.resample_ratio, stats.callbacks);
+		fmt::format_to(std::back_inserter(overlay_text), "Callback Time: p50 < {} us, p99 < {} us\n", AudioStats::GetPercentile(stats.callback_duration, 0.5), AudioStats::GetPercentile(stats.callback_duration, 0.99));
+		fmt::format_to(std::back_inserter(overlay_text), "Callback Gap: p50 < {} us, p99 < {} us\n", AudioStats::GetPercentile(stats.callback_interval, 0.5), AudioStats::GetPercentile(stats.callback_interval, 0.99));
+	}
+	MainRenderer.SetOverlayText(overlay_text); // Empty when neither overlay is shown, which hides it
+}
+
+void VIPR_Emulator::Application::DumpAudioStats()
+{
+	std::array<char, 32> time_string;
+	std::time_t current_time = std::time(nullptr);
+	std::strftime(time_string.data(), time_string.size(), "%Y%m%d_%H%M%S", std::localtime(&current_time));
+	std::string stats_file = fmt::format("vipr_audio_stats_{}.json", time_string.data());
+	std::ofstream stats_output(stats_file, std::ios::trunc);
+	if (stats_output.fail())
+	{
+		fmt::print("Unable to create audio stats file '{}'.\n", stats_file);
+		return;
+	}
+	stats_output << FormatAudioStats(OutputStream.GetStats());
+	fmt::print("Audio stats written to '{}'.\n", stats_file);
+}
+
+void VIPR_Emulator::Application::WriteTrace()
+{
+	if constexpr (!tracing_enabled)
+	{
+		fmt::print("Tracing isn't available; rebuild with VIPR_ENABLE_TRACING to record trace zones.\n");
+	}
+	else
+	{
+		std::array<char, 32> time_string;
+		std::time_t current_time = std::time(nullptr);
+		std::strftime(time_string.data(), time_string.size(), "%Y%m%d_%H%M%S", std::localtime(&current_time));
+		std::string trace_file = fmt::format("vipr_trace_{}.json", time_string.data());
+		Tracer::Get().WriteChromeTrace(trace_file);
+	}
+}
+
+void VIPR_Emulator::Application::ShowDebugger()
+{
+	System.IssueHexKeyRelease(0);
+	System.IssueHexKeyRelease(1);
+	OutputStream.Pause(true);
+	SetOperationMode(OperationMode::Menu);
+	MainRenderer.SetDisplayType(DisplayType::Emulator);
+	switch (Debug.GetStopReason()) // Memory stops bring the accessed address into view
+	{
+		case StopReason::Read:
+		case StopReason::Write:
+		case StopReason::Watch:
+		{
+			GUI::Value *MemoryAddress = std::get_if<GUI::Value>(&MachineDebuggerMenu.element_list[5].element);
+			MemoryAddress->value = Debug.GetStopAddress() & 0xFFF0;
+			break;
+		}
+		default:
+		{
+			break;
+		}
+	}
+	CurrentMenu = &MachineDebuggerMenu;
+	RefreshDebuggerMenu();
+	DrawCurrentMenu();
+}
+
+void VIPR_Emulator::Application::RefreshDebuggerMenu()
+{
+	GUI::Status *State = std::get_if<GUI::Status>(&MachineDebuggerMenu.element_list[1].element);
+	GUI::Value *MemoryAddress = std::get_if<GUI::Value>(&MachineDebuggerMenu.element_list[5].element);
+	GUI::Status *BreakpointList = std::get_if<GUI::Status>(&MachineDebuggerMenu.element_list[19].element);
+	State->status = Debug.FormatStopReason();
+	State->status_color = Debug.IsStopped() ? GUI::ColorData { 0xFF, 0xFF, 0x00 } : GUI::ColorData { 0x00, 0xFF, 0x00 };
+	CPURegisters Registers = System.GetCPURegisters();
+	for (size_t i = 0; i < 2; ++i)
+	{
+		GUI::Text *RegisterLine = std::get_if<GUI::Text>(&MachineDebuggerMenu.element_list[2 + i].element);
+		RegisterLine->text.clear();
+		for (size_t j = i * 8; j < (i + 1) * 8; ++j)
+		{
+			RegisterLine->text += fmt::format("R{:X} {:04X}  ", j, Registers.R[j]);
+		}
+	}
+	GUI::Text *StateLine = std::get_if<GUI::Text>(&MachineDebuggerMenu.element_list[4].element);
+	StateLine->text = fmt::format("D {:02X}  DF {}  P {:X}  X {:X}  T {:02X}  IE {}  Q {}  Cycle {}", Registers.D, Registers.DF, Registers.P, Registers.X, Registers.T, Registers.IE, Registers.Q, System.GetMachineCycleCount());
+	uint16_t memory_address = static_cast<uint16_t>(MemoryAddress->value & 0xFFF0);
+	for (uint16_t i = 0; i < debugger_memory_lines; ++i)
+	{
+		GUI::Text *MemoryLine = std::get_if<GUI::Text>(&MachineDebuggerMenu.element_list[6 + i].element);
+		uint16_t line_address = memory_address + (i * 16);
+		MemoryLine->text = fmt::format("{:04X}:", line_address);
+		for (uint16_t j = 0; j < 16; ++j)
+		{
+			MemoryLine->text += fmt::format(" {:02X}", System.PeekMemory(static_cast<uint16_t>(line_address + j)));
+		}
+	}
+	const std::vector<Breakpoint> &Breakpoints = Debug.GetBreakpoints();
+	if (Breakpoints.size() == 0)
+	{
+		BreakpointList->status = "None";
+		BreakpointList->status_color = { 0x40, 0x40, 0x40 };
+	}
+	else
+	{
+		constexpr size_t max_listed = 4; // What fits on one line
+		BreakpointList->status.clear();
+		for (size_t i = 0; i < Breakpoints.size() && i < max_listed; ++i)
+		{
+			std::string address = (Breakpoints[i].type == BreakpointType::ColorWatch) ? fmt::format("{:02X}", Breakpoints[i].address) : fmt::format("{:04X}", Breakpoints[i].address);
+			BreakpointList->status += fmt::format("{}{} {}", (i > 0) ? ", " : "", GetBreakpointTypeName(Breakpoints[i].type), address);
+		}
+		if (Breakpoints.size() > max_listed)
+		{
+			BreakpointList->status += fmt::format(" (+{} more)", Breakpoints.size() - max_listed);
+		}
+		BreakpointList->status_color = { 0xFF, 0xFF, 0xFF };
+	}
+}
+
+void VIPR_Emulator::application_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata) // The writers return right away unless they're recording
+{
+	Application *app = static_cast<Application *>(userdata);
+	if (app->OutputStream.IsOpen())
+	{
+		app->OutputStream.Write(samples, sample_count);
+	}
+	app->Recorder.SubmitAudio(samples, sample_count, sample_rate);
+	app->AudioDump.SubmitAudio(samples, sample_count, sample_rate);
+}
+
 void VIPR_Emulator::Application::ConstructMenus()
 {
 	constexpr GUI::ColorData main_menu_item_color { 0xA0, 0xA0, 0xA0 };
@@ -391,8 +687,9 @@ void VIPR_Emulator::Application::ConstructMenus()
 	MainMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Switch to Machine", 64, 60, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, true, false, nullptr } });
 	MainMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Machine Options", 64, 70, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
 	MainMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Machine Memory Transfer", 64, 80, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, true, false, nullptr } });
-	MainMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Emulator Options", 64, 90, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
-	MainMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Exit Emulator", 64, 100, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
+	MainMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Machine Debugger", 64, 90, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, true, false, nullptr } });
+	MainMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Emulator Options", 64, 100, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
+	MainMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Exit Emulator", 64, 110, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
 
 	MachineOptionsMenu.x = 152;
 	MachineOptionsMenu.y = 30;
@@ -424,6 +721,8 @@ void VIPR_Emulator::Application::ConstructMenus()
 	ExpansionBoardOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Toggle, GUI::Toggle { "VP-585 Expansion Keypad Interface", 0, 30, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, true, false, false, nullptr } });
 	ExpansionBoardOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Toggle, GUI::Toggle { "VP-590 Color Board", 0, 40, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, false, false, false, nullptr } });
 	ExpansionBoardOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Toggle, GUI::Toggle { "VP-595 Simple Sound Board", 0, 50, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, false, false, false, nullptr } });
+	ExpansionBoardOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Toggle, GUI::Toggle { "VP-550 Super Sound Board", 0, 60, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, false, false, false, nullptr } });
+	ExpansionBoardOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Toggle, GUI::Toggle { "VP-551 Super Sound Board", 0, 70, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, false, false, false, nullptr } });
 	ExpansionBoardOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Return to Machine Options", 184, 200, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
 
 	MachineMemoryTransferMenu.x = 136;
@@ -437,13 +736,43 @@ void VIPR_Emulator::Application::ConstructMenus()
 	MachineMemoryTransferMenu.on_activate = machine_memory_transfer_activate;
 	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Text, GUI::Text { "Machine Memory Transfer", 72, 0, GUI::ColorData { 0xC0, 0xC0, 0xC0 }, false } });
 	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Input, GUI::Input { "Memory File", "", "", 0, 50, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, 0, 32, 0, 0, true, false, false, machine_memory_transfer_memory_file_input_complete } });
-	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::MultiChoice, GUI::MultiChoice { "Transfer Type", 0, 60, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, 0, std::vector<std::string> { "Load", "Store" }, false, false } });
+	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::MultiChoice, GUI::MultiChoice { "Transfer Type", 0, 60, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, 0, std::vector<std::string> { "Load", "Store", "Attach", "Detach" }, false, false } });
 	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Start Address", "", 0, 70, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Hexadecimal, 0x0000, 0x0000, 0x7FFF, 0, false, false, false, machine_memory_transfer_start_address_input_complete } });
 	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Size", "", 0, 80, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Decimal, 512, 1, 32768, 0, false, false, false, machine_memory_transfer_size_input_complete } });
 	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Transfer", 0, 90, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, true, false } });
 	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Status, GUI::Status { "Transfer Status", "None", 0, 130, main_menu_item_color, GUI::ColorData { 0x40, 0x40, 0x40 }, false } });
 	MachineMemoryTransferMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Return to Main Menu", 80, 180, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
 
+	MachineDebuggerMenu.x = 16;
+	MachineDebuggerMenu.y = 10;
+	MachineDebuggerMenu.current_menu_item = 0;
+	MachineDebuggerMenu.hidden = false;
+	MachineDebuggerMenu.on_up = machine_debugger_up;
+	MachineDebuggerMenu.on_down = machine_debugger_down;
+	MachineDebuggerMenu.on_left = machine_debugger_left;
+	MachineDebuggerMenu.on_right = machine_debugger_right;
+	MachineDebuggerMenu.on_activate = machine_debugger_activate;
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Text, GUI::Text { "Machine Debugger", 240, 0, GUI::ColorData { 0xC0, 0xC0, 0xC0 }, false } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Status, GUI::Status { "State", "Running", 0, 20, main_menu_item_color, GUI::ColorData { 0x40, 0x40, 0x40 }, false } });
+	for (uint16_t i = 0; i < 3; ++i) // Registers, filled in by RefreshDebuggerMenu
+	{
+		MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Text, GUI::Text { "", 0, static_cast<uint16_t>(35 + (i * 10)), GUI::ColorData { 0xFF, 0xFF, 0xFF }, false } });
+	}
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Memory Address", "", 0, 70, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Hexadecimal, 0x0000, 0x0000, 0xFFFF, 0, true, false, false, machine_debugger_memory_address_input_complete } });
+	for (uint16_t i = 0; i < debugger_memory_lines; ++i) // Memory view, 16 bytes a line
+	{
+		MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Text, GUI::Text { "", 0, static_cast<uint16_t>(80 + (i * 10)), GUI::ColorData { 0xFF, 0xFF, 0xFF }, false } });
+	}
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Breakpoint Address", "", 0, 170, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Hexadecimal, 0x0000, 0x0000, 0xFFFF, 0, false, false, false, nullptr } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::MultiChoice, GUI::MultiChoice { "Breakpoint Type", 0, 180, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, 0, std::vector<std::string> { "Execute", "Read", "Write", "Watch", "Color RAM Watch" }, false, false } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Add Breakpoint", 0, 190, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Remove Breakpoint", 0, 200, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Clear Breakpoints", 0, 210, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Status, GUI::Status { "Breakpoints", "None", 0, 225, main_menu_item_color, GUI::ColorData { 0x40, 0x40, 0x40 }, false } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Step", 0, 245, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Continue", 0, 255, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
+	MachineDebuggerMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Return to Main Menu", 224, 280, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
+
 	EmulatorOptionsMenu.x = 132;
 	EmulatorOptionsMenu.y = 30;
 	EmulatorOptionsMenu.current_menu_item = 0;
@@ -454,16 +783,215 @@ void VIPR_Emulator::Application::ConstructMenus()
 	EmulatorOptionsMenu.on_right = emulator_options_right;
 	EmulatorOptionsMenu.on_activate = emulator_options_activate;
 	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Text, GUI::Text { "Emulator Options", 108, 0, GUI::ColorData { 0xC0, 0xC0, 0xC0 }, false } });
-	std::vector<std::string> OutputAudioDeviceList(SDL_GetNumAudioDevices(0));
-	for (size_t i = 0; i < OutputAudioDeviceList.size(); ++i)
-	{
-		OutputAudioDeviceList[i] = SDL_GetAudioDeviceName(i, 0);
-	}
-	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::MultiChoice, GUI::MultiChoice { "Output Audio Device", 0, 50, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, 0, std::move(OutputAudioDeviceList), true, false } });
+	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::MultiChoice, GUI::MultiChoice { "Output Audio Device", 0, 50, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, 0, std::vector<std::string>(), true, false } }); // Filled in by RefreshAudioDevices
 	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Main Volume", "", 0, 60, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Decimal, 50, 0, 100, 0, false, false, false, nullptr } });
+	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Audio Latency (In ms)", "", 0, 70, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Decimal, audio_latency_default, audio_latency_min, audio_latency_max, 0, false, false, false, nullptr } });
+	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Tone Generator Volume", "", 0, 90, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Decimal, 100, 0, 100, 0, false, false, false, nullptr } });
+	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "VP-595 Volume", "", 0, 100, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Decimal, 100, 0, 100, 0, false, false, false, nullptr } });
+	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "VP-550/VP-551 Volume", "", 0, 110, main_menu_item_color, main_menu_item_select_color, GUI::ColorData { 0xFF, 0xFF, 0xFF }, GUI::ValueBaseType::Decimal, 100, 0, 100, 0, false, false, false, nullptr } });
 	EmulatorOptionsMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Return to Main Menu", 114, 180, main_menu_item_color, main_menu_item_select_color, main_menu_item_disabled_color, false, false, false, nullptr } });
 }
 
+bool VIPR_Emulator::Application::ApplySettings(const Settings &LaunchSettings, const LaunchArguments &Arguments) // Sets up the machine and the menus showing it the same way the menus would
+{
+	GUI::Value *RAMInKB = std::get_if<GUI::Value>(&MachineOptionsMenu.element_list[1].element);
+	GUI::Input *ROMFile = std::get_if<GUI::Input>(&MachineOptionsMenu.element_list[2].element);
+	GUI::Button *LoadROM = std::get_if<GUI::Button>(&MachineOptionsMenu.element_list[3].element);
+	GUI::Status *ROMStatus = std::get_if<GUI::Status>(&MachineOptionsMenu.element_list[5].element);
+	GUI::Input *MemoryFile = std::get_if<GUI::Input>(&MachineMemoryTransferMenu.element_list[1].element);
+	GUI::MultiChoice *TransferType = std::get_if<GUI::MultiChoice>(&MachineMemoryTransferMenu.element_list[2].element);
+	GUI::Button *Transfer = std::get_if<GUI::Button>(&MachineMemoryTransferMenu.element_list[5].element);
+	GUI::Status *TransferStatus = std::get_if<GUI::Status>(&MachineMemoryTransferMenu.element_list[6].element);
+	GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&EmulatorOptionsMenu.element_list[1].element);
+	GUI::Value *MainVolume = std::get_if<GUI::Value>(&EmulatorOptionsMenu.element_list[2].element);
+	GUI::Value *AudioLatency = std::get_if<GUI::Value>(&EmulatorOptionsMenu.element_list[3].element);
+	RAMInKB->value = LaunchSettings.ram_kb;
+	AdjustRAM(LaunchSettings.ram_kb);
+	bool rom_installed = false;
+	bool ram_file_attached = true; // Nothing to attach counts as attached
+	if (LaunchSettings.rom_file.size() > 0)
+	{
+		MappedFile ROMImage;
+		if (LoadROMFile(LaunchSettings.rom_file, ROMImage))
+		{
+			System.InstallROM(std::move(ROMImage));
+			ROMStatus->status = "Installed";
+			ROMStatus->status_color = { 0x00, 0xFF, 0x00 };
+			rom_installed = true;
+		}
+		else if (Arguments.rom_file)
+		{
+			return false;
+		}
+		else
+		{
+			ROMStatus->status = "Failed";
+			ROMStatus->status_color = { 0xFF, 0x00, 0x00 };
+		}
+		ROMFile->stored_input = LaunchSettings.rom_file; // Kept on failure too, so it can be fixed or retried from the menu
+		LoadROM->disabled = false;
+	}
+	for (size_t i = 0; i < LaunchSettings.ExpansionBoard.size(); ++i)
+	{
+		GUI::Toggle *Board = std::get_if<GUI::Toggle>(&ExpansionBoardOptionsMenu.element_list[i + 1].element);
+		Board->toggle = LaunchSettings.ExpansionBoard[i];
+		if (LaunchSettings.ExpansionBoard[i])
+		{
+			System.InstallExpansionBoard(static_cast<ExpansionBoardType>(i));
+		}
+	}
+	if (LaunchSettings.ram_file.size() > 0)
+	{
+		MemoryFile->stored_input = LaunchSettings.ram_file;
+		TransferType->current_choice = 2;
+		Transfer->disabled = false;
+		if (System.AttachRAMFile(LaunchSettings.ram_file))
+		{
+			TransferStatus->status = "RAM Attached";
+			TransferStatus->status_color = { 0x00, 0xFF, 0x00 };
+		}
+		else
+		{
+			fmt::print("Unable to map RAM file '{}'.\n", LaunchSettings.ram_file);
+			if (Arguments.ram_file)
+			{
+				return false;
+			}
+			ram_file_attached = false;
+			TransferStatus->status = "Failed";
+			TransferStatus->status_color = { 0xFF, 0x00, 0x00 };
+		}
+	}
+	if (LaunchSettings.audio_device.size() > 0)
+	{
+		OutputAudioDevice->choice_list.push_back(LaunchSettings.audio_device); // Checked against the real devices once they're listed
+	}
+	MainVolume->value = LaunchSettings.volume;
+	AudioLatency->value = LaunchSettings.audio_latency;
+	SoundEngine.SetVolume(LaunchSettings.volume);
+	for (size_t i = 0; i < LaunchSettings.SourceVolume.size(); ++i)
+	{
+		GUI::Value *SourceVolume = std::get_if<GUI::Value>(&EmulatorOptionsMenu.element_list[i + 4].element);
+		SourceVolume->value = LaunchSettings.SourceVolume[i];
+		System.SetSourceVolume(static_cast<SoundSourceType>(i), LaunchSettings.SourceVolume[i]);
+	}
+	if (LaunchSettings.autostart && (!rom_installed || !ram_file_attached))
+	{
+		if (Arguments.autostart)
+		{
+			fmt::print("The machine can't be started with '--autostart' without its ROM and RAM file.\n");
+			return false;
+		}
+		fmt::print("The machine can't be started automatically without its ROM and RAM file, so the menu is shown instead.\n");
+	}
+	else if (LaunchSettings.autostart)
+	{
+		GUI::Toggle *MachinePower = std::get_if<GUI::Toggle>(&MainMenu.element_list[2].element);
+		GUI::Button *SwitchToMachine = std::get_if<GUI::Button>(&MainMenu.element_list[3].element);
+		GUI::Button *MachineOptions = std::get_if<GUI::Button>(&MainMenu.element_list[4].element);
+		GUI::Button *MachineMemoryTransfer = std::get_if<GUI::Button>(&MainMenu.element_list[5].element);
+		GUI::Button *MachineDebugger = std::get_if<GUI::Button>(&MainMenu.element_list[6].element);
+		MachinePower->toggle = true;
+		SwitchToMachine->disabled = false;
+		MachineOptions->disabled = true;
+		MachineMemoryTransfer->disabled = false;
+		MachineDebugger->disabled = false;
+		System.SetRunSwitch(true);
+		SDL_SetWindowTitle(MainWindow.get(), "VIPR Emulator (Running)");
+		SetOperationMode(OperationMode::Machine);
+		MainRenderer.SetDisplayType(DisplayType::Machine);
+		System.SetCPUCycleTimePoint(std::chrono::high_resolution_clock::now());
+		OutputStream.Pause(false);
+	}
+	return true;
+}
+
+void VIPR_Emulator::Application::AdjustRAM(uint8_t ram_kb)
+{
+	if (!System.AdjustRAM(ram_kb))
+	{
+		GUI::Status *TransferStatus = std::get_if<GUI::Status>(&MachineMemoryTransferMenu.element_list[6].element);
+		fmt::print("Unable to resize RAM file '{}' to {} KB, so it was detached.\n", Store.GetSettings().ram_file, ram_kb);
+		TransferStatus->status = "Failed";
+		TransferStatus->status_color = { 0xFF, 0x00, 0x00 };
+		Store.GetSettings().ram_file.clear();
+		Store.Save();
+	}
+}
+
+bool VIPR_Emulator::ParseLaunchArguments(int argc, char *argv[], Settings &LaunchSettings, LaunchArguments &Arguments)
+{
+	Arguments = LaunchArguments { false, false, false };
+	bool boards_given = false;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (argument == "--settings" && has_value)
+		{
+			++i; // Already used to find the settings file
+		}
+		else if (argument == "--autostart")
+		{
+			LaunchSettings.autostart = true;
+			Arguments.autostart = true;
+		}
+		else if (argument == "--rom" && has_value)
+		{
+			LaunchSettings.rom_file = argv[++i];
+			Arguments.rom_file = true;
+		}
+		else if (argument == "--ram-file" && has_value)
+		{
+			LaunchSettings.ram_file = argv[++i];
+			Arguments.ram_file = true;
+		}
+		else if (argument == "--ram" && has_value)
+		{
+			int ram_kb = std::atoi(argv[++i]);
+			LaunchSettings.ram_kb = std::clamp(ram_kb, 1, 32);
+		}
+		else if (argument == "--board" && has_value)
+		{
+			if (!boards_given) // Boards on the command line replace the ones from the settings file rather than adding to them
+			{
+				LaunchSettings.ExpansionBoard.fill(false);
+				boards_given = true;
+			}
+			std::string board = argv[++i];
+			if (board != "none" && !ParseExpansionBoard(board, LaunchSettings.ExpansionBoard))
+			{
+				return false;
+			}
+		}
+		else if (argument == "--volume" && has_value)
+		{
+			int volume = std::atoi(argv[++i]);
+			LaunchSettings.volume = std::clamp(volume, 0, 100);
+		}
+		else if (argument == "--audio-latency" && has_value)
+		{
+			int audio_latency = std::atoi(argv[++i]);
+			LaunchSettings.audio_latency = std::clamp<int>(audio_latency, audio_latency_min, audio_latency_max);
+		}
+		else if (argument == "--audio-device" && has_value)
+		{
+			LaunchSettings.audio_device = argv[++i];
+		}
+		else
+		{
+			fmt::print("Unknown or incomplete argument '{}'.\n", argument);
+			return false;
+		}
+	}
+	if (Arguments.autostart && LaunchSettings.rom_file.size() == 0)
+	{
+		fmt::print("A ROM file is required to start the machine with '--autostart'.\n");
+		return false;
+	}
+	return true;
+}
+
 void VIPR_Emulator::menu_key_down(Application *app, SDL_Scancode scancode, uint16_t modifiers)
 {
 	if (app == nullptr)
@@ -938,13 +1466,46 @@ void VIPR_Emulator::machine_key_down(VIPR_Emulator::Application *app, SDL_Scanco
 			SDL_SetWindowTitle(app->MainWindow.get(), "VIPR Emulator");
 		}
 	}
+	else if (scancode == SDL_SCANCODE_F5)
+	{
+		app->Debug.Pause(); // Shows the debugger once the current instruction finishes
+	}
+	else if (scancode == SDL_SCANCODE_F6)
+	{
+		app->ToggleInstructionTrace();
+	}
+	else if (scancode == SDL_SCANCODE_F7)
+	{
+		app->WriteTrace();
+	}
+	else if (scancode == SDL_SCANCODE_F8)
+	{
+		app->ToggleSpeedOverlay();
+	}
+	else if (scancode == SDL_SCANCODE_F9)
+	{
+		app->ToggleCapture();
+	}
+	else if (scancode == SDL_SCANCODE_F10)
+	{
+		app->ToggleAudioDump();
+	}
+	else if (scancode == SDL_SCANCODE_F11)
+	{
+		app->ToggleAudioStatsOverlay();
+	}
+	else if (scancode == SDL_SCANCODE_F12)
+	{
+		app->DumpAudioStats();
+	}
 	else if (scancode == SDL_SCANCODE_ESCAPE)
 	{
 		app->System.IssueHexKeyRelease(0);
 		app->System.IssueHexKeyRelease(1);
-		app->System.PauseAudio(true);
+		app->OutputStream.Pause(true);
 		app->SetOperationMode(OperationMode::Menu);
 		app->MainRenderer.SetDisplayType(DisplayType::Emulator);
+		app->DrawCurrentMenu(); // Nothing is drawn yet after starting straight into the machine, and only changes are redrawn otherwise
 	}
 }
 
@@ -991,8 +1552,9 @@ void VIPR_Emulator::main_menu_down(VIPR_Emulator::GUI::Menu &obj, void *userdata
 	GUI::Button *SwitchToMachine = std::get_if<GUI::Button>(&obj.element_list[3].element);
 	GUI::Button *MachineOptions = std::get_if<GUI::Button>(&obj.element_list[4].element);
 	GUI::Button *MachineMemoryTransfer = std::get_if<GUI::Button>(&obj.element_list[5].element);
-	GUI::Button *EmulatorOptions = std::get_if<GUI::Button>(&obj.element_list[6].element);
-	GUI::Button *ExitEmulator = std::get_if<GUI::Button>(&obj.element_list[7].element);
+	GUI::Button *MachineDebugger = std::get_if<GUI::Button>(&obj.element_list[6].element);
+	GUI::Button *EmulatorOptions = std::get_if<GUI::Button>(&obj.element_list[7].element);
+	GUI::Button *ExitEmulator = std::get_if<GUI::Button>(&obj.element_list[8].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -1017,16 +1579,21 @@ void VIPR_Emulator::main_menu_down(VIPR_Emulator::GUI::Menu &obj, void *userdata
 		}
 		case 4:
 		{
-			EmulatorOptions->select = false;
+			MachineDebugger->select = false;
 			break;
 		}
 		case 5:
+		{
+			EmulatorOptions->select = false;
+			break;
+		}
+		case 6:
 		{
 			ExitEmulator->select = false;
 			break;
 		}
 	}
-	obj.current_menu_item = (obj.current_menu_item == 5) ? 0 : obj.current_menu_item + 1;
+	obj.current_menu_item = (obj.current_menu_item == 6) ? 0 : obj.current_menu_item + 1;
 	bool selected = false;
 	while (!selected)
 	{
@@ -1079,9 +1646,9 @@ void VIPR_Emulator::main_menu_down(VIPR_Emulator::GUI::Menu &obj, void *userdata
 			}
 			case 4:
 			{
-				if (!EmulatorOptions->disabled)
+				if (!MachineDebugger->disabled)
 				{
-					EmulatorOptions->select = true;
+					MachineDebugger->select = true;
 					selected = true;
 				}
 				else
@@ -1092,14 +1659,27 @@ void VIPR_Emulator::main_menu_down(VIPR_Emulator::GUI::Menu &obj, void *userdata
 			}
 			case 5:
 			{
-				if (!ExitEmulator->disabled)
+				if (!EmulatorOptions->disabled)
 				{
-					ExitEmulator->select = true;
+					EmulatorOptions->select = true;
 					selected = true;
 				}
 				else
 				{
-					obj.current_menu_item = 0;
+					++obj.current_menu_item;
+				}
+				break;
+			}
+			case 6:
+			{
+				if (!ExitEmulator->disabled)
+				{
+					ExitEmulator->select = true;
+					selected = true;
+				}
+				else
+				{
+					obj.current_menu_item = 0;
 				}
 				break;
 			}
@@ -1115,8 +1695,9 @@ void VIPR_Emulator::main_menu_up(VIPR_Emulator::GUI::Menu &obj, void *userdata)
 	GUI::Button *SwitchToMachine = std::get_if<GUI::Button>(&obj.element_list[3].element);
 	GUI::Button *MachineOptions = std::get_if<GUI::Button>(&obj.element_list[4].element);
 	GUI::Button *MachineMemoryTransfer = std::get_if<GUI::Button>(&obj.element_list[5].element);
-	GUI::Button *EmulatorOptions = std::get_if<GUI::Button>(&obj.element_list[6].element);
-	GUI::Button *ExitEmulator = std::get_if<GUI::Button>(&obj.element_list[7].element);
+	GUI::Button *MachineDebugger = std::get_if<GUI::Button>(&obj.element_list[6].element);
+	GUI::Button *EmulatorOptions = std::get_if<GUI::Button>(&obj.element_list[7].element);
+	GUI::Button *ExitEmulator = std::get_if<GUI::Button>(&obj.element_list[8].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -1141,16 +1722,21 @@ void VIPR_Emulator::main_menu_up(VIPR_Emulator::GUI::Menu &obj, void *userdata)
 		}
 		case 4:
 		{
-			EmulatorOptions->select = false;
+			MachineDebugger->select = false;
 			break;
 		}
 		case 5:
+		{
+			EmulatorOptions->select = false;
+			break;
+		}
+		case 6:
 		{
 			ExitEmulator->select = false;
 			break;
 		}
 	}
-	obj.current_menu_item = (obj.current_menu_item == 0) ? 5 : obj.current_menu_item - 1;
+	obj.current_menu_item = (obj.current_menu_item == 0) ? 6 : obj.current_menu_item - 1;
 	bool selected = false;
 	while (!selected)
 	{
@@ -1202,6 +1788,19 @@ void VIPR_Emulator::main_menu_up(VIPR_Emulator::GUI::Menu &obj, void *userdata)
 				break;
 			}
 			case 4:
+			{
+				if (!MachineDebugger->disabled)
+				{
+					MachineDebugger->select = true;
+					selected = true;
+				}
+				else
+				{
+					--obj.current_menu_item;
+				}
+				break;
+			}
+			case 5:
 			{
 				if (!EmulatorOptions->disabled)
 				{
@@ -1214,7 +1813,7 @@ void VIPR_Emulator::main_menu_up(VIPR_Emulator::GUI::Menu &obj, void *userdata)
 				}
 				break;
 			}
-			case 5:
+			case 6:
 			{
 				if (!ExitEmulator->disabled)
 				{
@@ -1239,6 +1838,7 @@ void VIPR_Emulator::main_menu_left(VIPR_Emulator::GUI::Menu &obj, void *userdata
 	GUI::Button *SwitchToMachine = std::get_if<GUI::Button>(&obj.element_list[3].element);
 	GUI::Button *MachineOptions = std::get_if<GUI::Button>(&obj.element_list[4].element);
 	GUI::Button *MachineMemoryTransfer = std::get_if<GUI::Button>(&obj.element_list[5].element);
+	GUI::Button *MachineDebugger = std::get_if<GUI::Button>(&obj.element_list[6].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -1247,16 +1847,19 @@ void VIPR_Emulator::main_menu_left(VIPR_Emulator::GUI::Menu &obj, void *userdata
 			if (!MachinePower->toggle)
 			{
 				app->System.Reset();
+				app->Debug.Continue();
 				SDL_SetWindowTitle(app->MainWindow.get(), "VIPR Emulator");
 				SwitchToMachine->disabled = true;
 				MachineOptions->disabled = false;
 				MachineMemoryTransfer->disabled = true;
+				MachineDebugger->disabled = true;
 			}
 			else
 			{
 				SwitchToMachine->disabled = false;
 				MachineOptions->disabled = true;
 				MachineMemoryTransfer->disabled = false;
+				MachineDebugger->disabled = false;
 			}
 			break;
 		}
@@ -1271,6 +1874,7 @@ void VIPR_Emulator::main_menu_right(VIPR_Emulator::GUI::Menu &obj, void *userdat
 	GUI::Button *SwitchToMachine = std::get_if<GUI::Button>(&obj.element_list[3].element);
 	GUI::Button *MachineOptions = std::get_if<GUI::Button>(&obj.element_list[4].element);
 	GUI::Button *MachineMemoryTransfer = std::get_if<GUI::Button>(&obj.element_list[5].element);
+	GUI::Button *MachineDebugger = std::get_if<GUI::Button>(&obj.element_list[6].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -1279,16 +1883,19 @@ void VIPR_Emulator::main_menu_right(VIPR_Emulator::GUI::Menu &obj, void *userdat
 			if (!MachinePower->toggle)
 			{
 				app->System.Reset();
+				app->Debug.Continue();
 				SDL_SetWindowTitle(app->MainWindow.get(), "VIPR Emulator");
 				SwitchToMachine->disabled = true;
 				MachineOptions->disabled = false;
 				MachineMemoryTransfer->disabled = true;
+				MachineDebugger->disabled = true;
 			}
 			else
 			{
 				SwitchToMachine->disabled = false;
 				MachineOptions->disabled = true;
 				MachineMemoryTransfer->disabled = false;
+				MachineDebugger->disabled = false;
 			}
 			break;
 		}
@@ -1303,8 +1910,9 @@ void VIPR_Emulator::main_menu_activate(VIPR_Emulator::GUI::Menu &obj, void *user
 	GUI::Button *SwitchToMachine = std::get_if<GUI::Button>(&obj.element_list[3].element);
 	GUI::Button *MachineOptions = std::get_if<GUI::Button>(&obj.element_list[4].element);
 	GUI::Button *MachineMemoryTransfer = std::get_if<GUI::Button>(&obj.element_list[5].element);
-	GUI::Button *EmulatorOptions = std::get_if<GUI::Button>(&obj.element_list[6].element);
-	GUI::Button *ExitEmulator = std::get_if<GUI::Button>(&obj.element_list[7].element);
+	GUI::Button *MachineDebugger = std::get_if<GUI::Button>(&obj.element_list[6].element);
+	GUI::Button *EmulatorOptions = std::get_if<GUI::Button>(&obj.element_list[7].element);
+	GUI::Button *ExitEmulator = std::get_if<GUI::Button>(&obj.element_list[8].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -1313,16 +1921,19 @@ void VIPR_Emulator::main_menu_activate(VIPR_Emulator::GUI::Menu &obj, void *user
 			if (!MachinePower->toggle)
 			{
 				app->System.Reset();
+				app->Debug.Continue();
 				SDL_SetWindowTitle(app->MainWindow.get(), "VIPR Emulator");
 				SwitchToMachine->disabled = true;
 				MachineOptions->disabled = false;
 				MachineMemoryTransfer->disabled = true;
+				MachineDebugger->disabled = true;
 			}
 			else
 			{
 				SwitchToMachine->disabled = false;
 				MachineOptions->disabled = true;
 				MachineMemoryTransfer->disabled = false;
+				MachineDebugger->disabled = false;
 			}
 			break;
 		}
@@ -1331,7 +1942,7 @@ void VIPR_Emulator::main_menu_activate(VIPR_Emulator::GUI::Menu &obj, void *user
 			app->SetOperationMode(OperationMode::Machine);
 			app->MainRenderer.SetDisplayType(DisplayType::Machine);
 			app->System.SetCPUCycleTimePoint(std::chrono::high_resolution_clock::now());
-			app->System.PauseAudio(false);
+			app->OutputStream.Pause(false);
 			break;
 		}
 		case 2:
@@ -1346,10 +1957,20 @@ void VIPR_Emulator::main_menu_activate(VIPR_Emulator::GUI::Menu &obj, void *user
 		}
 		case 4:
 		{
-			app->CurrentMenu = &app->EmulatorOptionsMenu;
+			app->CurrentMenu = &app->MachineDebuggerMenu;
+			app->RefreshDebuggerMenu();
 			break;
 		}
 		case 5:
+		{
+			if (!app->audio_devices_listed)
+			{
+				app->RefreshAudioDevices(false);
+			}
+			app->CurrentMenu = &app->EmulatorOptionsMenu;
+			break;
+		}
+		case 6:
 		{
 			app->exit = true;
 			break;
@@ -1537,7 +2158,9 @@ void VIPR_Emulator::machine_options_left(VIPR_Emulator::GUI::Menu &obj, void *us
 			if (RAMInKB->value > RAMInKB->min)
 			{
 				--RAMInKB->value;
-				app->System.AdjustRAM(RAMInKB->value);
+				app->AdjustRAM(RAMInKB->value);
+				app->Store.GetSettings().ram_kb = static_cast<uint8_t>(RAMInKB->value);
+				app->Store.Save();
 			}
 			break;
 		}
@@ -1556,7 +2179,9 @@ void VIPR_Emulator::machine_options_right(VIPR_Emulator::GUI::Menu &obj, void *u
 			if (RAMInKB->value < RAMInKB->max)
 			{
 				++RAMInKB->value;
-				app->System.AdjustRAM(RAMInKB->value);
+				app->AdjustRAM(RAMInKB->value);
+				app->Store.GetSettings().ram_kb = static_cast<uint8_t>(RAMInKB->value);
+				app->Store.Save();
 			}
 			break;
 		}
@@ -1602,29 +2227,24 @@ void VIPR_Emulator::machine_options_activate(VIPR_Emulator::GUI::Menu &obj, void
 		}
 		case 2:
 		{
-			std::vector<uint8_t> ROMFileData;
+			MappedFile ROMImage;
+			if (!ROMImage.Open(ROMFile->stored_input, MappedFileMode::Read))
 			{
-				std::ifstream target_rom_file(ROMFile->stored_input, std::ios::binary | std::ios::ate);
-				if (target_rom_file.fail())
-				{
-					ROMStatus->status = "Failed";
-					ROMStatus->status_color = { 0xFF, 0x00, 0x00 };
-					break;
-				}
-				size_t rom_file_size = target_rom_file.tellg();
-				if (rom_file_size > 32768)
-				{
-					ROMStatus->status = "ROM Too Large";
-					ROMStatus->status_color = { 0xFF, 0xFF, 0x00 };
-					break;
-				}
-				ROMFileData.resize(rom_file_size);
-				target_rom_file.seekg(0, std::ios::beg);
-				target_rom_file.read(reinterpret_cast<char *>(ROMFileData.data()), rom_file_size);
+				ROMStatus->status = "Failed";
+				ROMStatus->status_color = { 0xFF, 0x00, 0x00 };
+				break;
+			}
+			if (ROMImage.GetSize() > 32768)
+			{
+				ROMStatus->status = "ROM Too Large";
+				ROMStatus->status_color = { 0xFF, 0xFF, 0x00 };
+				break;
 			}
-			app->System.InstallROM(std::move(ROMFileData));
+			app->System.InstallROM(std::move(ROMImage));
 			ROMStatus->status = "Installed";
 			ROMStatus->status_color = { 0x00, 0xFF, 0x00 };
+			app->Store.GetSettings().rom_file = ROMFile->stored_input;
+			app->Store.Save();
 			break;
 		}
 		case 3:
@@ -1644,7 +2264,9 @@ void VIPR_Emulator::machine_options_activate(VIPR_Emulator::GUI::Menu &obj, void
 void VIPR_Emulator::machine_options_ram_in_kb_input_complete(VIPR_Emulator::GUI::Value &obj, void *userdata)
 {
 	Application *app = static_cast<Application *>(userdata);
-	app->System.AdjustRAM(obj.value);
+	app->AdjustRAM(obj.value);
+	app->Store.GetSettings().ram_kb = static_cast<uint8_t>(obj.value);
+	app->Store.Save();
 }
 
 void VIPR_Emulator::machine_options_rom_file_input_complete(VIPR_Emulator::GUI::Input &obj, void *userdata)
@@ -1666,7 +2288,9 @@ void VIPR_Emulator::expansion_board_options_up(VIPR_Emulator::GUI::Menu &obj, vo
 	GUI::Toggle *VP585ExpansionKeypadInterface = std::get_if<GUI::Toggle>(&obj.element_list[1].element);
 	GUI::Toggle *VP590ColorBoard = std::get_if<GUI::Toggle>(&obj.element_list[2].element);
 	GUI::Toggle *VP595SimpleSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[3].element);
-	GUI::Button *ReturnToMachineOptions = std::get_if<GUI::Button>(&obj.element_list[4].element);
+	GUI::Toggle *VP550SuperSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[4].element);
+	GUI::Toggle *VP551SuperSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[5].element);
+	GUI::Button *ReturnToMachineOptions = std::get_if<GUI::Button>(&obj.element_list[6].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -1685,12 +2309,22 @@ void VIPR_Emulator::expansion_board_options_up(VIPR_Emulator::GUI::Menu &obj, vo
 			break;
 		}
 		case 3:
+		{
+			VP550SuperSoundBoard->select = false;
+			break;
+		}
+		case 4:
+		{
+			VP551SuperSoundBoard->select = false;
+			break;
+		}
+		case 5:
 		{
 			ReturnToMachineOptions->select = false;
 			break;
 		}
 	}
-	obj.current_menu_item = (obj.current_menu_item == 0) ? 3 : obj.current_menu_item - 1;
+	obj.current_menu_item = (obj.current_menu_item == 0) ? 5 : obj.current_menu_item - 1;
 	bool selected = false;
 	while (!selected)
 	{
@@ -1715,6 +2349,18 @@ void VIPR_Emulator::expansion_board_options_up(VIPR_Emulator::GUI::Menu &obj, vo
 				break;
 			}
 			case 3:
+			{
+				VP550SuperSoundBoard->select = true;
+				selected = true;
+				break;
+			}
+			case 4:
+			{
+				VP551SuperSoundBoard->select = true;
+				selected = true;
+				break;
+			}
+			case 5:
 			{
 				ReturnToMachineOptions->select = true;
 				selected = true;
@@ -1731,7 +2377,9 @@ void VIPR_Emulator::expansion_board_options_down(VIPR_Emulator::GUI::Menu &obj,
 	GUI::Toggle *VP585ExpansionKeypadInterface = std::get_if<GUI::Toggle>(&obj.element_list[1].element);
 	GUI::Toggle *VP590ColorBoard = std::get_if<GUI::Toggle>(&obj.element_list[2].element);
 	GUI::Toggle *VP595SimpleSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[3].element);
-	GUI::Button *ReturnToMachineOptions = std::get_if<GUI::Button>(&obj.element_list[4].element);
+	GUI::Toggle *VP550SuperSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[4].element);
+	GUI::Toggle *VP551SuperSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[5].element);
+	GUI::Button *ReturnToMachineOptions = std::get_if<GUI::Button>(&obj.element_list[6].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -1750,12 +2398,22 @@ void VIPR_Emulator::expansion_board_options_down(VIPR_Emulator::GUI::Menu &obj,
 			break;
 		}
 		case 3:
+		{
+			VP550SuperSoundBoard->select = false;
+			break;
+		}
+		case 4:
+		{
+			VP551SuperSoundBoard->select = false;
+			break;
+		}
+		case 5:
 		{
 			ReturnToMachineOptions->select = false;
 			break;
 		}
 	}
-	obj.current_menu_item = (obj.current_menu_item == 3) ? 0 : obj.current_menu_item + 1;
+	obj.current_menu_item = (obj.current_menu_item == 5) ? 0 : obj.current_menu_item + 1;
 	bool selected = false;
 	while (!selected)
 	{
@@ -1780,6 +2438,18 @@ void VIPR_Emulator::expansion_board_options_down(VIPR_Emulator::GUI::Menu &obj,
 				break;
 			}
 			case 3:
+			{
+				VP550SuperSoundBoard->select = true;
+				selected = true;
+				break;
+			}
+			case 4:
+			{
+				VP551SuperSoundBoard->select = true;
+				selected = true;
+				break;
+			}
+			case 5:
 			{
 				ReturnToMachineOptions->select = true;
 				selected = true;
@@ -1804,6 +2474,8 @@ void VIPR_Emulator::expansion_board_options_activate(VIPR_Emulator::GUI::Menu &o
 	GUI::Toggle *VP585ExpansionKeypadInterface = std::get_if<GUI::Toggle>(&obj.element_list[1].element);
 	GUI::Toggle *VP590ColorBoard = std::get_if<GUI::Toggle>(&obj.element_list[2].element);
 	GUI::Toggle *VP595SimpleSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[3].element);
+	GUI::Toggle *VP550SuperSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[4].element);
+	GUI::Toggle *VP551SuperSoundBoard = std::get_if<GUI::Toggle>(&obj.element_list[5].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -1853,15 +2525,54 @@ void VIPR_Emulator::expansion_board_options_activate(VIPR_Emulator::GUI::Menu &o
 			{
 				app->System.InstallExpansionBoard(ExpansionBoardType::VP595_SimpleSoundBoard);
 			}
-			GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&app->EmulatorOptionsMenu.element_list[1].element);
-			app->System.SetupAudio(OutputAudioDevice->choice_list[OutputAudioDevice->current_choice]);
 			break;
 		}
 		case 3:
+		{
+			VP550SuperSoundBoard->toggle = (VP550SuperSoundBoard->toggle) ? false : true;
+			if (!VP550SuperSoundBoard->toggle)
+			{
+				app->System.UninstallExpansionBoard(ExpansionBoardType::VP550_SuperSoundBoard);
+			}
+			else
+			{
+				if (VP551SuperSoundBoard->toggle)
+				{
+					VP551SuperSoundBoard->toggle = false;
+					app->System.UninstallExpansionBoard(ExpansionBoardType::VP551_SuperSoundBoard);
+				}
+				app->System.InstallExpansionBoard(ExpansionBoardType::VP550_SuperSoundBoard);
+			}
+			break;
+		}
+		case 4:
+		{
+			VP551SuperSoundBoard->toggle = (VP551SuperSoundBoard->toggle) ? false : true;
+			if (!VP551SuperSoundBoard->toggle)
+			{
+				app->System.UninstallExpansionBoard(ExpansionBoardType::VP551_SuperSoundBoard);
+			}
+			else
+			{
+				if (VP550SuperSoundBoard->toggle)
+				{
+					VP550SuperSoundBoard->toggle = false;
+					app->System.UninstallExpansionBoard(ExpansionBoardType::VP550_SuperSoundBoard);
+				}
+				app->System.InstallExpansionBoard(ExpansionBoardType::VP551_SuperSoundBoard);
+			}
+			break;
+		}
+		case 5:
 		{
 			app->CurrentMenu = &app->MachineOptionsMenu;
 		}
 	}
+	if (obj.current_menu_item < 5) // Boards can turn each other off, so all of them are saved
+	{
+		app->Store.GetSettings().ExpansionBoard = { VP585ExpansionKeypadInterface->toggle, VP590ColorBoard->toggle, VP595SimpleSoundBoard->toggle, VP550SuperSoundBoard->toggle, VP551SuperSoundBoard->toggle };
+		app->Store.Save();
+	}
 	app->DrawCurrentMenu();
 }
 
@@ -2160,8 +2871,8 @@ void VIPR_Emulator::machine_memory_transfer_activate(VIPR_Emulator::GUI::Menu &o
 			{
 				case 0:
 				{
-					std::ifstream target_memory_file(MemoryFile->stored_input, std::ios::binary);
-					if (target_memory_file.fail() || StartAddress->value + Size->value > app->System.GetRAM())
+					MappedFile MemoryImage;
+					if (!MemoryImage.Open(MemoryFile->stored_input, MappedFileMode::Read) || StartAddress->value + Size->value > app->System.GetRAM())
 					{
 						TransferStatus->status = "Failed";
 						TransferStatus->status_color = { 0xFF, 0x00, 0x00 };
@@ -2169,7 +2880,7 @@ void VIPR_Emulator::machine_memory_transfer_activate(VIPR_Emulator::GUI::Menu &o
 					else
 					{
 						uint8_t *RAM = app->System.GetRAMData();
-						target_memory_file.read(reinterpret_cast<char *>(&RAM[StartAddress->value]), Size->value);
+						std::copy_n(MemoryImage.GetData(), std::min<size_t>(Size->value, MemoryImage.GetSize()), &RAM[StartAddress->value]);
 						TransferStatus->status = "Successful";
 						TransferStatus->status_color = { 0x00, 0xFF, 0x00 };
 					}
@@ -2184,18 +2895,22 @@ void VIPR_Emulator::machine_memory_transfer_activate(VIPR_Emulator::GUI::Menu &o
 					}
 					else
 					{
-						bool exists = false;
-						{
-							std::ifstream target_memory_file(MemoryFile->stored_input, std::ios::binary);
-							exists = target_memory_file.is_open();
-						}
+						bool exists = std::filesystem::exists(MemoryFile->stored_input);
 						if (!exists || TransferStatus->status == "Overwrite?")
 						{
-							std::ofstream target_memory_file(MemoryFile->stored_input, std::ios::binary);
-							uint8_t *RAM = app->System.GetRAMData();
-							target_memory_file.write(reinterpret_cast<const char *>(&RAM[StartAddress->value]), Size->value);
-							TransferStatus->status = "Successful";
-							TransferStatus->status_color = { 0x00, 0xFF, 0x00 };
+							MappedFile MemoryImage;
+							if (MemoryImage.Open(MemoryFile->stored_input, MappedFileMode::ReadWrite, Size->value))
+							{
+								uint8_t *RAM = app->System.GetRAMData();
+								std::copy_n(&RAM[StartAddress->value], Size->value, MemoryImage.GetData());
+								TransferStatus->status = "Successful";
+								TransferStatus->status_color = { 0x00, 0xFF, 0x00 };
+							}
+							else
+							{
+								TransferStatus->status = "Failed";
+								TransferStatus->status_color = { 0xFF, 0x00, 0x00 };
+							}
 						}
 						else
 						{
@@ -2205,6 +2920,31 @@ void VIPR_Emulator::machine_memory_transfer_activate(VIPR_Emulator::GUI::Menu &o
 					}
 					break;
 				}
+				case 2:
+				{
+					if (app->System.AttachRAMFile(MemoryFile->stored_input))
+					{
+						TransferStatus->status = "RAM Attached";
+						TransferStatus->status_color = { 0x00, 0xFF, 0x00 };
+						app->Store.GetSettings().ram_file = MemoryFile->stored_input;
+						app->Store.Save();
+					}
+					else
+					{
+						TransferStatus->status = "Failed";
+						TransferStatus->status_color = { 0xFF, 0x00, 0x00 };
+					}
+					break;
+				}
+				case 3:
+				{
+					app->System.DetachRAMFile();
+					TransferStatus->status = "RAM Detached";
+					TransferStatus->status_color = { 0x00, 0xFF, 0x00 };
+					app->Store.GetSettings().ram_file.clear();
+					app->Store.Save();
+					break;
+				}
 			}
 			break;
 		}
@@ -2252,12 +2992,409 @@ void VIPR_Emulator::machine_memory_transfer_size_input_complete(VIPR_Emulator::G
 	app->DrawCurrentMenu();
 }
 
+void VIPR_Emulator::machine_debugger_up(VIPR_Emulator::GUI::Menu &obj, void *userdata)
+{
+	Application *app = static_cast<Application *>(userdata);
+	GUI::Value *MemoryAddress = std::get_if<GUI::Value>(&obj.element_list[5].element);
+	GUI::Value *BreakpointAddress = std::get_if<GUI::Value>(&obj.element_list[14].element);
+	GUI::MultiChoice *BreakpointType = std::get_if<GUI::MultiChoice>(&obj.element_list[15].element);
+	GUI::Button *AddBreakpoint = std::get_if<GUI::Button>(&obj.element_list[16].element);
+	GUI::Button *RemoveBreakpoint = std::get_if<GUI::Button>(&obj.element_list[17].element);
+	GUI::Button *ClearBreakpoints = std::get_if<GUI::Button>(&obj.element_list[18].element);
+	GUI::Button *Step = std::get_if<GUI::Button>(&obj.element_list[20].element);
+	GUI::Button *Continue = std::get_if<GUI::Button>(&obj.element_list[21].element);
+	GUI::Button *ReturnToMainMenu = std::get_if<GUI::Button>(&obj.element_list[22].element);
+	switch (obj.current_menu_item)
+	{
+		case 0:
+		{
+			MemoryAddress->select = false;
+			break;
+		}
+		case 1:
+		{
+			BreakpointAddress->select = false;
+			break;
+		}
+		case 2:
+		{
+			BreakpointType->select = false;
+			break;
+		}
+		case 3:
+		{
+			AddBreakpoint->select = false;
+			break;
+		}
+		case 4:
+		{
+			RemoveBreakpoint->select = false;
+			break;
+		}
+		case 5:
+		{
+			ClearBreakpoints->select = false;
+			break;
+		}
+		case 6:
+		{
+			Step->select = false;
+			break;
+		}
+		case 7:
+		{
+			Continue->select = false;
+			break;
+		}
+		case 8:
+		{
+			ReturnToMainMenu->select = false;
+			break;
+		}
+	}
+	obj.current_menu_item = (obj.current_menu_item == 0) ? 8 : obj.current_menu_item - 1;
+	bool selected = false;
+	while (!selected)
+	{
+		switch (obj.current_menu_item)
+		{
+			case 0:
+			{
+				MemoryAddress->select = true;
+				selected = true;
+				break;
+			}
+			case 1:
+			{
+				BreakpointAddress->select = true;
+				selected = true;
+				break;
+			}
+			case 2:
+			{
+				BreakpointType->select = true;
+				selected = true;
+				break;
+			}
+			case 3:
+			{
+				AddBreakpoint->select = true;
+				selected = true;
+				break;
+			}
+			case 4:
+			{
+				RemoveBreakpoint->select = true;
+				selected = true;
+				break;
+			}
+			case 5:
+			{
+				ClearBreakpoints->select = true;
+				selected = true;
+				break;
+			}
+			case 6:
+			{
+				Step->select = true;
+				selected = true;
+				break;
+			}
+			case 7:
+			{
+				Continue->select = true;
+				selected = true;
+				break;
+			}
+			case 8:
+			{
+				ReturnToMainMenu->select = true;
+				selected = true;
+				break;
+			}
+		}
+	}
+	app->DrawCurrentMenu();
+}
+
+void VIPR_Emulator::machine_debugger_down(VIPR_Emulator::GUI::Menu &obj, void *userdata)
+{
+	Application *app = static_cast<Application *>(userdata);
+	GUI::Value *MemoryAddress = std::get_if<GUI::Value>(&obj.element_list[5].element);
+	GUI::Value *BreakpointAddress = std::get_if<GUI::Value>(&obj.element_list[14].element);
+	GUI::MultiChoice *BreakpointType = std::get_if<GUI::MultiChoice>(&obj.element_list[15].element);
+	GUI::Button *AddBreakpoint = std::get_if<GUI::Button>(&obj.element_list[16].element);
+	GUI::Button *RemoveBreakpoint = std::get_if<GUI::Button>(&obj.element_list[17].element);
+	GUI::Button *ClearBreakpoints = std::get_if<GUI::Button>(&obj.element_list[18].element);
+	GUI::Button *Step = std::get_if<GUI::Button>(&obj.element_list[20].element);
+	GUI::Button *Continue = std::get_if<GUI::Button>(&obj.element_list[21].element);
+	GUI::Button *ReturnToMainMenu = std::get_if<GUI::Button>(&obj.element_list[22].element);
+	switch (obj.current_menu_item)
+	{
+		case 0:
+		{
+			MemoryAddress->select = false;
+			break;
+		}
+		case 1:
+		{
+			BreakpointAddress->select = false;
+			break;
+		}
+		case 2:
+		{
+			BreakpointType->select = false;
+			break;
+		}
+		case 3:
+		{
+			AddBreakpoint->select = false;
+			break;
+		}
+		case 4:
+		{
+			RemoveBreakpoint->select = false;
+			break;
+		}
+		case 5:
+		{
+			ClearBreakpoints->select = false;
+			break;
+		}
+		case 6:
+		{
+			Step->select = false;
+			break;
+		}
+		case 7:
+		{
+			Continue->select = false;
+			break;
+		}
+		case 8:
+		{
+			ReturnToMainMenu->select = false;
+			break;
+		}
+	}
+	obj.current_menu_item = (obj.current_menu_item == 8) ? 0 : obj.current_menu_item + 1;
+	bool selected = false;
+	while (!selected)
+	{
+		switch (obj.current_menu_item)
+		{
+			case 0:
+			{
+				MemoryAddress->select = true;
+				selected = true;
+				break;
+			}
+			case 1:
+			{
+				BreakpointAddress->select = true;
+				selected = true;
+				break;
+			}
+			case 2:
+			{
+				BreakpointType->select = true;
+				selected = true;
+				break;
+			}
+			case 3:
+			{
+				AddBreakpoint->select = true;
+				selected = true;
+				break;
+			}
+			case 4:
+			{
+				RemoveBreakpoint->select = true;
+				selected = true;
+				break;
+			}
+			case 5:
+			{
+				ClearBreakpoints->select = true;
+				selected = true;
+				break;
+			}
+			case 6:
+			{
+				Step->select = true;
+				selected = true;
+				break;
+			}
+			case 7:
+			{
+				Continue->select = true;
+				selected = true;
+				break;
+			}
+			case 8:
+			{
+				ReturnToMainMenu->select = true;
+				selected = true;
+				break;
+			}
+		}
+	}
+	app->DrawCurrentMenu();
+}
+
+void VIPR_Emulator::machine_debugger_left(VIPR_Emulator::GUI::Menu &obj, void *userdata)
+{
+	Application *app = static_cast<Application *>(userdata);
+	GUI::Value *MemoryAddress = std::get_if<GUI::Value>(&obj.element_list[5].element);
+	GUI::MultiChoice *BreakpointType = std::get_if<GUI::MultiChoice>(&obj.element_list[15].element);
+	switch (obj.current_menu_item)
+	{
+		case 0:
+		{
+			MemoryAddress->value = (MemoryAddress->value - (debugger_memory_lines * 16)) & 0xFFF0; // Pages through the memory view, wrapping around the address space
+			app->RefreshDebuggerMenu();
+			break;
+		}
+		case 2:
+		{
+			BreakpointType->current_choice = (BreakpointType->current_choice == 0) ? BreakpointType->choice_list.size() - 1 : BreakpointType->current_choice - 1;
+			break;
+		}
+	}
+	app->DrawCurrentMenu();
+}
+
+void VIPR_Emulator::machine_debugger_right(VIPR_Emulator::GUI::Menu &obj, void *userdata)
+{
+	Application *app = static_cast<Application *>(userdata);
+	GUI::Value *MemoryAddress = std::get_if<GUI::Value>(&obj.element_list[5].element);
+	GUI::MultiChoice *BreakpointType = std::get_if<GUI::MultiChoice>(&obj.element_list[15].element);
+	switch (obj.current_menu_item)
+	{
+		case 0:
+		{
+			MemoryAddress->value = (MemoryAddress->value + (debugger_memory_lines * 16)) & 0xFFF0;
+			app->RefreshDebuggerMenu();
+			break;
+		}
+		case 2:
+		{
+			BreakpointType->current_choice = (BreakpointType->current_choice == BreakpointType->choice_list.size() - 1) ? 0 : BreakpointType->current_choice + 1;
+			break;
+		}
+	}
+	app->DrawCurrentMenu();
+}
+
+void VIPR_Emulator::machine_debugger_activate(VIPR_Emulator::GUI::Menu &obj, void *userdata)
+{
+	Application *app = static_cast<Application *>(userdata);
+	GUI::Value *MemoryAddress = std::get_if<GUI::Value>(&obj.element_list[5].element);
+	GUI::Value *BreakpointAddress = std::get_if<GUI::Value>(&obj.element_list[14].element);
+	GUI::MultiChoice *BreakpointType = std::get_if<GUI::MultiChoice>(&obj.element_list[15].element);
+	GUI::Status *BreakpointList = std::get_if<GUI::Status>(&obj.element_list[19].element);
+	constexpr std::array<VIPR_Emulator::BreakpointType, 5> breakpoint_types = { VIPR_Emulator::BreakpointType::Execute, VIPR_Emulator::BreakpointType::Read, VIPR_Emulator::BreakpointType::Write, VIPR_Emulator::BreakpointType::Watch, VIPR_Emulator::BreakpointType::ColorWatch }; // In the order of the choices
+	switch (obj.current_menu_item)
+	{
+		case 0:
+		{
+			app->InputFocus = &obj.element_list[5];
+			MemoryAddress->focus = true;
+			std::ostringstream current_stream;
+			current_stream << std::hex << MemoryAddress->value;
+			MemoryAddress->input = current_stream.str();
+			MemoryAddress->cursor_pos = MemoryAddress->input.size();
+			app->SetOperationMode(OperationMode::Input);
+			break;
+		}
+		case 1:
+		{
+			app->InputFocus = &obj.element_list[14];
+			BreakpointAddress->focus = true;
+			std::ostringstream current_stream;
+			current_stream << std::hex << BreakpointAddress->value;
+			BreakpointAddress->input = current_stream.str();
+			BreakpointAddress->cursor_pos = BreakpointAddress->input.size();
+			app->SetOperationMode(OperationMode::Input);
+			break;
+		}
+		case 2:
+		{
+			BreakpointType->current_choice = (BreakpointType->current_choice == BreakpointType->choice_list.size() - 1) ? 0 : BreakpointType->current_choice + 1;
+			break;
+		}
+		case 3:
+		case 4:
+		{
+			VIPR_Emulator::BreakpointType type = breakpoint_types[BreakpointType->current_choice];
+			uint16_t address = static_cast<uint16_t>(BreakpointAddress->value);
+			bool changed = (obj.current_menu_item == 3) ? app->Debug.AddBreakpoint(type, address) : app->Debug.RemoveBreakpoint(type, address);
+			app->System.AttachDebugger(&app->Debug); // Switches the memory bus checks on or off to match
+			app->RefreshDebuggerMenu();
+			if (!changed)
+			{
+				BreakpointList->status = "Failed";
+				BreakpointList->status_color = { 0xFF, 0x00, 0x00 };
+			}
+			break;
+		}
+		case 5:
+		{
+			app->Debug.ClearBreakpoints();
+			app->System.AttachDebugger(&app->Debug);
+			app->RefreshDebuggerMenu();
+			break;
+		}
+		case 6:
+		{
+			if (app->System.IsRunning())
+			{
+				app->Debug.Step();
+				uint32_t max_clocks = static_cast<uint32_t>(app->System.GetClockFrequency()); // Gives up after a second of machine time, e.g. while waiting on DMA
+				for (uint32_t i = 0; i < max_clocks && !app->Debug.IsStopped(); i += 8)
+				{
+					app->System.RunMachineClocks(8);
+				}
+			}
+			app->RefreshDebuggerMenu();
+			break;
+		}
+		case 7:
+		{
+			app->Debug.Continue();
+			app->SetOperationMode(OperationMode::Machine);
+			app->MainRenderer.SetDisplayType(DisplayType::Machine);
+			app->System.SetCPUCycleTimePoint(std::chrono::high_resolution_clock::now());
+			app->OutputStream.Pause(false);
+			app->RefreshDebuggerMenu();
+			break;
+		}
+		case 8:
+		{
+			app->CurrentMenu = &app->MainMenu;
+			break;
+		}
+	}
+	app->DrawCurrentMenu();
+}
+
+void VIPR_Emulator::machine_debugger_memory_address_input_complete(VIPR_Emulator::GUI::Value &obj, void *userdata)
+{
+	Application *app = static_cast<Application *>(userdata);
+	app->RefreshDebuggerMenu();
+	app->DrawCurrentMenu();
+}
+
 void VIPR_Emulator::emulator_options_up(VIPR_Emulator::GUI::Menu &obj, void *userdata)
 {
 	Application *app = static_cast<Application *>(userdata);
 	GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&obj.element_list[1].element);
 	GUI::Value *MainVolume = std::get_if<GUI::Value>(&obj.element_list[2].element);
-	GUI::Button *ReturnToMainMenu = std::get_if<GUI::Button>(&obj.element_list[3].element);
+	GUI::Value *AudioLatency = std::get_if<GUI::Value>(&obj.element_list[3].element);
+	GUI::Value *ToneVolume = std::get_if<GUI::Value>(&obj.element_list[4].element);
+	GUI::Value *SimpleSoundVolume = std::get_if<GUI::Value>(&obj.element_list[5].element);
+	GUI::Value *SuperSoundVolume = std::get_if<GUI::Value>(&obj.element_list[6].element);
+	GUI::Button *ReturnToMainMenu = std::get_if<GUI::Button>(&obj.element_list[7].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -2271,12 +3408,32 @@ void VIPR_Emulator::emulator_options_up(VIPR_Emulator::GUI::Menu &obj, void *use
 			break;
 		}
 		case 2:
+		{
+			AudioLatency->select = false;
+			break;
+		}
+		case 3:
+		{
+			ToneVolume->select = false;
+			break;
+		}
+		case 4:
+		{
+			SimpleSoundVolume->select = false;
+			break;
+		}
+		case 5:
+		{
+			SuperSoundVolume->select = false;
+			break;
+		}
+		case 6:
 		{
 			ReturnToMainMenu->select = false;
 			break;
 		}
 	}
-	obj.current_menu_item = (obj.current_menu_item == 0) ? 2 : obj.current_menu_item - 1;
+	obj.current_menu_item = (obj.current_menu_item == 0) ? 6 : obj.current_menu_item - 1;
 	bool selected = false;
 	while (!selected)
 	{
@@ -2295,6 +3452,30 @@ void VIPR_Emulator::emulator_options_up(VIPR_Emulator::GUI::Menu &obj, void *use
 				break;
 			}
 			case 2:
+			{
+				AudioLatency->select = true;
+				selected = true;
+				break;
+			}
+			case 3:
+			{
+				ToneVolume->select = true;
+				selected = true;
+				break;
+			}
+			case 4:
+			{
+				SimpleSoundVolume->select = true;
+				selected = true;
+				break;
+			}
+			case 5:
+			{
+				SuperSoundVolume->select = true;
+				selected = true;
+				break;
+			}
+			case 6:
 			{
 				ReturnToMainMenu->select = true;
 				selected = true;
@@ -2310,7 +3491,11 @@ void VIPR_Emulator::emulator_options_down(VIPR_Emulator::GUI::Menu &obj, void *u
 	Application *app = static_cast<Application *>(userdata);
 	GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&obj.element_list[1].element);
 	GUI::Value *MainVolume = std::get_if<GUI::Value>(&obj.element_list[2].element);
-	GUI::Button *ReturnToMainMenu = std::get_if<GUI::Button>(&obj.element_list[3].element);
+	GUI::Value *AudioLatency = std::get_if<GUI::Value>(&obj.element_list[3].element);
+	GUI::Value *ToneVolume = std::get_if<GUI::Value>(&obj.element_list[4].element);
+	GUI::Value *SimpleSoundVolume = std::get_if<GUI::Value>(&obj.element_list[5].element);
+	GUI::Value *SuperSoundVolume = std::get_if<GUI::Value>(&obj.element_list[6].element);
+	GUI::Button *ReturnToMainMenu = std::get_if<GUI::Button>(&obj.element_list[7].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
@@ -2324,12 +3509,32 @@ void VIPR_Emulator::emulator_options_down(VIPR_Emulator::GUI::Menu &obj, void *u
 			break;
 		}
 		case 2:
+		{
+			AudioLatency->select = false;
+			break;
+		}
+		case 3:
+		{
+			ToneVolume->select = false;
+			break;
+		}
+		case 4:
+		{
+			SimpleSoundVolume->select = false;
+			break;
+		}
+		case 5:
+		{
+			SuperSoundVolume->select = false;
+			break;
+		}
+		case 6:
 		{
 			ReturnToMainMenu->select = false;
 			break;
 		}
 	}
-	obj.current_menu_item = (obj.current_menu_item == 2) ? 0 : obj.current_menu_item + 1;
+	obj.current_menu_item = (obj.current_menu_item == 6) ? 0 : obj.current_menu_item + 1;
 	bool selected = false;
 	while (!selected)
 	{
@@ -2348,6 +3553,30 @@ void VIPR_Emulator::emulator_options_down(VIPR_Emulator::GUI::Menu &obj, void *u
 				break;
 			}
 			case 2:
+			{
+				AudioLatency->select = true;
+				selected = true;
+				break;
+			}
+			case 3:
+			{
+				ToneVolume->select = true;
+				selected = true;
+				break;
+			}
+			case 4:
+			{
+				SimpleSoundVolume->select = true;
+				selected = true;
+				break;
+			}
+			case 5:
+			{
+				SuperSoundVolume->select = true;
+				selected = true;
+				break;
+			}
+			case 6:
 			{
 				ReturnToMainMenu->select = true;
 				selected = true;
@@ -2363,12 +3592,15 @@ void VIPR_Emulator::emulator_options_left(VIPR_Emulator::GUI::Menu &obj, void *u
 	Application *app = static_cast<Application *>(userdata);
 	GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&obj.element_list[1].element);
 	GUI::Value *MainVolume = std::get_if<GUI::Value>(&obj.element_list[2].element);
+	GUI::Value *AudioLatency = std::get_if<GUI::Value>(&obj.element_list[3].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
 		{
 			OutputAudioDevice->current_choice = (OutputAudioDevice->current_choice == 0) ? OutputAudioDevice->choice_list.size() - 1 : OutputAudioDevice->current_choice - 1;
-			app->System.SetupAudio(OutputAudioDevice->choice_list[OutputAudioDevice->current_choice]);
+			app->SetupAudio();
+			app->Store.GetSettings().audio_device = (OutputAudioDevice->current_choice < OutputAudioDevice->choice_list.size()) ? OutputAudioDevice->choice_list[OutputAudioDevice->current_choice] : std::string();
+			app->Store.Save();
 			break;
 		}
 		case 1:
@@ -2376,7 +3608,34 @@ void VIPR_Emulator::emulator_options_left(VIPR_Emulator::GUI::Menu &obj, void *u
 			if (MainVolume->value > MainVolume->min)
 			{
 				--MainVolume->value;
-				app->System.AdjustVolume(MainVolume->value);
+				app->SoundEngine.SetVolume(MainVolume->value);
+				app->Store.GetSettings().volume = static_cast<uint8_t>(MainVolume->value);
+				app->Store.Save();
+			}
+			break;
+		}
+		case 2:
+		{
+			if (AudioLatency->value > AudioLatency->min)
+			{
+				--AudioLatency->value;
+				app->SetupAudio();
+				app->Store.GetSettings().audio_latency = static_cast<uint16_t>(AudioLatency->value);
+				app->Store.Save();
+			}
+			break;
+		}
+		case 3:
+		case 4:
+		case 5:
+		{
+			GUI::Value *SourceVolume = std::get_if<GUI::Value>(&obj.element_list[obj.current_menu_item + 1].element);
+			if (SourceVolume->value > SourceVolume->min)
+			{
+				--SourceVolume->value;
+				app->System.SetSourceVolume(static_cast<SoundSourceType>(obj.current_menu_item - 3), static_cast<uint8_t>(SourceVolume->value));
+				app->Store.GetSettings().SourceVolume[obj.current_menu_item - 3] = static_cast<uint8_t>(SourceVolume->value);
+				app->Store.Save();
 			}
 			break;
 		}
@@ -2389,12 +3648,15 @@ void VIPR_Emulator::emulator_options_right(VIPR_Emulator::GUI::Menu &obj, void *
 	Application *app = static_cast<Application *>(userdata);
 	GUI::MultiChoice *OutputAudioDevice = std::get_if<GUI::MultiChoice>(&obj.element_list[1].element);
 	GUI::Value *MainVolume = std::get_if<GUI::Value>(&obj.element_list[2].element);
+	GUI::Value *AudioLatency = std::get_if<GUI::Value>(&obj.element_list[3].element);
 	switch (obj.current_menu_item)
 	{
 		case 0:
 		{
 			OutputAudioDevice->current_choice = (OutputAudioDevice->current_choice == OutputAudioDevice->choice_list.size() - 1) ? 0 : OutputAudioDevice->current_choice + 1;
-			app->System.SetupAudio(OutputAudioDevice->choice_list[OutputAudioDevice->current_choice]);
+			app->SetupAudio();
+			app->Store.GetSettings().audio_device = (OutputAudioDevice->current_choice < OutputAudioDevice->choice_list.size()) ? OutputAudioDevice->choice_list[OutputAudioDevice->current_choice] : std::string();
+			app->Store.Save();
 			break;
 		}
 		case 1:
@@ -2402,7 +3664,34 @@ void VIPR_Emulator::emulator_options_right(VIPR_Emulator::GUI::Menu &obj, void *
 			if (MainVolume->value < MainVolume->max)
 			{
 				++MainVolume->value;
-				app->System.AdjustVolume(MainVolume->value);
+				app->SoundEngine.SetVolume(MainVolume->value);
+				app->Store.GetSettings().volume = static_cast<uint8_t>(MainVolume->value);
+				app->Store.Save();
+			}
+			break;
+		}
+		case 2:
+		{
+			if (AudioLatency->value < AudioLatency->max)
+			{
+				++AudioLatency->value;
+				app->SetupAudio();
+				app->Store.GetSettings().audio_latency = static_cast<uint16_t>(AudioLatency->value);
+				app->Store.Save();
+			}
+			break;
+		}
+		case 3:
+		case 4:
+		case 5:
+		{
+			GUI::Value *SourceVolume = std::get_if<GUI::Value>(&obj.element_list[obj.current_menu_item + 1].element);
+			if (SourceVolume->value < SourceVolume->max)
+			{
+				++SourceVolume->value;
+				app->System.SetSourceVolume(static_cast<SoundSourceType>(obj.current_menu_item - 3), static_cast<uint8_t>(SourceVolume->value));
+				app->Store.GetSettings().SourceVolume[obj.current_menu_item - 3] = static_cast<uint8_t>(SourceVolume->value);
+				app->Store.Save();
 			}
 			break;
 		}
@@ -2419,10 +3708,12 @@ void VIPR_Emulator::emulator_options_activate(VIPR_Emulator::GUI::Menu &obj, voi
 		case 0:
 		{
 			OutputAudioDevice->current_choice = (OutputAudioDevice->current_choice == OutputAudioDevice->choice_list.size() - 1) ? 0 : OutputAudioDevice->current_choice + 1;
-			app->System.SetupAudio(OutputAudioDevice->choice_list[OutputAudioDevice->current_choice]);
+			app->SetupAudio();
+			app->Store.GetSettings().audio_device = (OutputAudioDevice->current_choice < OutputAudioDevice->choice_list.size()) ? OutputAudioDevice->choice_list[OutputAudioDevice->current_choice] : std::string();
+			app->Store.Save();
 			break;
 		}
-		case 2:
+		case 6:
 		{
 			app->CurrentMenu = &app->MainMenu;
 			break;
@@ -2433,7 +3724,32 @@ void VIPR_Emulator::emulator_options_activate(VIPR_Emulator::GUI::Menu &obj, voi
 
 int main(int argc, char *argv[])
 {
-	VIPR_Emulator::Application MainApp;
+	if (std::find(argv + 1, argv + argc, std::string_view("--headless")) != argv + argc)
+	{
+		VIPR_Emulator::HeadlessOptions headless_options;
+		if (!VIPR_Emulator::ParseHeadlessArguments(argc, argv, headless_options))
+		{
+			return -1;
+		}
+		return VIPR_Emulator::RunHeadless(headless_options);
+	}
+	std::string settings_file = "vipr_settings.ini";
+	for (int i = 1; i + 1 < argc; ++i)
+	{
+		if (std::string_view(argv[i]) == "--settings")
+		{
+			settings_file = argv[i + 1];
+		}
+	}
+	VIPR_Emulator::SettingsStore Store(settings_file);
+	Store.Load(); // Before SDL is initialized, and without a file the defaults are used
+	VIPR_Emulator::Settings launch_settings = Store.GetSettings();
+	VIPR_Emulator::LaunchArguments launch_arguments;
+	if (!VIPR_Emulator::ParseLaunchArguments(argc, argv, launch_settings, launch_arguments))
+	{
+		return -1;
+	}
+	VIPR_Emulator::Application MainApp(launch_settings, launch_arguments, Store);
 	if (!MainApp.Fail())
 	{
 		MainApp.RunMainLoop();
@@ -0,0 +1,235 @@
+#include "mapped_file.hpp"
+#include <utility>
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+	using VIPR_Emulator::MappedFileMode;
+	using VIPR_Emulator::NativeFileHandle;
+	using VIPR_Emulator::no_file_handle;
+
+#ifdef _WIN32
+	NativeFileHandle OpenNativeFile(const std::string &file, MappedFileMode mode)
+	{
+		HANDLE handle = CreateFileA(file.c_str(), (mode == MappedFileMode::ReadWrite) ? (GENERIC_READ | GENERIC_WRITE) : GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, (mode == MappedFileMode::ReadWrite) ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+		return (handle != INVALID_HANDLE_VALUE) ? handle : no_file_handle;
+	}
+
+	bool SetNativeFileSize(NativeFileHandle file, size_t size) // Fails while a view is mapped, so callers unmap first
+	{
+		LARGE_INTEGER file_size;
+		file_size.QuadPart = static_cast<LONGLONG>(size);
+		return SetFilePointerEx(file, file_size, nullptr, FILE_BEGIN) && SetEndOfFile(file);
+	}
+
+	bool GetNativeFileSize(NativeFileHandle file, size_t &size)
+	{
+		LARGE_INTEGER file_size;
+		if (GetFileType(file) != FILE_TYPE_DISK || !GetFileSizeEx(file, &file_size))
+		{
+			return false;
+		}
+		size = static_cast<size_t>(file_size.QuadPart);
+		return true;
+	}
+
+	void CloseNativeFile(NativeFileHandle file)
+	{
+		CloseHandle(file);
+	}
+#else
+	NativeFileHandle OpenNativeFile(const std::string &file, MappedFileMode mode)
+	{
+		return ::open(file.c_str(), (mode == MappedFileMode::ReadWrite) ? (O_RDWR | O_CREAT) : O_RDONLY, 0644);
+	}
+
+	bool SetNativeFileSize(NativeFileHandle file, size_t size)
+	{
+		return ftruncate(file, static_cast<off_t>(size)) == 0;
+	}
+
+	bool GetNativeFileSize(NativeFileHandle file, size_t &size)
+	{
+		struct stat file_status;
+		if (fstat(file, &file_status) != 0 || !S_ISREG(file_status.st_mode))
+		{
+			return false;
+		}
+		size = static_cast<size_t>(file_status.st_size);
+		return true;
+	}
+
+	void CloseNativeFile(NativeFileHandle file)
+	{
+		::close(file);
+	}
+#endif
+}
+
+VIPR_Emulator::MappedFile::MappedFile() : file(no_file_handle), data(nullptr), size(0), mode(MappedFileMode::Read), open(false)
+{
+}
+
+VIPR_Emulator::MappedFile::~MappedFile()
+{
+	Close();
+}
+
+VIPR_Emulator::MappedFile::MappedFile(MappedFile &&other) noexcept : file(std::exchange(other.file, no_file_handle)), data(std::exchange(other.data, nullptr)), size(std::exchange(other.size, 0)), mode(other.mode), open(std::exchange(other.open, false))
+{
+}
+
+VIPR_Emulator::MappedFile &VIPR_Emulator::MappedFile::operator=(MappedFile &&other) noexcept
+{
+	if (this != &other)
+	{
+		Close();
+		file = std::exchange(other.file, no_file_handle);
+		data = std::exchange(other.data, nullptr);
+		size = std::exchange(other.size, 0);
+		mode = other.mode;
+		open = std::exchange(other.open, false);
+	}
+	return *this;
+}
+
+bool VIPR_Emulator::MappedFile::Open(const std::string &file, MappedFileMode mode, size_t size)
+{
+	Close();
+	this->mode = mode;
+	this->file = OpenNativeFile(file, mode);
+	if (this->file == no_file_handle)
+	{
+		return false;
+	}
+	if (mode == MappedFileMode::ReadWrite)
+	{
+		if (!SetNativeFileSize(this->file, size))
+		{
+			Close();
+			return false;
+		}
+		this->size = size;
+	}
+	else if (!GetNativeFileSize(this->file, this->size))
+	{
+		Close();
+		return false;
+	}
+	open = true;
+	if (!Map())
+	{
+		Close();
+		return false;
+	}
+	if (mode == MappedFileMode::Read)
+	{
+		CloseNativeFile(this->file); // The mapping stays valid without the file
+		this->file = no_file_handle;
+	}
+	return true;
+}
+
+bool VIPR_Emulator::MappedFile::Resize(size_t size)
+{
+	if (!open || mode != MappedFileMode::ReadWrite)
+	{
+		return false;
+	}
+	if (size == this->size)
+	{
+		return true;
+	}
+	Unmap();
+	if (!SetNativeFileSize(file, size))
+	{
+		Close();
+		return false;
+	}
+	this->size = size;
+	if (!Map())
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void VIPR_Emulator::MappedFile::Flush()
+{
+	if (data != nullptr && mode == MappedFileMode::ReadWrite)
+	{
+#ifdef _WIN32
+		FlushViewOfFile(data, size);
+		FlushFileBuffers(file);
+#else
+		msync(data, size, MS_SYNC);
+#endif
+	}
+}
+
+void VIPR_Emulator::MappedFile::Close()
+{
+	Flush();
+	Unmap();
+	if (file != no_file_handle)
+	{
+		CloseNativeFile(file);
+		file = no_file_handle;
+	}
+	size = 0;
+	open = false;
+}
+
+bool VIPR_Emulator::MappedFile::Map()
+{
+	if (size == 0) // Neither mmap nor MapViewOfFile can map nothing, but an empty file is still a valid image
+	{
+		return true;
+	}
+#ifdef _WIN32
+	uint64_t mapping_size = static_cast<uint64_t>(size);
+	HANDLE mapping = CreateFileMappingA(file, nullptr, (mode == MappedFileMode::ReadWrite) ? PAGE_READWRITE : PAGE_WRITECOPY, static_cast<DWORD>(mapping_size >> 32), static_cast<DWORD>(mapping_size & 0xFFFFFFFF), nullptr);
+	if (mapping == nullptr)
+	{
+		return false;
+	}
+	void *view = MapViewOfFile(mapping, (mode == MappedFileMode::ReadWrite) ? FILE_MAP_WRITE : FILE_MAP_COPY, 0, 0, size); // FILE_MAP_COPY is copy-on-write like MAP_PRIVATE
+	CloseHandle(mapping); // The view keeps the mapping object alive
+	if (view == nullptr)
+	{
+		return false;
+	}
+	data = static_cast<uint8_t *>(view);
+#else
+	void *mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, (mode == MappedFileMode::ReadWrite) ? MAP_SHARED : MAP_PRIVATE, file, 0);
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+	data = static_cast<uint8_t *>(mapping);
+#endif
+	return true;
+}
+
+void VIPR_Emulator::MappedFile::Unmap()
+{
+	if (data != nullptr)
+	{
+#ifdef _WIN32
+		UnmapViewOfFile(data);
+#else
+		munmap(data, size);
+#endif
+		data = nullptr;
+	}
+}
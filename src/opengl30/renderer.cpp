@@ -1,12 +1,13 @@
 #include "renderer.hpp"
 #include "shaders.hpp"
+#include "trace.hpp"
 #include <fmt/core.h>
 #include <memory>
 #include <bit>
 #include <fstream>
 #include <msbtfont/msbtfont.h>
 
-VIPR_Emulator::Renderer::Renderer() : CurrentWindow(nullptr), MainContext(nullptr), PrimaryVertexShaderId(0), SecondaryFramebufferFragmentShaderId(0), FontFragmentShaderId(0), MachineFragmentShaderId(0), SecondaryFramebufferProgramId(0), FontProgramId(0), MachineProgramId(0), CurrentProgramId(0), VAOId(0), VBOId(0), IBOId(0), FontControlUBOId(0), SecondaryFramebufferTextureId(0), MenuFontTextureId(0), DisplayTextureId(0), CurrentTextureId(0), SFBOId(0), CurrentFBOId(0), CurrentDisplayType(DisplayType::Emulator), font_ctrl { ColorData<float> { 0.0f, 0.0f, 0.0f, 1.0f }, 0x00 }
+VIPR_Emulator::Renderer::Renderer() : CurrentWindow(nullptr), MainContext(nullptr), PrimaryVertexShaderId(0), SecondaryFramebufferFragmentShaderId(0), FontFragmentShaderId(0), MachineFragmentShaderId(0), SecondaryFramebufferProgramId(0), FontProgramId(0), MachineProgramId(0), CurrentProgramId(0), VAOId(0), VBOId(0), IBOId(0), FontControlUBOId(0), SecondaryFramebufferTextureId(0), MenuFontTextureId(0), DisplayTextureId(0), CurrentTextureId(0), SFBOId(0), CurrentFBOId(0), CurrentDisplayType(DisplayType::Emulator), font_ctrl { ColorData<float> { 0.0f, 0.0f, 0.0f, 1.0f }, 0x00 }, menu_font_loaded(false)
 {
 	vertices = {
 		Vertex { { -1.0f, 1.0f }, { 0.0f, 1.0f } },
@@ -14,7 +15,20 @@ VIPR_Emulator::Renderer::Renderer() : CurrentWindow(nullptr), MainContext(nullpt
 		Vertex { { -1.0f, -1.0f }, { 0.0f, 0.0f } },
 		Vertex { { 1.0f, -1.0f }, { 1.0f, 0.0f } }
 	};
-	indices = { 0, 2, 1, 2, 3, 1 };
+	indices.resize((max_batch_glyphs + 1) * 6);
+	for (uint16_t i = 0; i < max_batch_glyphs + 1; ++i)
+	{
+		uint16_t base = i * 4;
+		uint16_t *current_indices = &indices[i * 6];
+		current_indices[0] = base;
+		current_indices[1] = base + 2;
+		current_indices[2] = base + 1;
+		current_indices[3] = base + 2;
+		current_indices[4] = base + 3;
+		current_indices[5] = base + 1;
+	}
+	glyph_vertices.reserve(max_batch_glyphs * 4);
+	overlay_vertices.reserve(max_batch_glyphs * 4);
 	for (size_t i = 0; i < display_buffer.size(); ++i)
 	{
 		display_buffer[i] = ColorData<uint8_t> { 0, 0, 0, 255 };
@@ -169,9 +183,10 @@ bool VIPR_Emulator::Renderer::Setup(SDL_Window *window)
 		glGenBuffers(1, &FontControlUBOId);
 		glBindVertexArray(VAOId);
 		glBindBuffer(GL_ARRAY_BUFFER, VBOId);
-		glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_DYNAMIC_DRAW);
+		glBufferData(GL_ARRAY_BUFFER, (vertices.size() + (max_batch_glyphs * 4)) * sizeof(Vertex), nullptr, GL_DYNAMIC_DRAW);
+		glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBOId);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint8_t), indices.data(), GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint16_t), indices.data(), GL_STATIC_DRAW);
 		glBindBufferRange(GL_UNIFORM_BUFFER, 0, FontControlUBOId, 0, sizeof(FontControlData));
 		glBufferData(GL_UNIFORM_BUFFER, sizeof(FontControlData), &font_ctrl, GL_STATIC_DRAW);
 		glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void *>(0));
@@ -190,31 +205,6 @@ bool VIPR_Emulator::Renderer::Setup(SDL_Window *window)
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
 		glTexStorage2D(GL_TEXTURE_2D, 1, GL_R8UI, 128, 48);
-		{
-			std::ifstream vipr_font_file("vipr_menu_font.mbft", std::ios::binary);
-			if (vipr_font_file.fail())
-			{
-				fmt::print("Unable to load 'vipr_menu_font.mbft'.\n");
-				return false;
-			}
-			msbtfont_header header;
-			msbtfont_filedata filedata;
-			vipr_font_file.read(reinterpret_cast<char *>(&header), sizeof(header));
-			msbtfont_create_filedata(&header, &filedata);
-			vipr_font_file.read(reinterpret_cast<char *>(filedata.data), filedata.size);
-			msbtfont_surface_descriptor surface_desc;
-			surface_desc.rect.x = 0;
-			surface_desc.rect.y = 0;
-			surface_desc.rect.width = 128;
-			surface_desc.rect.height = 48;
-			surface_desc.format = MSBTFONT_SURFACE_FORMAT_8;
-			surface_desc.origin = MSBTFONT_SURFACE_ORIGIN_LOWERLEFT;
-			size_t surface_memory_req = msbtfont_get_surface_memory_requirement(&surface_desc);
-			std::vector<uint8_t> font_surface(surface_memory_req);
-			msbtfont_copy_to_surface(&header, &filedata, 16, 0, &surface_desc, font_surface.data());
-			glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 128, 48, GL_RED_INTEGER, GL_UNSIGNED_BYTE, font_surface.data());
-			msbtfont_delete_filedata(&filedata);
-		}
 		glBindTexture(GL_TEXTURE_2D, DisplayTextureId);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -237,6 +227,8 @@ bool VIPR_Emulator::Renderer::Setup(SDL_Window *window)
 
 void VIPR_Emulator::Renderer::Render()
 {
+	VIPR_TRACE_ZONE("Renderer::Render");
+	FlushText();
 	if (CurrentFBOId != 0)
 	{
 		CurrentFBOId = 0;
@@ -274,18 +266,40 @@ void VIPR_Emulator::Renderer::Render()
 		}
 	}
 	glClear(GL_COLOR_BUFFER_BIT);
-	glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_BYTE, reinterpret_cast<void *>(0));
-	SDL_GL_SwapWindow(CurrentWindow);
+	glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, reinterpret_cast<void *>(0));
+	if (CurrentDisplayType == DisplayType::Machine && overlay_vertices.size() > 0)
+	{
+		DrawOverlay();
+	}
+	{
+		VIPR_TRACE_ZONE("SDL_GL_SwapWindow");
+		SDL_GL_SwapWindow(CurrentWindow);
+	}
 }
 
 void VIPR_Emulator::Renderer::ClearSecondaryFramebuffer()
 {
+	glyph_vertices.clear(); // Anything still pending would be cleared anyway
+	if (CurrentFBOId != SFBOId)
+	{
+		CurrentFBOId = SFBOId;
+		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, SFBOId);
+	}
+	glClear(GL_COLOR_BUFFER_BIT);
+}
+
+void VIPR_Emulator::Renderer::ClearSecondaryFramebufferRegion(uint16_t x, uint16_t y, uint16_t width, uint16_t height)
+{
+	FlushText();
 	if (CurrentFBOId != SFBOId)
 	{
 		CurrentFBOId = SFBOId;
 		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, SFBOId);
 	}
+	glEnable(GL_SCISSOR_TEST);
+	glScissor(x * 2, (320 - (y + height)) * 2, width * 2, height * 2);
 	glClear(GL_COLOR_BUFFER_BIT);
+	glDisable(GL_SCISSOR_TEST);
 }
 
 void VIPR_Emulator::Renderer::ClearDisplay()
@@ -318,6 +332,7 @@ void VIPR_Emulator::Renderer::SetFontColor(uint8_t r, uint8_t g, uint8_t b)
 	ColorData<float> color = { r / 255.0f, g / 255.0f, b / 255.0f, 1.0f };
 	if (font_ctrl.FontColor.r != color.r || font_ctrl.FontColor.g != color.g || font_ctrl.FontColor.b != color.b)
 	{
+		FlushText();
 		font_ctrl.FontColor = color;
 		glBindBuffer(GL_UNIFORM_BUFFER, FontControlUBOId);
 		glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(font_ctrl.FontColor), &font_ctrl.FontColor);
@@ -328,6 +343,7 @@ void VIPR_Emulator::Renderer::SetFontFlags(uint32_t flags)
 {
 	if (font_ctrl.FontFlags != flags)
 	{
+		FlushText();
 		font_ctrl.FontFlags = flags;
 		glBindBuffer(GL_UNIFORM_BUFFER, FontControlUBOId);
 		constexpr size_t offset = sizeof(font_ctrl.FontColor);
@@ -335,24 +351,78 @@ void VIPR_Emulator::Renderer::SetFontFlags(uint32_t flags)
 	}
 }
 
+bool VIPR_Emulator::Renderer::LoadMenuFont()
+{
+	if (menu_font_loaded)
+	{
+		return true;
+	}
+	menu_font_loaded = true; // Only tried once; without the font, text is left blank
+	glBindTexture(GL_TEXTURE_2D, MenuFontTextureId);
+	std::ifstream vipr_font_file("vipr_menu_font.mbft", std::ios::binary);
+	if (vipr_font_file.fail())
+	{
+		fmt::print("Unable to load 'vipr_menu_font.mbft'.\n");
+		glBindTexture(GL_TEXTURE_2D, CurrentTextureId);
+		return false;
+	}
+	msbtfont_header header;
+	msbtfont_filedata filedata;
+	vipr_font_file.read(reinterpret_cast<char *>(&header), sizeof(header));
+	msbtfont_create_filedata(&header, &filedata);
+	vipr_font_file.read(reinterpret_cast<char *>(filedata.data), filedata.size);
+	msbtfont_surface_descriptor surface_desc;
+	surface_desc.rect.x = 0;
+	surface_desc.rect.y = 0;
+	surface_desc.rect.width = 128;
+	surface_desc.rect.height = 48;
+	surface_desc.format = MSBTFONT_SURFACE_FORMAT_8;
+	surface_desc.origin = MSBTFONT_SURFACE_ORIGIN_LOWERLEFT;
+	size_t surface_memory_req = msbtfont_get_surface_memory_requirement(&surface_desc);
+	std::vector<uint8_t> font_surface(surface_memory_req);
+	msbtfont_copy_to_surface(&header, &filedata, 16, 0, &surface_desc, font_surface.data());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 128, 48, GL_RED_INTEGER, GL_UNSIGNED_BYTE, font_surface.data());
+	msbtfont_delete_filedata(&filedata);
+	glBindTexture(GL_TEXTURE_2D, CurrentTextureId);
+	return true;
+}
+
 void VIPR_Emulator::Renderer::DrawChar(char character, uint16_t x, uint16_t y)
 {
-	if (CurrentTextureId != MenuFontTextureId)
+	if (!menu_font_loaded)
 	{
-		CurrentTextureId = MenuFontTextureId;
-		glBindTexture(GL_TEXTURE_2D, MenuFontTextureId);
+		LoadMenuFont();
 	}
-	if (CurrentFBOId != SFBOId)
+	AppendGlyph(character, x, y);
+}
+
+void VIPR_Emulator::Renderer::DrawText(std::string_view text, uint16_t x, uint16_t y)
+{
+	if (!menu_font_loaded)
 	{
-		CurrentFBOId = SFBOId;
-		glBindFramebuffer(GL_DRAW_FRAMEBUFFER, SFBOId);
+		LoadMenuFont();
 	}
-	if (CurrentProgramId != FontProgramId)
+	for (size_t i = 0; i < text.size(); ++i)
 	{
-		CurrentProgramId = FontProgramId;
-		glUseProgram(FontProgramId);
+		if (text[i] < 32 || text[i] > 126)
+		{
+			continue;
+		}
+		AppendGlyph(text[i], x + (i * 8), y);
 	}
-	std::array<Vertex, 4> original_vertices = vertices;
+}
+
+void VIPR_Emulator::Renderer::AppendGlyph(char character, uint16_t x, uint16_t y)
+{
+	if (glyph_vertices.size() == max_batch_glyphs * 4)
+	{
+		FlushText();
+	}
+	AppendGlyphVertices(glyph_vertices, character, x, y);
+}
+
+void VIPR_Emulator::Renderer::AppendGlyphVertices(std::vector<Vertex> &glyph_list, char character, uint16_t x, uint16_t y)
+{
 	float left_x = (x / 320.0f) - 1.0f;
 	float right_x = ((x + 8) / 320.0f) - 1.0f;
 	float up_y = 1.0f - (y / 160.0f);
@@ -362,20 +432,63 @@ void VIPR_Emulator::Renderer::DrawChar(char character, uint16_t x, uint16_t y)
 	float tex_right_x = ((current_character % 16 * 8) + 8) / 128.0f;
 	float tex_up_y = 1.0f - ((current_character / 16 * 8) / 48.0f);
 	float tex_down_y = 1.0f - (((current_character / 16 * 8) + 8) / 48.0f);
-	vertices = {
-		Vertex { { left_x, up_y }, { tex_left_x, tex_up_y } },
-		Vertex { { right_x, up_y }, { tex_right_x, tex_up_y } },
-		Vertex { { left_x, down_y }, { tex_left_x, tex_down_y } },
-		Vertex { { right_x, down_y }, { tex_right_x, tex_down_y } }
-	};
-	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
-	glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_BYTE, reinterpret_cast<void *>(0));
-	vertices = original_vertices;
-	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+	glyph_list.push_back(Vertex { { left_x, up_y }, { tex_left_x, tex_up_y } });
+	glyph_list.push_back(Vertex { { right_x, up_y }, { tex_right_x, tex_up_y } });
+	glyph_list.push_back(Vertex { { left_x, down_y }, { tex_left_x, tex_down_y } });
+	glyph_list.push_back(Vertex { { right_x, down_y }, { tex_right_x, tex_down_y } });
+}
+
+void VIPR_Emulator::Renderer::SetOverlayText(std::string_view text)
+{
+	if (!menu_font_loaded)
+	{
+		LoadMenuFont();
+	}
+	overlay_vertices.clear();
+	uint16_t x = 8;
+	uint16_t y = 8;
+	for (size_t i = 0; i < text.size() && overlay_vertices.size() < max_batch_glyphs * 4; ++i)
+	{
+		if (text[i] == '\n')
+		{
+			x = 8;
+			y += 10;
+			continue;
+		}
+		if (text[i] >= 32 && text[i] <= 126)
+		{
+			AppendGlyphVertices(overlay_vertices, text[i], x, y);
+		}
+		x += 8;
+	}
 }
 
-void VIPR_Emulator::Renderer::DrawText(std::string text, uint16_t x, uint16_t y)
+void VIPR_Emulator::Renderer::DrawOverlay() // Uses the menu font on the default framebuffer, then restores the menu's font state
 {
+	if (CurrentTextureId != MenuFontTextureId)
+	{
+		CurrentTextureId = MenuFontTextureId;
+		glBindTexture(GL_TEXTURE_2D, MenuFontTextureId);
+	}
+	if (CurrentProgramId != FontProgramId)
+	{
+		CurrentProgramId = FontProgramId;
+		glUseProgram(FontProgramId);
+	}
+	constexpr FontControlData overlay_font_ctrl { ColorData<float> { 1.0f, 1.0f, 0.0f, 1.0f }, 0x00 };
+	glBindBuffer(GL_UNIFORM_BUFFER, FontControlUBOId);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(overlay_font_ctrl), &overlay_font_ctrl);
+	glBufferSubData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), overlay_vertices.size() * sizeof(Vertex), overlay_vertices.data());
+	glDrawElements(GL_TRIANGLES, (overlay_vertices.size() / 4) * 6, GL_UNSIGNED_SHORT, reinterpret_cast<void *>(6 * sizeof(uint16_t)));
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(font_ctrl), &font_ctrl);
+}
+
+void VIPR_Emulator::Renderer::FlushText()
+{
+	if (glyph_vertices.size() == 0)
+	{
+		return;
+	}
 	if (CurrentTextureId != MenuFontTextureId)
 	{
 		CurrentTextureId = MenuFontTextureId;
@@ -391,37 +504,14 @@ void VIPR_Emulator::Renderer::DrawText(std::string text, uint16_t x, uint16_t y)
 		CurrentProgramId = FontProgramId;
 		glUseProgram(FontProgramId);
 	}
-	std::array<Vertex, 4> original_vertices = vertices;
-	float up_y = 1.0f - (y / 160.0f);
-	float down_y = 1.0f - ((y + 8) / 160.0f);
-	for (size_t i = 0; i < text.size(); ++i)
-	{
-		if (text[i] < 32 || text[i] > 126)
-		{
-			continue;
-		}
-		float left_x = ((x + (i * 8)) / 320.0f) - 1.0f;
-		float right_x = ((x + (i * 8) + 8) / 320.0f) - 1.0f;
-		char current_character = text[i] - 32;
-		float tex_left_x = (current_character % 16 * 8) / 128.0f;
-		float tex_right_x = ((current_character % 16 * 8) + 8) / 128.0f;
-		float tex_up_y = 1.0f - ((current_character / 16 * 8) / 48.0f);
-		float tex_down_y = 1.0f - (((current_character / 16 * 8) + 8) / 48.0f);
-		vertices = {
-			Vertex { { left_x, up_y }, { tex_left_x, tex_up_y } },
-			Vertex { { right_x, up_y }, { tex_right_x, tex_up_y } },
-			Vertex { { left_x, down_y }, { tex_left_x, tex_down_y } },
-			Vertex { { right_x, down_y }, { tex_right_x, tex_down_y } }
-		};
-		glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
-		glDrawElements(GL_TRIANGLES, indices.size(), GL_UNSIGNED_BYTE, reinterpret_cast<void *>(0));
-	}
-	vertices = original_vertices;
-	glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(Vertex), vertices.data());
+	glBufferSubData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), glyph_vertices.size() * sizeof(Vertex), glyph_vertices.data());
+	glDrawElements(GL_TRIANGLES, (glyph_vertices.size() / 4) * 6, GL_UNSIGNED_SHORT, reinterpret_cast<void *>(6 * sizeof(uint16_t)));
+	glyph_vertices.clear();
 }
 
 void VIPR_Emulator::Renderer::DrawByte(uint8_t data, uint8_t line, uint8_t offset, uint8_t background_color, uint8_t dot_color)
 {
+	VIPR_TRACE_ZONE("Renderer::DrawByte");
 	if (CurrentTextureId != DisplayTextureId)
 	{
 		CurrentTextureId = DisplayTextureId;
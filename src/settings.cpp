@@ -0,0 +1,272 @@
+#include "settings.hpp"
+#include "mapped_file.hpp"
+#include "headless.hpp"
+#include "audio.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <fmt/core.h>
+
+namespace
+{
+	constexpr std::array<std::string_view, 5> board_names { "vp585", "vp590", "vp595", "vp550", "vp551" }; // In ExpansionBoardType order
+	constexpr std::array<std::string_view, 3> source_volume_names { "tone_volume", "vp595_volume", "vp550_volume" }; // In SoundSourceType order
+
+	inline std::string_view Trim(std::string_view text)
+	{
+		size_t start = text.find_first_not_of(" \t\r");
+		if (start == std::string_view::npos)
+		{
+			return std::string_view();
+		}
+		return text.substr(start, text.find_last_not_of(" \t\r") - start + 1);
+	}
+
+	bool ParseNumber(std::string_view value, int minimum, int maximum, int &number)
+	{
+		int parsed = 0;
+		std::from_chars_result result = std::from_chars(value.data(), value.data() + value.size(), parsed);
+		if (result.ec != std::errc() || result.ptr != value.data() + value.size())
+		{
+			return false;
+		}
+		number = std::clamp(parsed, minimum, maximum);
+		return true;
+	}
+
+	bool ParseBoolean(std::string_view value, bool &toggle)
+	{
+		if (value == "true" || value == "yes" || value == "1")
+		{
+			toggle = true;
+			return true;
+		}
+		if (value == "false" || value == "no" || value == "0")
+		{
+			toggle = false;
+			return true;
+		}
+		return false;
+	}
+
+	bool ParseBoards(std::string_view value, std::array<bool, 5> &ExpansionBoard)
+	{
+		std::array<bool, 5> ParsedBoards { false, false, false, false, false };
+		while (value.size() > 0)
+		{
+			size_t separator = std::min(value.find(','), value.size());
+			std::string_view board = Trim(value.substr(0, separator));
+			if (board.size() > 0 && !VIPR_Emulator::ParseExpansionBoard(std::string(board), ParsedBoards))
+			{
+				return false;
+			}
+			value.remove_prefix(std::min(separator + 1, value.size()));
+		}
+		ExpansionBoard = ParsedBoards;
+		return true;
+	}
+
+	bool ApplySetting(VIPR_Emulator::Settings &CurrentSettings, std::string_view section, std::string_view key, std::string_view value)
+	{
+		int number = 0;
+		if (section == "machine")
+		{
+			if (key == "rom")
+			{
+				CurrentSettings.rom_file = value;
+				return true;
+			}
+			if (key == "ram" && ParseNumber(value, 1, 32, number))
+			{
+				CurrentSettings.ram_kb = static_cast<uint8_t>(number);
+				return true;
+			}
+			if (key == "ram_file")
+			{
+				CurrentSettings.ram_file = value;
+				return true;
+			}
+			if (key == "boards")
+			{
+				return ParseBoards(value, CurrentSettings.ExpansionBoard);
+			}
+			if (key == "autostart")
+			{
+				return ParseBoolean(value, CurrentSettings.autostart);
+			}
+		}
+		else if (section == "audio")
+		{
+			if (key == "device")
+			{
+				CurrentSettings.audio_device = value;
+				return true;
+			}
+			if (key == "volume" && ParseNumber(value, 0, 100, number))
+			{
+				CurrentSettings.volume = static_cast<uint8_t>(number);
+				return true;
+			}
+			if (key == "latency" && ParseNumber(value, VIPR_Emulator::audio_latency_min, VIPR_Emulator::audio_latency_max, number))
+			{
+				CurrentSettings.audio_latency = static_cast<uint16_t>(number);
+				return true;
+			}
+			for (size_t i = 0; i < source_volume_names.size(); ++i)
+			{
+				if (key == source_volume_names[i] && ParseNumber(value, 0, 100, number))
+				{
+					CurrentSettings.SourceVolume[i] = static_cast<uint8_t>(number);
+					return true;
+				}
+			}
+		}
+		return false;
+	}
+}
+
+VIPR_Emulator::Settings VIPR_Emulator::GetDefaultSettings()
+{
+	return Settings { false, 2, 50, audio_latency_default, "", "", "", { false, false, false, false, false }, { 100, 100, 100 } };
+}
+
+VIPR_Emulator::SettingsStore::SettingsStore(const std::string &settings_file) : settings_file(settings_file), CurrentSettings(GetDefaultSettings()), PendingSettings(CurrentSettings), save_pending(false), processing(false)
+{
+}
+
+VIPR_Emulator::SettingsStore::~SettingsStore()
+{
+	if (WriterThread.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> save_lock(lock);
+			processing = false;
+		}
+		save_signal.notify_one();
+		WriterThread.join();
+	}
+}
+
+bool VIPR_Emulator::SettingsStore::Load()
+{
+	MappedFile SettingsImage;
+	if (!SettingsImage.Open(settings_file, MappedFileMode::Read))
+	{
+		return false;
+	}
+	std::string_view text(reinterpret_cast<const char *>(SettingsImage.GetData()), SettingsImage.GetSize());
+	std::string_view section;
+	size_t line_number = 0;
+	while (text.size() > 0) // One pass over the mapped file, with every setting applied as it's reached
+	{
+		size_t line_end = std::min(text.find('\n'), text.size());
+		std::string_view line = Trim(text.substr(0, line_end));
+		text.remove_prefix(std::min(line_end + 1, text.size()));
+		++line_number;
+		if (line.size() == 0 || line[0] == '#' || line[0] == ';')
+		{
+			continue;
+		}
+		if (line[0] == '[' && line.back() == ']')
+		{
+			section = Trim(line.substr(1, line.size() - 2));
+			continue;
+		}
+		size_t separator = line.find('=');
+		if (separator == std::string_view::npos || !ApplySetting(CurrentSettings, section, Trim(line.substr(0, separator)), Trim(line.substr(separator + 1))))
+		{
+			fmt::print("Ignoring line {} of '{}'.\n", line_number, settings_file);
+		}
+	}
+	return true;
+}
+
+void VIPR_Emulator::SettingsStore::Save()
+{
+	{
+		std::lock_guard<std::mutex> save_lock(lock);
+		PendingSettings = CurrentSettings;
+		save_pending = true;
+		if (!processing)
+		{
+			processing = true;
+			WriterThread = std::thread(SettingsStore::WriterProcessor, this);
+		}
+	}
+	save_signal.notify_one();
+}
+
+bool VIPR_Emulator::SettingsStore::WriteFile(const Settings &SavedSettings)
+{
+	VIPR_TRACE_ZONE("SettingsStore::WriteFile");
+	std::string boards;
+	for (size_t i = 0; i < board_names.size(); ++i)
+	{
+		if (SavedSettings.ExpansionBoard[i])
+		{
+			boards += fmt::format("{}{}", (boards.size() > 0) ? ", " : "", board_names[i]);
+		}
+	}
+	std::string temporary_file = settings_file + ".tmp"; // Written in full and then renamed over the old file, so it's never left half written
+	{
+		std::ofstream settings_output(temporary_file, std::ios::trunc);
+		if (settings_output.fail())
+		{
+			fmt::print("Unable to save settings to '{}'.\n", settings_file);
+			return false;
+		}
+		settings_output << "# VIPR Emulator settings, saved whenever they're changed in the menus\n\n";
+		settings_output << "[machine]\n";
+		settings_output << fmt::format("rom = {}\n", SavedSettings.rom_file);
+		settings_output << fmt::format("ram = {}\n", SavedSettings.ram_kb);
+		settings_output << fmt::format("ram_file = {}\n", SavedSettings.ram_file);
+		settings_output << fmt::format("boards = {}\n", boards);
+		settings_output << fmt::format("autostart = {}\n\n", SavedSettings.autostart);
+		settings_output << "[audio]\n";
+		settings_output << fmt::format("device = {}\n", SavedSettings.audio_device);
+		settings_output << fmt::format("volume = {}\n", SavedSettings.volume);
+		settings_output << fmt::format("latency = {}\n", SavedSettings.audio_latency);
+		for (size_t i = 0; i < source_volume_names.size(); ++i)
+		{
+			settings_output << fmt::format("{} = {}\n", source_volume_names[i], SavedSettings.SourceVolume[i]);
+		}
+		if (settings_output.fail())
+		{
+			fmt::print("Unable to save settings to '{}'.\n", settings_file);
+			return false;
+		}
+	}
+	std::error_code error;
+	std::filesystem::rename(temporary_file, settings_file, error);
+	if (error)
+	{
+		fmt::print("Unable to save settings to '{}'.\n", settings_file);
+		return false;
+	}
+	return true;
+}
+
+void VIPR_Emulator::SettingsStore::WriterProcessor(SettingsStore *store)
+{
+	VIPR_TRACE_THREAD_NAME("Settings Writer");
+	std::unique_lock<std::mutex> save_lock(store->lock);
+	while (true)
+	{
+		store->save_signal.wait(save_lock, [store] { return store->save_pending || !store->processing; });
+		if (store->save_pending)
+		{
+			Settings SavedSettings = store->PendingSettings;
+			store->save_pending = false;
+			save_lock.unlock();
+			store->WriteFile(SavedSettings);
+			save_lock.lock();
+		}
+		else
+		{
+			break;
+		}
+	}
+}
@@ -0,0 +1,78 @@
+#include "trace.hpp"
+#include <algorithm>
+#include <fstream>
+#include <fmt/core.h>
+
+namespace
+{
+	struct TraceEventCopy
+	{
+		const char *name;
+		uint64_t start_ns;
+		uint64_t duration_ns;
+	};
+}
+
+VIPR_Emulator::TraceBuffer::TraceBuffer(uint32_t thread_id) : Events(std::make_unique<TraceEvent[]>(buffer_events)), write_index(0), thread_name(nullptr), thread_id(thread_id)
+{
+}
+
+VIPR_Emulator::TraceBuffer::~TraceBuffer()
+{
+}
+
+VIPR_Emulator::Tracer::Tracer() : start_tp(std::chrono::steady_clock::now())
+{
+}
+
+VIPR_Emulator::Tracer &VIPR_Emulator::Tracer::Get()
+{
+	static Tracer MainTracer;
+	return MainTracer;
+}
+
+VIPR_Emulator::TraceBuffer *VIPR_Emulator::Tracer::CreateThreadBuffer()
+{
+	std::lock_guard<std::mutex> lock(buffer_lock);
+	Buffers.push_back(std::make_unique<TraceBuffer>(static_cast<uint32_t>(Buffers.size() + 1)));
+	return Buffers.back().get();
+}
+
+bool VIPR_Emulator::Tracer::WriteChromeTrace(const std::string &trace_file)
+{
+	std::ofstream trace_output(trace_file, std::ios::trunc);
+	if (trace_output.fail())
+	{
+		fmt::print("Unable to create trace file '{}'.\n", trace_file);
+		return false;
+	}
+	std::lock_guard<std::mutex> lock(buffer_lock);
+	std::string trace_events;
+	size_t event_count = 0;
+	for (const std::unique_ptr<TraceBuffer> &CurrentBuffer : Buffers)
+	{
+		const char *thread_name = CurrentBuffer->thread_name.load(std::memory_order_relaxed);
+		trace_events += fmt::format("{}\n\t\t{{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": {}, \"args\": {{ \"name\": \"{}\" }} }}", (event_count > 0) ? "," : "", CurrentBuffer->thread_id, (thread_name != nullptr) ? thread_name : fmt::format("Thread {}", CurrentBuffer->thread_id));
+		++event_count;
+		uint64_t end_index = CurrentBuffer->write_index.load(std::memory_order_acquire);
+		uint64_t start_index = (end_index > TraceBuffer::buffer_events) ? end_index - TraceBuffer::buffer_events : 0;
+		std::vector<TraceEventCopy> Events;
+		Events.reserve(end_index - start_index);
+		for (uint64_t i = start_index; i < end_index; ++i)
+		{
+			const TraceEvent &CurrentEvent = CurrentBuffer->Events[i & (TraceBuffer::buffer_events - 1)];
+			Events.push_back(TraceEventCopy { CurrentEvent.name.load(std::memory_order_relaxed), CurrentEvent.start_ns.load(std::memory_order_relaxed), CurrentEvent.duration_ns.load(std::memory_order_relaxed) });
+		}
+		uint64_t overwritten_index = CurrentBuffer->write_index.load(std::memory_order_acquire); // The thread kept recording while this one copied, so drop whatever it may have overwritten
+		uint64_t first_intact_index = (overwritten_index >= TraceBuffer::buffer_events) ? overwritten_index - TraceBuffer::buffer_events + 1 : 0;
+		size_t skip_events = (first_intact_index > start_index) ? static_cast<size_t>(std::min(first_intact_index, end_index) - start_index) : 0;
+		for (size_t i = skip_events; i < Events.size(); ++i)
+		{
+			trace_events += fmt::format(",\n\t\t{{ \"name\": \"{}\", \"ph\": \"X\", \"pid\": 1, \"tid\": {}, \"ts\": {:.3f}, \"dur\": {:.3f} }}", Events[i].name, CurrentBuffer->thread_id, Events[i].start_ns / 1000.0, Events[i].duration_ns / 1000.0);
+			++event_count;
+		}
+	}
+	trace_output << "{\n\t\"displayTimeUnit\": \"ns\",\n\t\"traceEvents\": [" << trace_events << "\n\t]\n}\n";
+	fmt::print("Wrote {} trace events to '{}'.\n", event_count, trace_file);
+	return true;
+}
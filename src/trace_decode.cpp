@@ -0,0 +1,97 @@
+#include "instruction_trace.hpp"
+#include "cpu_profiler.hpp"
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <fmt/core.h>
+
+namespace
+{
+	template <typename T>
+	inline T ReadLE(const uint8_t *data)
+	{
+		uint64_t value = 0;
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			value |= static_cast<uint64_t>(data[i]) << (i * 8);
+		}
+		return static_cast<T>(value);
+	}
+
+	void PrintUsage()
+	{
+		fmt::print("Usage: vipr_trace_decode <trace.vitr> [--last N]\n");
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	using namespace VIPR_Emulator;
+	std::string trace_file;
+	size_t last_count = SIZE_MAX;
+	for (int i = 1; i < argc; ++i)
+	{
+		std::string argument = argv[i];
+		bool has_value = (i + 1 < argc);
+		if (argument == "--last" && has_value)
+		{
+			last_count = std::strtoul(argv[++i], nullptr, 10);
+		}
+		else if (argument.size() > 0 && argument[0] != '-' && trace_file.size() == 0)
+		{
+			trace_file = argument;
+		}
+		else
+		{
+			PrintUsage();
+			return -1;
+		}
+	}
+	if (trace_file.size() == 0)
+	{
+		PrintUsage();
+		return -1;
+	}
+	std::ifstream trace_input(trace_file, std::ios::binary);
+	if (trace_input.fail())
+	{
+		fmt::print("Unable to open instruction trace file '{}'.\n", trace_file);
+		return -1;
+	}
+	std::array<uint8_t, instruction_trace_header_size> header;
+	if (!trace_input.read(reinterpret_cast<char *>(header.data()), header.size()) || !std::equal(instruction_trace_magic.begin(), instruction_trace_magic.end(), header.begin()))
+	{
+		fmt::print("'{}' is not a VIPR instruction trace file.\n", trace_file);
+		return -1;
+	}
+	uint32_t entry_count = ReadLE<uint32_t>(&header[8]);
+	uint32_t dropped_count = ReadLE<uint32_t>(&header[12]);
+	std::vector<uint8_t> entry_data(static_cast<size_t>(entry_count) * sizeof(InstructionTraceEntry));
+	if (!trace_input.read(reinterpret_cast<char *>(entry_data.data()), entry_data.size()))
+	{
+		fmt::print("'{}' is truncated.\n", trace_file);
+		return -1;
+	}
+	std::array<std::string, 256> mnemonics; // Formatted once instead of for every line
+	for (size_t i = 0; i < mnemonics.size(); ++i)
+	{
+		mnemonics[i] = GetMnemonic(static_cast<uint8_t>(i));
+	}
+	size_t first_entry = entry_count - std::min<size_t>(entry_count, last_count);
+	fmt::print("{} instructions ({} older ones were overwritten)\n", entry_count, dropped_count + first_entry);
+	fmt::print("{:>14}  {:<6}{:<4}{:<10}{:<4}{:<4}{:<3}{}\n", "Cycle", "Addr", "Op", "Mnemonic", "D", "DF", "X", "P");
+	for (size_t i = first_entry; i < entry_count; ++i)
+	{
+		const uint8_t *entry = &entry_data[i * sizeof(InstructionTraceEntry)];
+		uint64_t machine_cycle = ReadLE<uint64_t>(&entry[0]);
+		uint16_t address = ReadLE<uint16_t>(&entry[8]);
+		uint8_t opcode = entry[10];
+		uint8_t XP = entry[13];
+		fmt::print("{:>14}  {:04X}  {:02X}  {:<10}{:02X}  {:<4}{:X}  {:X}\n", machine_cycle, address, opcode, mnemonics[opcode], entry[11], entry[12], XP >> 4, XP & 0xF);
+	}
+	return 0;
+}
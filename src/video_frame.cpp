@@ -0,0 +1,8 @@
+#include "video_frame.hpp"
+#include "xxhash.hpp"
+
+uint64_t VIPR_Emulator::HashVideoFrame(const VideoFrame &frame)
+{
+	uint64_t hash = XXHash64(frame.pixel_data.data(), frame.pixel_data.size());
+	return XXHash64(frame.color_data.data(), frame.color_data.size(), hash);
+}
@@ -0,0 +1,168 @@
+#include "vp550.hpp"
+#include "audio.hpp"
+#include <algorithm>
+
+VIPR_Emulator::VP550::VP550(CDP1802 *CPU, uint8_t voice_count) : CPU(CPU), volume(100), sync_enabled(false), sync_period(static_cast<uint32_t>(CPU->GetCycleFrequency() / 8.0 / 50.0)), sync_cycles_left(sync_period) // The sync interrupt runs at 50 Hz
+{
+	Voices.reserve(voice_count);
+	for (uint8_t i = 0; i < voice_count; ++i)
+	{
+		Voices.push_back(Voice { CDP1863(CPU->GetCycleFrequency(), CDP1863::InputClockType::Clock1), SquareWaveOscillator(1 << 16, 0), 1, 0xF });
+	}
+	for (Voice &CurrentVoice : Voices)
+	{
+		CurrentVoice.frequency_generator.SetDivideRate(0x80);
+		CurrentVoice.Oscillator = SquareWaveOscillator(GetHalfPeriod(CurrentVoice), GetAmplitude(CurrentVoice));
+	}
+	PendingEvents.reserve(256);
+}
+
+VIPR_Emulator::VP550::~VP550()
+{
+}
+
+void VIPR_Emulator::VP550::Render(BandLimitedSynth &synth, uint64_t frame_start_cycle, uint64_t frame_end_cycle)
+{
+	for (const AudioEvent &event : PendingEvents)
+	{
+		uint64_t event_machine_cycle = std::min(std::max(event.machine_cycle, frame_start_cycle), frame_end_cycle);
+		uint64_t event_time = ((event_machine_cycle - frame_start_cycle) * 8) << 16;
+		switch (event.type)
+		{
+			case AudioEventType::Tone:
+			{
+				for (Voice &CurrentVoice : Voices)
+				{
+					CurrentVoice.Oscillator.SetGate(synth, event_time, event.value != 0);
+				}
+				break;
+			}
+			case AudioEventType::Volume:
+			{
+				volume = event.value;
+				for (Voice &CurrentVoice : Voices)
+				{
+					CurrentVoice.Oscillator.SetAmplitude(synth, event_time, GetAmplitude(CurrentVoice));
+				}
+				break;
+			}
+			case AudioEventType::DivideRate:
+			{
+				Voice &CurrentVoice = Voices[event.channel];
+				CurrentVoice.frequency_generator.SetDivideRate(event.value);
+				CurrentVoice.Oscillator.SetHalfPeriod(synth, event_time, GetHalfPeriod(CurrentVoice));
+				break;
+			}
+			case AudioEventType::Level:
+			{
+				Voice &CurrentVoice = Voices[event.channel];
+				CurrentVoice.level = event.value;
+				CurrentVoice.Oscillator.SetAmplitude(synth, event_time, GetAmplitude(CurrentVoice));
+				break;
+			}
+			case AudioEventType::Octave:
+			{
+				Voice &CurrentVoice = Voices[event.channel];
+				if (event.value & 0x10)
+				{
+					CurrentVoice.clock_divider = 8 >> (event.value & 0x3);
+					CurrentVoice.frequency_generator.SetInputClock(CPU->GetCycleFrequency() / static_cast<double>(CurrentVoice.clock_divider), CDP1863::InputClockType::Clock2);
+				}
+				else
+				{
+					CurrentVoice.clock_divider = 1;
+					CurrentVoice.frequency_generator.SetInputClock(CPU->GetCycleFrequency(), CDP1863::InputClockType::Clock1);
+				}
+				CurrentVoice.Oscillator.SetHalfPeriod(synth, event_time, GetHalfPeriod(CurrentVoice));
+				break;
+			}
+		}
+	}
+	PendingEvents.clear();
+	uint64_t frame_time = ((frame_end_cycle - frame_start_cycle) * 8) << 16;
+	for (Voice &CurrentVoice : Voices) // Voices only touch the bus on their edges, so the cost of a frame scales with the number of edges rather than samples
+	{
+		CurrentVoice.Oscillator.Run(synth, frame_time);
+		CurrentVoice.Oscillator.EndFrame(frame_time);
+	}
+}
+
+void VIPR_Emulator::VP550::Silence(BandLimitedSynth &synth)
+{
+	for (Voice &CurrentVoice : Voices)
+	{
+		CurrentVoice.Oscillator.SetGate(synth, 0, false);
+	}
+}
+
+void VIPR_Emulator::VP550::Sync()
+{
+	if (sync_enabled)
+	{
+		--sync_cycles_left;
+		if (!sync_cycles_left)
+		{
+			sync_cycles_left = sync_period;
+			CPU->IssueInterruptRequest();
+		}
+	}
+}
+
+uint32_t VIPR_Emulator::VP550::GetQuietCycles(uint32_t machine_cycles) const
+{
+	return sync_enabled ? std::min(sync_cycles_left - 1, machine_cycles) : machine_cycles;
+}
+
+void VIPR_Emulator::VP550::SkipCycles(uint32_t machine_cycles)
+{
+	if (sync_enabled)
+	{
+		sync_cycles_left -= machine_cycles;
+	}
+}
+
+void VIPR_Emulator::VP550_memory_write(uint16_t address, uint8_t data, void *userdata)
+{
+	VP550 *SuperSoundBoard = static_cast<VP550 *>(userdata);
+	uint64_t machine_cycle = SuperSoundBoard->CPU->GetMachineCycleCount();
+	uint8_t first_voice = (SuperSoundBoard->GetVoiceCount() > 2 && (address & 0x04)) ? 2 : 0;
+	switch (address & 0x03)
+	{
+		case 0x1:
+		case 0x2:
+		{
+			uint8_t voice = first_voice + ((address & 0x03) - 1);
+			SuperSoundBoard->PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::DivideRate, data, voice });
+			break;
+		}
+		case 0x3:
+		{
+			uint8_t voice = (data >> 2) & 0x3;
+			if (voice < SuperSoundBoard->GetVoiceCount())
+			{
+				SuperSoundBoard->PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::Octave, static_cast<uint8_t>(data & 0x13), voice });
+			}
+			break;
+		}
+	}
+	switch (address & 0x30)
+	{
+		case 0x10:
+		case 0x20:
+		{
+			uint8_t voice = first_voice + (((address & 0x30) >> 4) - 1);
+			SuperSoundBoard->PendingEvents.push_back(AudioEvent { machine_cycle, AudioEventType::Level, static_cast<uint8_t>(data & 0xF), voice });
+			break;
+		}
+		case 0x30:
+		{
+			bool sync_enabled = (data & 0x1);
+			if (sync_enabled && !SuperSoundBoard->sync_enabled)
+			{
+				SuperSoundBoard->sync_cycles_left = SuperSoundBoard->sync_period;
+			}
+			SuperSoundBoard->sync_enabled = sync_enabled;
+			break;
+		}
+	}
+}
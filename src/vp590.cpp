@@ -1,7 +1,7 @@
 #include "vp590.hpp"
 #include <cstring>
 
-VIPR_Emulator::VP590::VP590(CDP1802 *CPU) : VDC(CPU, 0, VP590_video_output, this), color_generator(color_data_RAM.data()), current_resolution_mode(ResolutionMode::Low), DisplayRenderer(nullptr)
+VIPR_Emulator::VP590::VP590(CDP1802 *CPU, ColorVideoOutputCallback video_output_func, void *video_output_userdata) : VDC(CPU, 0, VP590_video_output, this), color_generator(color_data_RAM.data()), current_resolution_mode(ResolutionMode::Low), video_output_userdata(video_output_userdata), video_output_func(video_output_func)
 {
 	memset(color_data_RAM.data(), 0x00, color_data_RAM.size());
 }
@@ -15,12 +15,25 @@ void VIPR_Emulator::VP590::Sync()
 	VDC.Sync();
 }
 
+uint32_t VIPR_Emulator::VP590::GetQuietCycles(uint32_t machine_cycles) const
+{
+	return VDC.GetQuietCycles(machine_cycles);
+}
+
+void VIPR_Emulator::VP590::SkipCycles(uint32_t machine_cycles)
+{
+	VDC.SkipCycles(machine_cycles);
+}
+
 void VIPR_Emulator::VP590_video_output(uint8_t value, uint8_t line, size_t address, void *userdata)
 {
 	VP590 *ColorBoard = static_cast<VP590 *>(userdata);
 	uint8_t x = address;
 	uint8_t y = (ColorBoard->GetResolutionMode() == VP590::ResolutionMode::Low) ? (line / 32) * 8: (line / 4);
-	ColorBoard->DisplayRenderer->DrawByte(value, line, address, ColorBoard->color_generator.GetBackgroundColor(), ColorBoard->color_generator.GetDotColor(x, y));
+	if (ColorBoard->video_output_func != nullptr)
+	{
+		ColorBoard->video_output_func(value, line, address, ColorBoard->color_generator.GetBackgroundColor(), ColorBoard->color_generator.GetDotColor(x, y), ColorBoard->video_output_userdata);
+	}
 }
 
 void VIPR_Emulator::VP590_memory_write(uint16_t address, uint8_t data, void *userdata)
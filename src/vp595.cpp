@@ -1,95 +1,55 @@
 #include "vp595.hpp"
 #include "audio.hpp"
-#include <chrono>
-#include <fmt/core.h>
+#include <algorithm>
 
-VIPR_Emulator::VP595::VP595(double input_frequency) : processing(false), pause(false), generate_tone(false), volume(0.5), current_period(0.0), frequency_generator(input_frequency, CDP1863::InputClockType::Clock1)
+VIPR_Emulator::VP595::VP595(uint32_t clock_frequency) : frequency_generator(static_cast<double>(clock_frequency) / 8.0, CDP1863::InputClockType::Clock1), Oscillator(1 << 16, GetAudioAmplitude(100))
 {
-	SetFrequency(0x00);
+	frequency_generator.SetDivideRate(0x80);
+	Oscillator = SquareWaveOscillator(GetHalfPeriod(), GetAudioAmplitude(100));
+	PendingEvents.reserve(256);
 }
 
 VIPR_Emulator::VP595::~VP595()
 {
-	if (processing)
-	{
-		processing = false;
-		AudioProcessingThread.join();
-	}
-	SDL_PauseAudioDevice(device, 1);
-	SDL_CloseAudioDevice(device);
-}
-
-void VIPR_Emulator::VP595::SetupVP595(std::string output_audio_device)
-{
-	if (processing)
-	{
-		processing = false;
-		AudioProcessingThread.join();
-		SDL_PauseAudioDevice(device, 1);
-		SDL_CloseAudioDevice(device);
-	}
-	processing = true;
-	SDL_AudioSpec desired;
-	SDL_zero(desired);
-	desired.freq = 192000;
-	desired.channels = 1;
-	desired.samples= 4096;
-	desired.format = AUDIO_S32;
-	device = SDL_OpenAudioDevice(output_audio_device.c_str(), 0, &desired, &spec, 0);
-	SDL_PauseAudioDevice(device, 0);
-	AudioProcessingThread = std::thread(VP595::AudioProcessor, this);
 }
 
-void VIPR_Emulator::VP595::AudioProcessor(VP595 *generator)
+void VIPR_Emulator::VP595::Render(BandLimitedSynth &synth, uint64_t frame_start_cycle, uint64_t frame_end_cycle)
 {
-	std::chrono::high_resolution_clock::time_point audio_tp = std::chrono::high_resolution_clock::now();
-	double audio_accumulator = 0.0;
-	while (generator->processing)
+	for (const AudioEvent &event : PendingEvents)
 	{
-		AudioFrame current_frame;
-		for (size_t i = 0; i < current_frame.size(); )
+		uint64_t event_machine_cycle = std::min(std::max(event.machine_cycle, frame_start_cycle), frame_end_cycle);
+		uint64_t event_time = ((event_machine_cycle - frame_start_cycle) * 8) << 16;
+		switch (event.type)
 		{
-			bool idle = true;
-			std::chrono::high_resolution_clock::time_point current_tp = std::chrono::high_resolution_clock::now();
-			std::chrono::duration<double> delta_time = current_tp - audio_tp;
-			if (delta_time.count() > 0.25)
+			case AudioEventType::Tone:
 			{
-				delta_time = std::chrono::duration<double>(0.25);
+				Oscillator.SetGate(synth, event_time, event.value != 0);
+				break;
 			}
-			audio_accumulator += delta_time.count();
-			audio_tp = current_tp;
-			while (audio_accumulator >= 1.0 / static_cast<double>(generator->spec.freq) && i < current_frame.size())
+			case AudioEventType::DivideRate:
 			{
-				if (idle)
-				{
-					idle = false;
-				}
-				audio_accumulator -= 1.0 / static_cast<double>(generator->spec.freq);
-				double frequency = generator->frequency_generator.GetOutputFrequency();
-				double value = 0.0;
-				if (generator->generate_tone && !generator->pause)
-				{
-					value = generator->volume * 0.4 * ((generator->current_period < 0.5 / frequency) ? static_cast<double>(INT32_MAX) : static_cast<double>(INT32_MIN));
-				}
-				current_frame[i] = static_cast<int>(value);
-				generator->current_period += 1.0 / static_cast<double>(generator->spec.freq);
-				if (generator->current_period >= 1.0 / frequency)
-				{
-					generator->current_period -= 1.0 / frequency;
-				}
-				++i;
+				frequency_generator.SetDivideRate(event.value);
+				Oscillator.SetHalfPeriod(synth, event_time, GetHalfPeriod());
+				break;
 			}
-			if (idle)
+			case AudioEventType::Volume:
 			{
-				SDL_Delay(1);
+				Oscillator.SetAmplitude(synth, event_time, GetAudioAmplitude(event.value));
+				break;
+			}
+			default:
+			{
+				break;
 			}
 		}
-		constexpr size_t buffer_max = current_frame.size() * sizeof(int) * 2;
-		while (SDL_GetQueuedAudioSize(generator->device) >= buffer_max)
-		{
-			SDL_Delay(10);
-			audio_tp = std::chrono::high_resolution_clock::now();
-		}
-		SDL_QueueAudio(generator->device, current_frame.data(), current_frame.size() * sizeof(int));
 	}
+	PendingEvents.clear();
+	uint64_t frame_time = ((frame_end_cycle - frame_start_cycle) * 8) << 16;
+	Oscillator.Run(synth, frame_time);
+	Oscillator.EndFrame(frame_time);
+}
+
+void VIPR_Emulator::VP595::Silence(BandLimitedSynth &synth)
+{
+	Oscillator.SetGate(synth, 0, false);
 }
@@ -0,0 +1,159 @@
+#include "wave_writer.hpp"
+#include "trace.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fmt/core.h>
+
+namespace
+{
+	template <typename T>
+	inline void WriteLE(std::ofstream &output, T value)
+	{
+		for (size_t i = 0; i < sizeof(T); ++i)
+		{
+			output.put(static_cast<char>(static_cast<uint64_t>(value) >> (i * 8)));
+		}
+	}
+}
+
+VIPR_Emulator::WaveWriter::WaveWriter() : recording(false), processing(false), block_when_full(false), raw(false), sample_rate(0), data_size(0), dropped_blocks(0)
+{
+}
+
+VIPR_Emulator::WaveWriter::~WaveWriter()
+{
+	Stop();
+}
+
+bool VIPR_Emulator::WaveWriter::Start(const std::string &audio_file, uint32_t sample_rate)
+{
+	Stop();
+	audio_output.open(audio_file, std::ios::binary | std::ios::trunc);
+	if (audio_output.fail())
+	{
+		fmt::print("Unable to create audio file '{}'.\n", audio_file);
+		return false;
+	}
+	raw = (audio_file.size() >= 4 && audio_file.compare(audio_file.size() - 4, 4, ".raw") == 0);
+	this->sample_rate = sample_rate;
+	data_size = 0;
+	if (!raw)
+	{
+		WriteHeader(); // Sizes are filled in once the writer stops
+	}
+	while (BlockPool.AcquireRead() != nullptr)
+	{
+		BlockPool.CommitRead();
+	}
+	dropped_blocks = 0;
+	processing = true;
+	WriterThread = std::thread(WaveWriter::WriterProcessor, this);
+	recording = true;
+	return true;
+}
+
+void VIPR_Emulator::WaveWriter::Stop()
+{
+	recording = false;
+	if (processing)
+	{
+		processing = false;
+		WriterThread.join();
+		if (!raw)
+		{
+			audio_output.seekp(0);
+			WriteHeader();
+		}
+		audio_output.close();
+		if (dropped_blocks > 0)
+		{
+			fmt::print("Audio dump dropped {} blocks.\n", dropped_blocks.load());
+		}
+	}
+}
+
+void VIPR_Emulator::WaveWriter::SubmitAudio(const int *samples, size_t sample_count, int sample_rate)
+{
+	if (!recording || static_cast<uint32_t>(sample_rate) != this->sample_rate)
+	{
+		return;
+	}
+	while (sample_count > 0)
+	{
+		WaveAudioBlock *block = BlockPool.AcquireWrite();
+		if (block == nullptr)
+		{
+			if (!block_when_full)
+			{
+				++dropped_blocks;
+				return;
+			}
+			std::this_thread::yield();
+			continue;
+		}
+		size_t block_size = std::min(sample_count, block->samples.size());
+		for (size_t i = 0; i < block_size; ++i)
+		{
+			block->samples[i] = static_cast<int16_t>(samples[i] >> 16);
+		}
+		block->sample_count = static_cast<uint32_t>(block_size);
+		BlockPool.CommitWrite();
+		samples += block_size;
+		sample_count -= block_size;
+	}
+}
+
+bool VIPR_Emulator::WaveWriter::WritePendingBlocks()
+{
+	VIPR_TRACE_ZONE("WaveWriter::WritePendingBlocks");
+	bool written = false;
+	for (WaveAudioBlock *block = BlockPool.AcquireRead(); block != nullptr; block = BlockPool.AcquireRead())
+	{
+		for (uint32_t i = 0; i < block->sample_count; ++i)
+		{
+			write_buffer[i * 2] = static_cast<uint8_t>(block->samples[i]);
+			write_buffer[(i * 2) + 1] = static_cast<uint8_t>(static_cast<uint16_t>(block->samples[i]) >> 8);
+		}
+		audio_output.write(reinterpret_cast<const char *>(write_buffer.data()), block->sample_count * 2);
+		data_size += block->sample_count * 2;
+		BlockPool.CommitRead();
+		written = true;
+	}
+	return written;
+}
+
+void VIPR_Emulator::WaveWriter::WriteHeader()
+{
+	audio_output.write("RIFF", 4);
+	WriteLE<uint32_t>(audio_output, static_cast<uint32_t>(36 + data_size));
+	audio_output.write("WAVEfmt ", 8);
+	WriteLE<uint32_t>(audio_output, 16);
+	WriteLE<uint16_t>(audio_output, 1); // PCM
+	WriteLE<uint16_t>(audio_output, 1); // Mono
+	WriteLE<uint32_t>(audio_output, sample_rate);
+	WriteLE<uint32_t>(audio_output, sample_rate * 2);
+	WriteLE<uint16_t>(audio_output, 2);
+	WriteLE<uint16_t>(audio_output, 16);
+	audio_output.write("data", 4);
+	WriteLE<uint32_t>(audio_output, static_cast<uint32_t>(data_size));
+}
+
+void VIPR_Emulator::WaveWriter::WriterProcessor(WaveWriter *writer)
+{
+	VIPR_TRACE_THREAD_NAME("Audio Dump Writer");
+	while (writer->processing)
+	{
+		if (!writer->WritePendingBlocks())
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		}
+	}
+	writer->WritePendingBlocks();
+	writer->audio_output.flush();
+}
+
+void VIPR_Emulator::WaveWriter_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata)
+{
+	WaveWriter *writer = static_cast<WaveWriter *>(userdata);
+	writer->SubmitAudio(samples, sample_count, sample_rate);
+}
@@ -0,0 +1,77 @@
+#include "work_stealing_pool.hpp"
+#include <algorithm>
+#include <thread>
+
+VIPR_Emulator::WorkStealingPool::WorkStealingPool(size_t worker_count)
+{
+	if (worker_count == 0)
+	{
+		worker_count = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+	}
+	Queues.reserve(worker_count);
+	for (size_t i = 0; i < worker_count; ++i)
+	{
+		Queues.push_back(std::make_unique<WorkerQueue>());
+	}
+}
+
+VIPR_Emulator::WorkStealingPool::~WorkStealingPool()
+{
+}
+
+void VIPR_Emulator::WorkStealingPool::Run(size_t job_count, JobCallback job_func, void *userdata)
+{
+	for (size_t i = 0; i < job_count; ++i) // Jobs are dealt out in order, so each worker starts with an even share
+	{
+		Queues[i % Queues.size()]->jobs.push_front(i);
+	}
+	std::vector<std::thread> Workers;
+	Workers.reserve(Queues.size());
+	for (size_t i = 1; i < Queues.size(); ++i)
+	{
+		Workers.push_back(std::thread(WorkStealingPool::WorkerProcessor, this, i, job_func, userdata));
+	}
+	WorkerProcessor(this, 0, job_func, userdata);
+	for (std::thread &Worker : Workers)
+	{
+		Worker.join();
+	}
+}
+
+bool VIPR_Emulator::WorkStealingPool::PopJob(size_t worker, size_t &job)
+{
+	WorkerQueue &CurrentQueue = *Queues[worker];
+	std::lock_guard<std::mutex> queue_lock(CurrentQueue.lock);
+	if (CurrentQueue.jobs.empty())
+	{
+		return false;
+	}
+	job = CurrentQueue.jobs.back();
+	CurrentQueue.jobs.pop_back();
+	return true;
+}
+
+bool VIPR_Emulator::WorkStealingPool::StealJob(size_t worker, size_t &job)
+{
+	for (size_t i = 1; i < Queues.size(); ++i) // Starting from the next worker over spreads thieves across victims
+	{
+		WorkerQueue &VictimQueue = *Queues[(worker + i) % Queues.size()];
+		std::lock_guard<std::mutex> queue_lock(VictimQueue.lock);
+		if (!VictimQueue.jobs.empty())
+		{
+			job = VictimQueue.jobs.front();
+			VictimQueue.jobs.pop_front();
+			return true;
+		}
+	}
+	return false;
+}
+
+void VIPR_Emulator::WorkStealingPool::WorkerProcessor(WorkStealingPool *pool, size_t worker, JobCallback job_func, void *userdata)
+{
+	size_t job = 0;
+	while (pool->PopJob(worker, job) || pool->StealJob(worker, job)) // Jobs never add more jobs, so once every queue is empty the run is over
+	{
+		job_func(job, worker, userdata);
+	}
+}
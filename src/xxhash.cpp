@@ -0,0 +1,106 @@
+#include "xxhash.hpp"
+#include <cstring>
+
+namespace
+{
+	constexpr uint64_t prime_1 = 0x9E3779B185EBCA87ULL;
+	constexpr uint64_t prime_2 = 0xC2B2AE3D27D4EB4FULL;
+	constexpr uint64_t prime_3 = 0x165667B19E3779F9ULL;
+	constexpr uint64_t prime_4 = 0x85EBCA77C2B2AE63ULL;
+	constexpr uint64_t prime_5 = 0x27D4EB2F165667C5ULL;
+
+	inline uint64_t RotateLeft(uint64_t value, uint8_t bits)
+	{
+		return (value << bits) | (value >> (64 - bits));
+	}
+
+	inline uint64_t Read64(const uint8_t *data)
+	{
+		uint64_t value = 0;
+		for (uint8_t i = 0; i < 8; ++i)
+		{
+			value |= static_cast<uint64_t>(data[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	inline uint32_t Read32(const uint8_t *data)
+	{
+		uint32_t value = 0;
+		for (uint8_t i = 0; i < 4; ++i)
+		{
+			value |= static_cast<uint32_t>(data[i]) << (i * 8);
+		}
+		return value;
+	}
+
+	inline uint64_t Round(uint64_t accumulator, uint64_t input)
+	{
+		accumulator += input * prime_2;
+		accumulator = RotateLeft(accumulator, 31);
+		return accumulator * prime_1;
+	}
+
+	inline uint64_t MergeRound(uint64_t accumulator, uint64_t value)
+	{
+		accumulator ^= Round(0, value);
+		return accumulator * prime_1 + prime_4;
+	}
+}
+
+uint64_t VIPR_Emulator::XXHash64(const void *data, size_t size, uint64_t seed)
+{
+	const uint8_t *current = static_cast<const uint8_t *>(data);
+	const uint8_t *end = current + size;
+	uint64_t hash = 0;
+	if (size >= 32)
+	{
+		uint64_t v1 = seed + prime_1 + prime_2;
+		uint64_t v2 = seed + prime_2;
+		uint64_t v3 = seed;
+		uint64_t v4 = seed - prime_1;
+		const uint8_t *limit = end - 32;
+		do
+		{
+			v1 = Round(v1, Read64(current));
+			v2 = Round(v2, Read64(current + 8));
+			v3 = Round(v3, Read64(current + 16));
+			v4 = Round(v4, Read64(current + 24));
+			current += 32;
+		} while (current <= limit);
+		hash = RotateLeft(v1, 1) + RotateLeft(v2, 7) + RotateLeft(v3, 12) + RotateLeft(v4, 18);
+		hash = MergeRound(hash, v1);
+		hash = MergeRound(hash, v2);
+		hash = MergeRound(hash, v3);
+		hash = MergeRound(hash, v4);
+	}
+	else
+	{
+		hash = seed + prime_5;
+	}
+	hash += static_cast<uint64_t>(size);
+	while (current + 8 <= end)
+	{
+		hash ^= Round(0, Read64(current));
+		hash = RotateLeft(hash, 27) * prime_1 + prime_4;
+		current += 8;
+	}
+	if (current + 4 <= end)
+	{
+		hash ^= static_cast<uint64_t>(Read32(current)) * prime_1;
+		hash = RotateLeft(hash, 23) * prime_2 + prime_3;
+		current += 4;
+	}
+	while (current < end)
+	{
+		hash ^= static_cast<uint64_t>(*current) * prime_5;
+		hash = RotateLeft(hash, 11) * prime_1;
+		++current;
+	}
+	hash ^= hash >> 33;
+	hash *= prime_2;
+	hash ^= hash >> 29;
+	hash *= prime_3;
+	hash ^= hash >> 32;
+	return hash;
+}
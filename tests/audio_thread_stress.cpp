@@ -0,0 +1,181 @@
+#include "cosmac_vip.hpp"
+#include "audio_engine.hpp"
+#include "audio_stream.hpp"
+#include "capture.hpp"
+#include "wave_writer.hpp"
+#include <cstdlib>
+#include <cstdio>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <SDL.h>
+#include <fmt/core.h>
+
+/*
+Runs a machine in real time on the main thread (the emulation thread, as in the application) with its audio going to
+an SDL output stream, a capture and an audio dump, so the audio callback thread and both writer threads all run against
+it.  Every half second it does one of the things the application does while audio is playing: switching the device in
+place, pausing and resuming, restarting the capture or the dump, or swapping the sound board.  Meant to be built with
+VIPR_ENABLE_TSAN; any data race ThreadSanitizer finds ends the run with a failing exit code.
+
+Without a sound card, SDL's dummy audio driver (picked unless SDL_AUDIODRIVER is already set) still calls the
+callback from its own thread at the device's rate.
+*/
+
+extern "C" const char *__tsan_default_options()
+{
+	return "halt_on_error=1";
+}
+
+namespace
+{
+	struct StressAudioOutput
+	{
+		VIPR_Emulator::AudioStream *OutputStream;
+		VIPR_Emulator::VideoRecorder *Recorder;
+		VIPR_Emulator::WaveWriter *AudioDump;
+	};
+
+	void stress_audio_output(const int *samples, size_t sample_count, int sample_rate, void *userdata)
+	{
+		StressAudioOutput *AudioOutput = static_cast<StressAudioOutput *>(userdata);
+		if (AudioOutput->OutputStream->IsOpen())
+		{
+			AudioOutput->OutputStream->Write(samples, sample_count);
+		}
+		AudioOutput->Recorder->SubmitAudio(samples, sample_count, sample_rate);
+		AudioOutput->AudioDump->SubmitAudio(samples, sample_count, sample_rate);
+	}
+
+	std::vector<uint8_t> GetStressROM() // Turns the display on, then toggles Q forever at a few hundred Hz; the interrupt routine points DMA back at the picture every frame
+	{
+		std::vector<uint8_t> ROM(0x200, 0x00);
+		const std::vector<uint8_t> setup { 0xF8, 0x00, 0xB3, 0xF8, 0x40, 0xA3, 0xF8, 0x00, 0xB1, 0xF8, 0x21, 0xA1, 0xF8, 0x00, 0xB2, 0xF8, 0x31, 0xA2, 0xD3 }; // R3 = Main, R1 = Interrupt, R2 = Stack, SEP R3
+		const std::vector<uint8_t> interrupt { 0x70, 0xF8, 0x01, 0xB0, 0xF8, 0x00, 0xA0, 0x22, 0x30, 0x20 }; // RET, R0 = 0x0100, DEC R2, BR 0x20
+		const std::vector<uint8_t> program { 0x69, 0x7B, 0xF8, 0x40, 0xFF, 0x01, 0x3A, 0x44, 0x7A, 0xF8, 0x60, 0xFF, 0x01, 0x3A, 0x4B, 0x30, 0x41 }; // INP 1, then SEQ and REQ with a countdown after each
+		std::copy(setup.begin(), setup.end(), ROM.begin());
+		std::copy(interrupt.begin(), interrupt.end(), ROM.begin() + 0x20);
+		ROM[0x30] = 0x03; // Returns to X = 0, P = 3
+		std::copy(program.begin(), program.end(), ROM.begin() + 0x40);
+		for (size_t i = 0x100; i < ROM.size(); ++i)
+		{
+			ROM[i] = static_cast<uint8_t>(i * 37);
+		}
+		return ROM;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	using namespace VIPR_Emulator;
+	double duration = (argc > 1) ? std::atof(argv[1]) : 5.0; // In seconds
+	SDL_setenv("SDL_AUDIODRIVER", "dummy", 0);
+	if (SDL_Init(SDL_INIT_AUDIO) < 0)
+	{
+		fmt::print("Unable to initialize SDL audio: {}\n", SDL_GetError());
+		return 1;
+	}
+	std::string capture_file = "vipr_stress_capture.vcap";
+	std::string audio_file = "vipr_stress_audio.raw";
+	int result = 0;
+	{
+		AudioStream OutputStream;
+		VideoRecorder Recorder;
+		WaveWriter AudioDump;
+		AudioEngine SoundEngine;
+		COSMAC_VIP System;
+		StressAudioOutput AudioOutput { &OutputStream, &Recorder, &AudioDump };
+		if (!OutputStream.Open(std::string(), audio_latency_default) || !Recorder.Start(capture_file, static_cast<uint32_t>(System.GetClockFrequency()), clocks_per_frame) || !AudioDump.Start(audio_file, audio_sample_rate))
+		{
+			fmt::print("Unable to open the audio device or the output files.\n");
+			SDL_Quit();
+			return 1;
+		}
+		System.InstallROM(GetStressROM());
+		System.SetFrameOutput(VideoRecorder_frame_output, &Recorder);
+		SoundEngine.SetAudioOutput(stress_audio_output, &AudioOutput);
+		System.AttachAudioEngine(&SoundEngine);
+		System.SetRunSwitch(true);
+		std::chrono::high_resolution_clock::time_point start_tp = std::chrono::high_resolution_clock::now();
+		System.SetCPUCycleTimePoint(start_tp);
+		uint32_t action = 0;
+		uint32_t stats_taken = 0;
+		std::chrono::high_resolution_clock::time_point next_action_tp = start_tp + std::chrono::milliseconds(500);
+		std::chrono::high_resolution_clock::time_point next_stats_tp = start_tp + std::chrono::milliseconds(100);
+		std::chrono::high_resolution_clock::time_point current_tp = start_tp;
+		while (std::chrono::duration<double>(current_tp - start_tp).count() < duration)
+		{
+			System.RunMachine(current_tp);
+			if (current_tp >= next_stats_tp) // Like the statistics overlay
+			{
+				OutputStream.GetStats();
+				++stats_taken;
+				next_stats_tp += std::chrono::milliseconds(100);
+			}
+			if (current_tp >= next_action_tp)
+			{
+				switch (action % 6)
+				{
+					case 0:
+					{
+						OutputStream.Open(std::string(), (action % 12 == 0) ? audio_latency_min * 10 : audio_latency_default * 2); // Switches in place with a fade
+						break;
+					}
+					case 1:
+					{
+						OutputStream.Pause(true);
+						break;
+					}
+					case 2:
+					{
+						OutputStream.Pause(false);
+						break;
+					}
+					case 3:
+					{
+						Recorder.Stop();
+						Recorder.Start(capture_file, static_cast<uint32_t>(System.GetClockFrequency()), clocks_per_frame);
+						break;
+					}
+					case 4:
+					{
+						AudioDump.Stop();
+						AudioDump.Start(audio_file, audio_sample_rate);
+						break;
+					}
+					case 5:
+					{
+						if (action % 12 == 5)
+						{
+							System.InstallExpansionBoard(ExpansionBoardType::VP595_SimpleSoundBoard);
+						}
+						else
+						{
+							System.UninstallExpansionBoard(ExpansionBoardType::VP595_SimpleSoundBoard);
+						}
+						break;
+					}
+				}
+				++action;
+				next_action_tp += std::chrono::milliseconds(500);
+			}
+			SDL_Delay(1);
+			current_tp = std::chrono::high_resolution_clock::now();
+		}
+		AudioStats Stats = OutputStream.GetStats();
+		fmt::print("Ran {:.1f} s with {} actions and {} statistics snapshots: {} callbacks, {} underruns, {} overruns, {} dropped frames.\n", duration, action, stats_taken, Stats.callbacks, Stats.underruns, Stats.overruns, Recorder.GetDroppedFrames());
+		if (Stats.callbacks == 0)
+		{
+			fmt::print("Failed: The audio callback never ran.\n");
+			result = 1;
+		}
+		System.AttachAudioEngine(nullptr);
+		OutputStream.Close();
+		Recorder.Stop();
+		AudioDump.Stop();
+	}
+	std::remove(capture_file.c_str());
+	std::remove(audio_file.c_str());
+	SDL_Quit();
+	return result;
+}
@@ -0,0 +1,74 @@
+; Source of pattern.rom, a small CDP1802 program for the golden frame test (ctest's golden_frames runs it through vipr_batch).
+; It fills page 0x0100 with a pattern, shows it through the CDP1861 and inverts one more byte of it every frame from the
+; display interrupt.  Meanwhile it scans keypad 0 and writes every key it sees pressed into page 0x0180, so the frames
+; depend on the input script too.  Assembled by hand; the ROM is mirrored at 0x8000, which is where it runs from.
+
+0000  F8 80     LDI  0x80
+0002  B3        PHI  R3
+0003  F8 08     LDI  0x08
+0005  A3        PLO  R3
+0006  D3        SEP  R3          ; P = 3 at 0x8008
+0008  64        OUT  4           ; Maps RAM at 0x0000
+0009  F8 80     LDI  0x80
+000B  B1        PHI  R1
+000C  F8 52     LDI  0x52
+000E  A1        PLO  R1          ; R1 = Interrupt (0x8052)
+000F  F8 07     LDI  0x07
+0011  B2        PHI  R2
+0012  F8 FF     LDI  0xFF
+0014  A2        PLO  R2          ; R2 = Stack (0x07FF)
+0015  E2        SEX  R2
+0016  F8 01     LDI  0x01
+0018  B4        PHI  R4
+0019  F8 00     LDI  0x00
+001B  A4        PLO  R4          ; R4 = 0x0100
+001C  F8 00     LDI  0x00
+001E  A5        PLO  R5
+001F  85        GLO  R5          ; Fill: 0x0100-0x01FF = 0x00, 0xFF, 0xFE, ...
+0020  54        STR  R4
+0021  14        INC  R4
+0022  25        DEC  R5
+0023  85        GLO  R5
+0024  3A 1F     BNZ  Fill
+0026  F8 01     LDI  0x01
+0028  B7        PHI  R7
+0029  B8        PHI  R8
+002A  F8 00     LDI  0x00
+002C  A7        PLO  R7          ; R7 = Next byte to invert (0x0100)
+002D  A6        PLO  R6          ; R6.0 = Key to check
+002E  F8 80     LDI  0x80
+0030  A8        PLO  R8          ; R8 = Next key slot (0x0180)
+0031  69        INP  1           ; Display on
+0032  86        GLO  R6          ; Scan:
+0033  FA 0F     ANI  0x0F
+0035  52        STR  R2
+0036  62        OUT  2           ; Hex key latch = R6.0 & 0xF
+0037  22        DEC  R2
+0038  36 3D     B3   Pressed
+003A  16        INC  R6
+003B  30 32     BR   Scan
+003D  86        GLO  R6          ; Pressed:
+003E  58        STR  R8
+003F  18        INC  R8
+0040  F8 01     LDI  0x01
+0042  B8        PHI  R8          ; Stays in page 0x0100
+0043  16        INC  R6
+0044  30 32     BR   Scan
+
+0050  72        LDXA             ; Return: restores D
+0051  70        RET
+0052  22        DEC  R2          ; Interrupt:
+0053  78        SAV
+0054  22        DEC  R2
+0055  52        STR  R2          ; Saves D
+0056  F8 01     LDI  0x01
+0058  B0        PHI  R0
+0059  F8 00     LDI  0x00
+005B  A0        PLO  R0          ; DMA from 0x0100
+005C  07        LDN  R7
+005D  FB FF     XRI  0xFF
+005F  57        STR  R7
+0060  17        INC  R7
+0061  F8 01     LDI  0x01
+0063  B7        PHI  R7          ; Stays in page 0x0100
+0064  30 50     BR   Return
@@ -0,0 +1,164 @@
+#include "gui.hpp"
+#include <cstdlib>
+#include <new>
+#include <fmt/core.h>
+
+/*
+Checks that drawing a menu frame doesn't allocate.  Every global operator new is replaced with one that counts while
+counting is turned on, and a menu holding every element type is drawn through a stub renderer (tests/stub) that only
+counts glyphs.  The first draw sizes the menu cache and isn't counted; every draw after it has to come in at zero.
+*/
+
+namespace
+{
+	size_t allocation_count = 0;
+	bool count_allocations = false;
+
+	void *CountedAllocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t))
+	{
+		if (count_allocations)
+		{
+			++allocation_count;
+		}
+		void *memory = (alignment > alignof(std::max_align_t)) ? std::aligned_alloc(alignment, ((size + alignment - 1) / alignment) * alignment) : std::malloc((size > 0) ? size : 1);
+		if (memory == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+		return memory;
+	}
+}
+
+void *operator new(std::size_t size)
+{
+	return CountedAllocate(size);
+}
+
+void *operator new[](std::size_t size)
+{
+	return CountedAllocate(size);
+}
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+	return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return CountedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+	try
+	{
+		return CountedAllocate(size);
+	}
+	catch (...)
+	{
+		return nullptr;
+	}
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+	try
+	{
+		return CountedAllocate(size);
+	}
+	catch (...)
+	{
+		return nullptr;
+	}
+}
+
+void operator delete(void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::align_val_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::align_val_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void *memory, std::size_t, std::align_val_t) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete[](void *memory, std::size_t, std::align_val_t) noexcept
+{
+	std::free(memory);
+}
+
+int main()
+{
+	using namespace VIPR_Emulator;
+	constexpr GUI::ColorData item_color { 0xA0, 0xA0, 0xA0 };
+	constexpr GUI::ColorData select_color { 0xA0, 0x00, 0x00 };
+	constexpr GUI::ColorData value_color { 0xFF, 0xFF, 0xFF };
+	GUI::Menu TestMenu { 152, 30, {}, 0, false, nullptr, nullptr, nullptr, nullptr, nullptr };
+	TestMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Text, GUI::Text { "Allocation Test Menu With A Long Title", 0, 0, item_color, false } }); // Longer than any small string buffer, so a copy would allocate
+	TestMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Status, GUI::Status { "Transfer Status", "Waiting for something to happen", 0, 10, item_color, value_color, false } });
+	TestMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Button, GUI::Button { "Power On The Machine", 0, 20, item_color, select_color, { 0x40, 0x40, 0x40 }, true, false, false, nullptr } });
+	TestMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Toggle, GUI::Toggle { "VP-590 Color Board", 0, 30, item_color, select_color, value_color, false, true, false, nullptr } });
+	TestMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Input, GUI::Input { "ROM File", "roms/a_rather_long_rom_file_name.rom", "roms/a_rather_long_rom_file_name.rom", 0, 40, item_color, select_color, value_color, 4, 32, 0, 255, false, false, false, nullptr } });
+	TestMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::MultiChoice, GUI::MultiChoice { "Transfer Type", 0, 50, item_color, select_color, value_color, 0, std::vector<std::string> { "Load From A File", "Store To A File" }, false, false } });
+	TestMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Start Address", "", 0, 60, item_color, select_color, value_color, GUI::ValueBaseType::Hexadecimal, 0x0000, 0x0000, 0x7FFF, 0, false, false, false, nullptr } });
+	TestMenu.element_list.push_back(GUI::ElementData { GUI::ElementType::Value, GUI::Value { "Size", "", 0, 70, item_color, select_color, value_color, GUI::ValueBaseType::Decimal, 512, 1, 32768, 0, false, false, false, nullptr } });
+	Renderer StubRenderer;
+	GUI::MenuCache Cache;
+	GUI::DrawMenu(StubRenderer, TestMenu, Cache);
+	size_t first_frame_glyphs = StubRenderer.glyphs;
+	count_allocations = true;
+	for (uint32_t i = 0; i < 64; ++i) // Changes something on most frames, covering partial redraws, full redraws and frames with nothing to redraw
+	{
+		std::get<GUI::Button>(TestMenu.element_list[2].element).select = (i % 2 == 0);
+		std::get<GUI::Toggle>(TestMenu.element_list[3].element).toggle = (i % 3 == 0);
+		std::get<GUI::Input>(TestMenu.element_list[4].element).focus = (i % 4 == 0);
+		std::get<GUI::MultiChoice>(TestMenu.element_list[5].element).current_choice = (i / 5) % 2;
+		std::get<GUI::Value>(TestMenu.element_list[6].element).value = static_cast<int32_t>((i * 0x1234) & 0x7FFF);
+		std::get<GUI::Value>(TestMenu.element_list[7].element).value = static_cast<int32_t>(i * 511);
+		if (i % 16 == 15)
+		{
+			TestMenu.x = (TestMenu.x == 152) ? 160 : 152;
+		}
+		GUI::DrawMenu(StubRenderer, TestMenu, Cache);
+	}
+	count_allocations = false;
+	size_t counted_allocations = allocation_count;
+	if (first_frame_glyphs == 0 || StubRenderer.glyphs == first_frame_glyphs)
+	{
+		fmt::print("Failed: Nothing was drawn ({} glyphs).\n", StubRenderer.glyphs);
+		return 1;
+	}
+	if (counted_allocations > 0)
+	{
+		fmt::print("Failed: Drawing 64 menu frames made {} allocations.\n", counted_allocations);
+		return 1;
+	}
+	fmt::print("Passed: Drew 64 menu frames ({} glyphs) without allocating.\n", StubRenderer.glyphs - first_frame_glyphs);
+	return 0;
+}
@@ -0,0 +1,46 @@
+#ifndef _RENDERER_HPP_
+#define _RENDERER_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+namespace VIPR_Emulator
+{
+	class Renderer // Stands in for the GL renderers so the GUI draw path can run without a window; it only counts what would have been drawn
+	{
+		public:
+			inline void ClearSecondaryFramebuffer()
+			{
+				++clears;
+			}
+
+			inline void ClearSecondaryFramebufferRegion(uint16_t, uint16_t, uint16_t, uint16_t)
+			{
+				++clears;
+			}
+
+			inline void SetFontColor(uint8_t, uint8_t, uint8_t)
+			{
+			}
+
+			inline void SetFontFlags(uint32_t)
+			{
+			}
+
+			inline void DrawChar(char, uint16_t, uint16_t)
+			{
+				++glyphs;
+			}
+
+			inline void DrawText(std::string_view text, uint16_t, uint16_t)
+			{
+				glyphs += text.size();
+			}
+
+			size_t clears = 0;
+			size_t glyphs = 0;
+	};
+}
+
+#endif